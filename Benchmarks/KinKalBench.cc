@@ -0,0 +1,372 @@
+//
+// Reproducible micro and macro benchmarks of KinKal, used to track performance regressions between releases.
+// Each benchmark is timed over several repeats (the minimum and median are reported), and a checksum of the results
+// is kept so the work can't be optimized away and results can be compared between runs.  Inputs are generated from a fixed seed.
+// The results are written as JSON.
+//
+#include "KinKal/Trajectory/LoopHelix.hh"
+#include "KinKal/Trajectory/CentralHelix.hh"
+#include "KinKal/Trajectory/KinematicLine.hh"
+#include "KinKal/Trajectory/Line.hh"
+#include "KinKal/Trajectory/ClosestApproach.hh"
+#include "KinKal/Trajectory/BatchClosestApproach.hh"
+#include "KinKal/Trajectory/ParticleTrajectory.hh"
+#include "KinKal/General/FitData.hh"
+#include "KinKal/General/BFieldMap.hh"
+#include "KinKal/General/AxialBFieldMap.hh"
+#include "KinKal/General/CylBFieldMap.hh"
+#include "KinKal/MatEnv/MatDBInfo.hh"
+#include "KinKal/MatEnv/DetMaterial.hh"
+#include "KinKal/MatEnv/SimpleFileFinder.hh"
+#include "KinKal/Fit/Track.hh"
+#include "KinKal/Fit/Config.hh"
+#include "KinKal/Tests/ToyMC.hh"
+#include "KinKal/Tests/MakeConfig.hh"
+
+#include <iostream>
+#include <fstream>
+#include <stdio.h>
+#include <getopt.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <cstdlib>
+
+#include "TRandom3.h"
+
+using namespace KinKal;
+using namespace std;
+
+#ifndef KINKAL_VERSION
+#define KINKAL_VERSION "unknown"
+#endif
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+  struct BenchResult {
+    std::string name_; // benchmark name
+    unsigned long ncalls_; // calls per repeat
+    double min_, median_; // time per call (ns) over the repeats
+    double checksum_; // sum of the results of the last repeat
+  };
+
+  struct BenchConfig {
+    unsigned ncalls_ = 100000; // calls per repeat of the micro benchmarks
+    unsigned nrepeat_ = 5; // repeats of each benchmark
+    int seed_ = 4856; // random seed for inputs
+    std::string schedule_ = "driftfit.txt"; // fit configuration of the fit benchmarks, read by KKTest::makeConfig
+  };
+
+  BenchResult summarize(std::string const& name, unsigned long ncalls, std::vector<double>& times, double checksum) {
+    std::sort(times.begin(),times.end());
+    return BenchResult{name,ncalls,times.front()/ncalls,times[times.size()/2]/ncalls,checksum};
+  }
+
+  // time func(icall) for icall in [0,ncalls), repeated.  func returns a value summed into the checksum
+  template <class FUNC> BenchResult runBench(std::string const& name, BenchConfig const& bconfig, unsigned ncalls, FUNC const& func) {
+    std::vector<double> times;
+    double checksum(0.0);
+    for(unsigned irep=0; irep < bconfig.nrepeat_; irep++){
+      checksum = 0.0;
+      auto start = Clock::now();
+      for(unsigned icall=0; icall < ncalls; icall++) checksum += func(icall);
+      auto stop = Clock::now();
+      times.push_back(std::chrono::duration<double,std::nano>(stop-start).count());
+    }
+    auto retval = summarize(name,ncalls,times,checksum);
+    cout << name << " " << retval.median_ << " ns/call (min " << retval.min_ << ")" << endl;
+    return retval;
+  }
+
+  template <class KTRAJ> KTRAJ makeTraj(VEC3 const& bnom, double tmax) {
+    double mom(105.0), cost(0.7), phi(0.5), pmass(0.511);
+    double sint = sqrt(1.0-cost*cost);
+    MOM4 momv(mom*sint*cos(phi),mom*sint*sin(phi),mom*cost,pmass);
+    return KTRAJ(VEC4(0.0,0.0,0.0,0.0),momv,-1,bnom,TimeRange(0.0,tmax));
+  }
+
+  // trajectory evaluation and closest approach to lines
+  template <class KTRAJ> void trajectoryBench(std::string const& tname, VEC3 const& bnom, BenchConfig const& bconfig, std::vector<BenchResult>& results) {
+    double tmax(100.0);
+    auto ktraj = makeTraj<KTRAJ>(bnom,tmax);
+    TRandom3 tr(bconfig.seed_);
+    std::vector<double> times(bconfig.ncalls_);
+    for(auto& time : times) time = tr.Uniform(0.0,tmax);
+    results.push_back(runBench(tname+"::position3",bconfig,bconfig.ncalls_,[&](unsigned icall){ return ktraj.position3(times[icall]).X(); }));
+    results.push_back(runBench(tname+"::direction",bconfig,bconfig.ncalls_,[&](unsigned icall){ return ktraj.direction(times[icall]).X(); }));
+    results.push_back(runBench(tname+"::dXdPar",bconfig,bconfig.ncalls_,[&](unsigned icall){ return ktraj.dXdPar(times[icall])(0,0); }));
+    // straws crossing the trajectory at random times, with random orientation and offset
+    std::vector<Line> lines;
+    lines.reserve(bconfig.ncalls_);
+    for(auto time : times){
+      double eta = tr.Uniform(-M_PI,M_PI);
+      VEC3 sdir(cos(eta),sin(eta),0.0);
+      VEC3 drift = (sdir.Cross(ktraj.direction(time))).Unit();
+      VEC3 lpos = ktraj.position3(time) + tr.Uniform(-2.5,2.5)*drift;
+      lines.emplace_back(lpos,time,sdir*200.0,1000.0);
+    }
+    using CA = ClosestApproach<KTRAJ,Line>;
+    results.push_back(runBench("ClosestApproach<"+tname+",Line>",bconfig,bconfig.ncalls_,[&](unsigned icall){
+          CA ca(ktraj,lines[icall],CAHint(times[icall],times[icall]),1e-8);
+          return ca.doca(); }));
+    // batch interface: each call finds TCA for a block of lines
+    constexpr unsigned nbatch(64);
+    std::vector<LineArray> blocks(bconfig.ncalls_/nbatch);
+    for(size_t iblock=0; iblock < blocks.size(); iblock++)
+      for(unsigned iline=0; iline < nbatch; iline++) blocks[iblock].push_back(lines[iblock*nbatch+iline]);
+    BatchClosestApproach<KTRAJ> bca(1e-8);
+    results.push_back(runBench("BatchClosestApproach<"+tname+",Line> batch64",bconfig,bconfig.ncalls_/nbatch,[&](unsigned icall){
+          bca.findTCA(ktraj,blocks[icall],times.data()+icall*nbatch,times.data()+icall*nbatch);
+          return bca.doca(0); }));
+  }
+
+  void pieceLookupBench(BenchConfig const& bconfig, std::vector<BenchResult>& results) {
+    using PTRAJ = ParticleTrajectory<LoopHelix>;
+    double tmax(100.0);
+    unsigned npieces(200);
+    auto ktraj = makeTraj<LoopHelix>(VEC3(0.0,0.0,1.0),tmax);
+    PTRAJ ptraj(ktraj);
+    double dt = tmax/npieces;
+    for(unsigned ipiece=1;ipiece < npieces; ipiece++){
+      LoopHelix piece(ktraj);
+      piece.range() = TimeRange(ipiece*dt,tmax);
+      ptraj.append(piece);
+    }
+    TRandom3 tr(bconfig.seed_);
+    std::vector<double> times(bconfig.ncalls_);
+    for(auto& time : times) time = tr.Uniform(0.0,tmax);
+    results.push_back(runBench("PiecewiseTrajectory::nearestIndex",bconfig,bconfig.ncalls_,[&](unsigned icall){ return ptraj.nearestIndex(times[icall]); }));
+    std::sort(times.begin(),times.end());
+    size_t hint(0);
+    results.push_back(runBench("PiecewiseTrajectory::nearestIndex(hint)",bconfig,bconfig.ncalls_,[&](unsigned icall){
+          if(icall == 0) hint = 0;
+          return ptraj.nearestIndex(times[icall],hint); }));
+  }
+
+  void invertBench(BenchConfig const& bconfig, std::vector<BenchResult>& results) {
+    // random covariance matrices, with parameter scales similar to a track fit
+    TRandom3 tr(bconfig.seed_);
+    std::vector<FitData> fdata;
+    fdata.reserve(bconfig.ncalls_);
+    for(unsigned imat=0; imat < bconfig.ncalls_; imat++){
+      ROOT::Math::SMatrix<double,NParams(),NParams()> jac;
+      DVEC scale, vec;
+      for(size_t ipar=0; ipar < NParams(); ipar++) scale[ipar] = pow(10.0,tr.Uniform(-4.0,3.0));
+      for(size_t ipar=0; ipar < NParams(); ipar++){
+        for(size_t jpar=0; jpar < NParams(); jpar++) jac(ipar,jpar) = tr.Gaus()*scale[ipar];
+        vec[ipar] = tr.Gaus()*scale[ipar];
+      }
+      DMAT ident = ROOT::Math::SMatrixIdentity();
+      DMAT mat = ROOT::Math::Similarity(jac,ident);
+      for(size_t ipar=0; ipar < NParams(); ipar++) mat(ipar,ipar) += 1.0e-2*scale[ipar]*scale[ipar];
+      fdata.emplace_back(vec,mat);
+    }
+    results.push_back(runBench("FitData::invert",bconfig,bconfig.ncalls_,[&](unsigned icall){
+          FitData inv(fdata[icall],true);
+          return inv.vec()[0]; }));
+  }
+
+  void materialBench(BenchConfig const& bconfig, std::vector<BenchResult>& results) {
+    MatEnv::SimpleFileFinder sfinder;
+    MatEnv::MatDBInfo matdb(sfinder,MatEnv::DetMaterial::moyalmean);
+    TRandom3 tr(bconfig.seed_);
+    std::vector<double> moms(bconfig.ncalls_), plens(bconfig.ncalls_);
+    for(unsigned icall=0; icall < bconfig.ncalls_; icall++){
+      moms[icall] = tr.Uniform(10.0,200.0);
+      plens[icall] = tr.Uniform(0.001,5.0);
+    }
+    double mass(0.511);
+    for(auto matname : {"straw-wall","straw-gas","straw-wire"}){
+      auto const* dmat = matdb.findDetMaterial(matname);
+      results.push_back(runBench(std::string("DetMaterial::energyLoss(")+matname+")",bconfig,bconfig.ncalls_,[&](unsigned icall){
+            return dmat->energyLoss(moms[icall],plens[icall],mass); }));
+      results.push_back(runBench(std::string("DetMaterial::scatterAngleRMS(")+matname+")",bconfig,bconfig.ncalls_,[&](unsigned icall){
+            return dmat->scatterAngleRMS(moms[icall],plens[icall],mass); }));
+      // batch interface: each call evaluates a block of inputs
+      constexpr unsigned nbatch(64);
+      std::vector<double> out(nbatch);
+      results.push_back(runBench(std::string("DetMaterial::energyLoss batch64(")+matname+")",bconfig,bconfig.ncalls_/nbatch,[&](unsigned icall){
+            dmat->energyLoss(moms.data()+icall*nbatch,plens.data()+icall*nbatch,nbatch,mass,out.data());
+            return out[0]; }));
+      results.push_back(runBench(std::string("DetMaterial::scatterAngleVar batch64(")+matname+")",bconfig,bconfig.ncalls_/nbatch,[&](unsigned icall){
+            dmat->scatterAngleVar(moms.data()+icall*nbatch,plens.data()+icall*nbatch,nbatch,mass,out.data());
+            return out[0]; }));
+    }
+  }
+
+  // write a synthetic solenoid-like cylindrical field map in the CylBMap text format
+  std::string writeCylMap() {
+    auto file = (std::filesystem::temp_directory_path() / "KinKalBench_cylmap.txt").string();
+    std::ofstream ofs(file);
+    double r0(0.0), z0(-2000.0), dr(10.0), dz(10.0);
+    int nr(80), nz(401);
+    ofs << "# synthetic map for KinKalBench" << endl;
+    ofs << "grid R0=" << r0 << " Z0=" << z0 << " nR=" << nr << " nZ=" << nz << " dR=" << dr << " dZ=" << dz << " " << endl;
+    ofs << "data" << endl;
+    for(int ir=0; ir < nr; ir++){
+      for(int iz=0; iz < nz; iz++){
+        double rval = r0 + ir*dr, zval = z0 + iz*dz;
+        double bz = 1.0 - 1.2e-5*zval;
+        double br = 0.5*1.2e-5*rval;
+        ofs << rval << " " << zval << " " << br << " " << bz << endl;
+      }
+    }
+    return file;
+  }
+
+  void bfieldBench(BenchConfig const& bconfig, std::vector<BenchResult>& results) {
+    std::vector<std::pair<std::string,std::shared_ptr<BFieldMap>>> bfields;
+    bfields.emplace_back("UniformBFieldMap",std::make_shared<UniformBFieldMap>(VEC3(0.0,0.0,1.0)));
+    bfields.emplace_back("GradientBFieldMap",std::make_shared<GradientBFieldMap>(1.018,0.982,-1500.0,1500.0));
+    std::vector<double> axial(301);
+    for(size_t iz=0; iz < axial.size(); iz++) axial[iz] = 1.0 - 1.2e-5*(-1500.0 + 10.0*iz);
+    auto axmap = std::make_shared<AxialBFieldMap>(-1500.0,1500.0,axial);
+    bfields.emplace_back("AxialBFieldMap",axmap);
+    bfields.emplace_back("CylBFieldMap",std::make_shared<CylBFieldMap>(writeCylMap()));
+    CompositeBFieldMap::FCOL fcol = {bfields[0].second.get(),bfields[1].second.get()};
+    bfields.emplace_back("CompositeBFieldMap",std::make_shared<CompositeBFieldMap>(fcol));
+    TRandom3 tr(bconfig.seed_);
+    std::vector<VEC3> positions(bconfig.ncalls_);
+    for(auto& pos : positions) pos = VEC3(tr.Uniform(-700.0,700.0),tr.Uniform(-700.0,700.0),tr.Uniform(-1400.0,1400.0));
+    for(auto const& bfield : bfields){
+      auto const& bf = *bfield.second;
+      results.push_back(runBench(bfield.first+"::fieldVect",bconfig,bconfig.ncalls_,[&](unsigned icall){ return bf.fieldVect(positions[icall]).Z(); }));
+      results.push_back(runBench(bfield.first+"::fieldGrad",bconfig,bconfig.ncalls_,[&](unsigned icall){ return bf.fieldGrad(positions[icall])(2,2); }));
+      // batch interface: each call evaluates a block of positions
+      constexpr unsigned nbatch(64);
+      std::vector<VEC3> fields(nbatch);
+      results.push_back(runBench(bfield.first+"::fieldVect batch64",bconfig,bconfig.ncalls_/nbatch,[&](unsigned icall){
+            bf.fieldVect(positions.data()+icall*nbatch,nbatch,fields.data());
+            return fields[0].Z(); }));
+    }
+  }
+
+  // full fits of ToyMC tracks.  Fitting changes the hit and xing state, so the inputs are regenerated (untimed) for each repeat
+  template <class KTRAJ> void fitBench(std::string const& tname, DVEC const& sigmas, unsigned nhits, Config const& config, BenchConfig const& bconfig, std::vector<BenchResult>& results) {
+    using PTRAJ = ParticleTrajectory<KTRAJ>;
+    using KKTRK = Track<KTRAJ>;
+    double zrange(3000.0), Bgrad(-0.036), Bz(1.0);
+    GradientBFieldMap bfield(Bz-0.5*Bgrad,Bz+0.5*Bgrad,-0.5*zrange,0.5*zrange);
+    unsigned ntrks = std::max(2u,4000u/nhits);
+    std::vector<double> times;
+    double checksum(0.0);
+    for(unsigned irep=0; irep < bconfig.nrepeat_; irep++){
+      KKTest::ToyMC<KTRAJ> toy(bfield, 105.0, -1, zrange, bconfig.seed_, nhits, true, false, 0.25, 0.511);
+      std::vector<PTRAJ> seeds;
+      std::vector<typename KKTRK::HITCOL> hits(ntrks);
+      std::vector<typename KKTRK::EXINGCOL> xings(ntrks);
+      for(unsigned itrk=0; itrk < ntrks; itrk++){
+        PTRAJ tptraj;
+        toy.simulateParticle(tptraj,hits[itrk],xings[itrk]);
+        double tmid = tptraj.range().mid();
+        auto const& midhel = tptraj.nearestPiece(tmid);
+        auto seedpos = midhel.position4(tmid);
+        KTRAJ seedtraj(seedpos,midhel.momentum4(tmid),midhel.charge(),bfield.fieldVect(seedpos.Vect()),tptraj.range());
+        toy.createSeed(seedtraj,sigmas,10.0);
+        seeds.emplace_back(seedtraj);
+      }
+      checksum = 0.0;
+      auto start = Clock::now();
+      for(unsigned itrk=0; itrk < ntrks; itrk++){
+        KKTRK kktrk(config,bfield,seeds[itrk],hits[itrk],xings[itrk]);
+        checksum += kktrk.fitStatus().chisq_.chisq();
+      }
+      auto stop = Clock::now();
+      times.push_back(std::chrono::duration<double,std::nano>(stop-start).count());
+    }
+    auto result = summarize("Track<"+tname+">::fit("+std::to_string(nhits)+" hits)",ntrks,times,checksum);
+    cout << result.name_ << " " << result.median_*1.0e-3 << " us/fit (min " << result.min_*1.0e-3 << ")" << endl;
+    results.push_back(result);
+  }
+
+  void writeJSON(std::string const& file, BenchConfig const& bconfig, std::vector<BenchResult> const& results) {
+    std::ofstream ofs(file);
+    if(!ofs) throw std::runtime_error("Can't open output file " + file);
+    ofs.precision(10);
+    ofs << "{" << endl;
+    ofs << "  \"version\": \"" << KINKAL_VERSION << "\"," << endl;
+    ofs << "  \"seed\": " << bconfig.seed_ << "," << endl;
+    ofs << "  \"repeats\": " << bconfig.nrepeat_ << "," << endl;
+    ofs << "  \"schedule\": \"" << bconfig.schedule_ << "\"," << endl;
+    ofs << "  \"benchmarks\": [" << endl;
+    for(size_t ires=0; ires < results.size(); ires++){
+      auto const& res = results[ires];
+      ofs << "    {\"name\": \"" << res.name_ << "\", \"calls\": " << res.ncalls_
+        << ", \"ns_per_call_min\": " << res.min_ << ", \"ns_per_call_median\": " << res.median_
+        << ", \"checksum\": " << res.checksum_ << "}" << (ires+1 < results.size() ? "," : "") << endl;
+    }
+    ofs << "  ]" << endl;
+    ofs << "}" << endl;
+  }
+}
+
+void print_usage() {
+  printf("Usage: KinKalBench --output s --ncalls i --repeat i --seed i --fits i --schedule s\n");
+}
+
+int main(int argc, char **argv) {
+  BenchConfig bconfig;
+  std::string output("KinKalBench.json");
+  bool fits(true);
+  static struct option long_options[] = {
+    {"output",     required_argument, 0, 'o'  },
+    {"ncalls",     required_argument, 0, 'n'  },
+    {"repeat",     required_argument, 0, 'r'  },
+    {"seed",     required_argument, 0, 's'  },
+    {"fits",     required_argument, 0, 'f'  },
+    {"schedule",     required_argument, 0, 'c'  },
+    {NULL, 0,0,0}
+  };
+  int long_index =0;
+  int opt;
+  while ((opt = getopt_long_only(argc, argv,"",
+          long_options, &long_index )) != -1) {
+    switch (opt) {
+      case 'o' : output = optarg;
+                 break;
+      case 'n' : bconfig.ncalls_ = atoi(optarg);
+                 break;
+      case 'r' : bconfig.nrepeat_ = atoi(optarg);
+                 break;
+      case 's' : bconfig.seed_ = atoi(optarg);
+                 break;
+      case 'f' : fits = atoi(optarg);
+                 break;
+      case 'c' : bconfig.schedule_ = optarg;
+                 break;
+      default: print_usage();
+               exit(EXIT_FAILURE);
+    }
+  }
+  if(bconfig.ncalls_ == 0 || bconfig.nrepeat_ == 0){
+    print_usage();
+    exit(EXIT_FAILURE);
+  }
+  if(std::getenv("KINKAL_SOURCE_DIR") == 0){
+    cout << "KINKAL_SOURCE_DIR not defined: source setup.sh" << endl;
+    return EXIT_FAILURE;
+  }
+  std::vector<BenchResult> results;
+  VEC3 bnom(0.0,0.0,1.0);
+  trajectoryBench<LoopHelix>("LoopHelix",bnom,bconfig,results);
+  trajectoryBench<CentralHelix>("CentralHelix",bnom,bconfig,results);
+  trajectoryBench<KinematicLine>("KinematicLine",bnom,bconfig,results);
+  pieceLookupBench(bconfig,results);
+  invertBench(bconfig,results);
+  materialBench(bconfig,results);
+  bfieldBench(bconfig,results);
+  if(fits){
+    Config config;
+    if(KKTest::makeConfig(bconfig.schedule_,config,true,0.0,0,false) != 0) return EXIT_FAILURE;
+    for(unsigned nhits : {20,40,200,1000}){
+      fitBench<LoopHelix>("LoopHelix",DVEC(0.5, 0.5, 0.5, 0.5, 0.02, 0.5),nhits,config,bconfig,results);
+      fitBench<CentralHelix>("CentralHelix",DVEC(0.5, 0.003, 0.00001, 3.0 , 0.004, 0.1),nhits,config,bconfig,results);
+    }
+  }
+  writeJSON(output,bconfig,results);
+  cout << "Wrote " << results.size() << " benchmark results to " << output << endl;
+  return EXIT_SUCCESS;
+}
@@ -21,11 +21,14 @@ namespace KinKal {
     public:
       using PTRAJ = ParticleTrajectory<KTRAJ>;
       using KTRAJPTR = std::shared_ptr<KTRAJ>;
+      using NOISEFACTOR = ROOT::Math::SMatrix<double,NParams(),MomBasis::ndir>; // factor G of a low-rank covariance G*G^T
       ElementXing() {}
       virtual ~ElementXing() {}
       virtual void updateReference(KTRAJPTR const& ktrajptr) = 0; // update the trajectory reference
       virtual void updateState(MetaIterConfig const& config,bool first) =0; // update the state according to this meta-config
       virtual Parameters parameters(TimeDir tdir) const =0; // parameter change induced by this element crossing WRT the reference
+      // the same change with the covariance in factored (low-rank) form.  Return false if this crossing doesn't provide it
+      virtual bool lowRankParameters(TimeDir tdir, DVEC& dpvec, NOISEFACTOR& gmat) const { return false; }
       virtual double time() const=0; // time the particle crosses thie element
       virtual double transitTime() const=0; // time to cross this element
       virtual KTRAJ const& referenceTrajectory() const =0; // trajectory WRT which the xing is defined
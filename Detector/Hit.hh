@@ -34,13 +34,17 @@ namespace KinKal {
       virtual void updateState(MetaIterConfig const& config,bool first) = 0;
       // The following provides the constraint/information content of this hit in the trajectory weight space
       virtual Weights const& weight() const = 0;
+      // update parameters (with covariance) with this hit's information directly in parameter space, using a Kalman gain.  This avoids the
+      // inversions needed to go between parameter and weight space.  Return false (leaving the parameters unchanged) if this hit doesn't support it
+      virtual bool kalmanUpdate(Parameters& params) const { return false; }
       KTRAJ const& referenceTrajectory() const { return *refTrajPtr(); }  // trajectory WRT which the weight etc is defined
       // parameters WRT which this hit's residual and weights are set.  These are generally biased
       // in that they contain the information of this hit
       Parameters const& referenceParameters() const { return referenceTrajectory().params(); }
-      // Unbiased parameters, taking out this hit's effect from the reference
+      // Unbiased parameters, taking out this hit's effect from the reference.  This throws std::runtime_error if the remaining
+      // weight isn't positive-definite, ie when this hit dominates the reference information in some direction
       Parameters unbiasedParameters() const;
-      // unbiased least-squares distance to reference parameters
+      // unbiased least-squares distance to reference parameters.  This can throw, as above
       Chisq chisquared() const;
   };
 
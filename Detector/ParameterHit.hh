@@ -6,6 +6,7 @@
 //
 #include "KinKal/Detector/Hit.hh"
 #include "KinKal/General/Vectors.hh"
+#include "KinKal/General/SymInverse.hh"
 //#include "KinKal/General/Parameters.hh"
 #include <stdexcept>
 namespace KinKal {
@@ -81,7 +82,7 @@ namespace KinKal {
     pdiff += params_;  // this is now the difference of parameters but sum of covariances
     // invert the covariance matrix
     DMAT wmat = pdiff.covariance();
-    if(!wmat.Invert()) throw std::runtime_error("ParameterHit inversion failure");
+    if(!invertSPD(wmat)) throw std::runtime_error("ParameterHit inversion failure");
     // zero out unconstrainted parts
     wmat = ROOT::Math::Similarity(mask_,wmat);
     double chisq = ROOT::Math::Similarity(pdiff.parameters(),wmat);
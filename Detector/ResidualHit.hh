@@ -17,6 +17,7 @@ namespace KinKal {
       unsigned nDOF() const override;
       Chisq chisq(Parameters const& params) const override;
       Weights const& weight() const override { return weight_; }
+      bool kalmanUpdate(Parameters& params) const override;
       // describe residuals associated with this hit
       virtual unsigned nResid() const = 0;
       // reference residuals for this hit.  ires indexs the measurement and is hit-specific, outside the range will throw
@@ -24,16 +25,17 @@ namespace KinKal {
       virtual Residual const& refResidual(unsigned ires) const = 0;
      // residuals corrected to refer to the given set of parameters (1st-order)
       Residual residual(Parameters const& params, unsigned ires) const;
-      // unbiased residuals WRT the reference parameters; computed from the reference
+      // unbiased residuals WRT the reference parameters; computed from the reference.  These can throw (see Hit::unbiasedParameters)
       Residual residual(unsigned ires) const;
       // unbiased pull of this residual (including the uncertainty on the reference parameters)
       double pull(unsigned ires) const;
     protected:
-      ResidualHit() {}
+      ResidualHit() : varscale_(1.0) {}
       // ResidualHit specific interface
       void updateWeight(MetaIterConfig const& config);
     private:
       Weights weight_; // weight of this hit computed from the residuals
+      double varscale_; // variance scale used to compute the weight
   };
 
   template <class KTRAJ> Residual ResidualHit<KTRAJ>::residual(Parameters const& params,unsigned ires) const {
@@ -57,6 +59,28 @@ namespace KinKal {
     return ures.pull();
   }
 
+  template <class KTRAJ> bool ResidualHit<KTRAJ>::kalmanUpdate(Parameters& params) const {
+    // the residuals are uncorrelated, so each can be applied in sequence as a rank-1 (Sherman-Morrison) update with a scalar gain.
+    // This is equivalent to adding the weight, which is computed WRT the same reference
+    for(unsigned ires=0; ires< nResid(); ires++) {
+      auto const& resid = refResidual(ires);
+      if(resid.active()){
+        // residual WRT the current parameters (1st-order)
+        DVEC dpvec = params.parameters() - HIT::referenceParameters().parameters();
+        double uresid = resid.value() - ROOT::Math::Dot(dpvec,resid.dRdP());
+        DVEC cdrdp = params.covariance()*resid.dRdP();
+        double rvar = ROOT::Math::Dot(resid.dRdP(),cdrdp) + resid.measurementVariance()*varscale_;
+        if(!(rvar > 0.0)) throw std::runtime_error("Residual variance inconsistency");
+        params.parameters() += cdrdp*(uresid/rvar);
+        // symmetric rank-1 reduction of the covariance
+        for(size_t ipar=0; ipar < NParams(); ipar++)
+          for(size_t jpar=0; jpar <= ipar; jpar++)
+            params.covariance()(ipar,jpar) -= cdrdp[ipar]*cdrdp[jpar]/rvar;
+      }
+    }
+    return true;
+  }
+
   template <class KTRAJ> Chisq ResidualHit<KTRAJ>::chisq(Parameters const& params) const {
     double chisq(0.0);
     unsigned ndof(0);
@@ -80,9 +104,10 @@ namespace KinKal {
   template <class KTRAJ> void ResidualHit<KTRAJ>::updateWeight(MetaIterConfig const& miconfig) {
     // start by zeroing the weight, then augment with each residual's weight
     weight_ = Weights();
+    varscale_ = miconfig.varianceScale();
     for(unsigned ires=0; ires< nResid(); ires++) {
       auto const& resid = refResidual(ires);
-      if(resid.active())weight_ += resid.weight(HIT::referenceParameters().parameters(),miconfig.varianceScale());
+      if(resid.active())weight_ += resid.weight(HIT::referenceParameters().parameters(),varscale_);
     }
   }
 }
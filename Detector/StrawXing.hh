@@ -16,6 +16,7 @@ namespace KinKal {
       using PTRAJ = ParticleTrajectory<KTRAJ>;
       using KTRAJPTR = std::shared_ptr<KTRAJ>;
       using EXING = ElementXing<KTRAJ>;
+      using NOISEFACTOR = typename EXING::NOISEFACTOR;
       using PCA = PiecewiseClosestApproach<KTRAJ,Line>;
       using CA = ClosestApproach<KTRAJ,Line>;
       // construct from PCA and material
@@ -25,6 +26,7 @@ namespace KinKal {
       void updateReference(KTRAJPTR const& ktrajptr) override;
       void updateState(MetaIterConfig const& config,bool first) override;
       Parameters parameters(TimeDir tdir) const override;
+      bool lowRankParameters(TimeDir tdir, DVEC& dpvec, NOISEFACTOR& gmat) const override;
       double time() const override { return tpca_.particleToca() + toff_; } // offset time WRT TOCA to avoid exact overlapp with the wire hit
       double transitTime() const override; // time to cross this element
       KTRAJ const& referenceTrajectory() const override { return tpca_.particleTraj(); }
@@ -34,7 +36,7 @@ namespace KinKal {
       auto const& closestApproach() const { return tpca_; }
       auto const& strawMaterial() const { return smat_; }
       auto const& config() const { return sxconfig_; }
-      auto precision() const { return tpca_.precision(); }
+      double precision() const { return precision_; }
     private:
       Line axis_; // straw axis, expressed as a timeline
       StrawMaterial const& smat_;
@@ -44,6 +46,10 @@ namespace KinKal {
       double varscale_; // variance scale
       std::vector<MaterialXing> mxings_;
       Parameters fparams_; // parameter change for forwards time
+      NOISEFACTOR fnoise_; // factor of the covariance of fparams_, 1 column per momentum direction
+      double precision_; // nominal TCA precision
+      double tcaprec_; // TCA precision for the current meta-iteration
+      CAConfig caconfig_; // TCA configuration for the current meta-iteration
   };
 
   template <class KTRAJ> StrawXing<KTRAJ>::StrawXing(PCA const& pca, StrawMaterial const& smat) :
@@ -51,16 +57,20 @@ namespace KinKal {
     smat_(smat),
     tpca_(pca.localTraj(),axis_,pca.precision(),pca.tpData(),pca.dDdP(),pca.dTdP()),
     toff_(smat.wireRadius()/pca.particleTraj().speed(pca.particleToca())), // locate the effect to 1 side of the wire to avoid overlap with hits
-    varscale_(1.0)
+    varscale_(1.0),
+    precision_(pca.precision()), tcaprec_(precision_)
   {}
 
   template <class KTRAJ> void StrawXing<KTRAJ>::updateReference(KTRAJPTR const& ktrajptr) {
     CAHint tphint = tpca_.usable() ?  tpca_.hint() : CAHint(axis_.range().mid(),axis_.range().mid());
-    tpca_ = CA(ktrajptr,axis_,tphint,precision());
+    tpca_ = CA(ktrajptr,axis_,tphint,tcaprec_,caconfig_);
     if(!tpca_.usable())throw std::runtime_error("StrawXing TPOCA failure");
   }
 
   template <class KTRAJ> void StrawXing<KTRAJ>::updateState(MetaIterConfig const& miconfig,bool first) {
+    // closest approach policy used when updating the reference in this meta-iteration
+    tcaprec_ = miconfig.tcaPrecision(precision());
+    caconfig_.maxiter_ = miconfig.tcaMaxIterations();
     if(first) {
       // search for an update to the xing configuration among this meta-iteration payload
       auto sxconfig = miconfig.findUpdater<StrawXingConfig>();
@@ -75,17 +85,20 @@ namespace KinKal {
     smat_.findXings(tpca_.tpData(),sxconfig_,mxings_);
     // reset
     fparams_ = Parameters();
+    fnoise_ = NOISEFACTOR();
     if(mxings_.size() > 0){
       // compute the parameter effect for forwards time
       std::array<double,3> dmom = {0.0,0.0,0.0}, momvar = {0.0,0.0,0.0};
       this->materialEffects(TimeDir::forwards, dmom, momvar);
-      // get the parameter derivative WRT momentum
-      DPDV dPdM = referenceTrajectory().dPardM(time());
+      // get the parameter derivative WRT momentum and the momentum basis together
+      TrajEvaluation eval;
+      referenceTrajectory().evaluate(time(),TrajEvaluation::basis|TrajEvaluation::dPardM,eval);
+      DPDV const& dPdM = eval.dPdM_;
       double mommag = referenceTrajectory().momentum(time());
       // loop over the momentum change basis directions, adding up the effects on parameters from each
       for(int idir=0;idir<MomBasis::ndir; idir++) {
         auto mdir = static_cast<MomBasis::Direction>(idir);
-        auto dir = referenceTrajectory().direction(time(),mdir);
+        auto const& dir = eval.direction(mdir);
         // project the momentum derivatives onto this direction
         DVEC pder = mommag*(dPdM*SVEC3(dir.X(), dir.Y(), dir.Z()));
         // convert derivative vector to a Nx1 matrix
@@ -97,6 +110,7 @@ namespace KinKal {
         ROOT::Math::SMatrix<double, 1,1, ROOT::Math::MatRepSym<double,1>> MVar;
         MVar(0,0) = momvar[idir]*varscale_;
         fparams_.covariance() += ROOT::Math::Similarity(dPdm,MVar);
+        fnoise_.Place_in_col(pder*sqrt(MVar(0,0)),0,idir);
       }
     }
   }
@@ -108,6 +122,12 @@ namespace KinKal {
       return Parameters(-fparams_.parameters(),fparams_.covariance());
   }
 
+  template <class KTRAJ> bool StrawXing<KTRAJ>::lowRankParameters(TimeDir tdir, DVEC& dpvec, NOISEFACTOR& gmat) const {
+    dpvec = tdir == TimeDir::forwards ? fparams_.parameters() : -fparams_.parameters();
+    gmat = fnoise_;
+    return true;
+  }
+
   template <class KTRAJ> double StrawXing<KTRAJ>::transitTime() const {
     return smat_.transitLength(tpca_.tpData())/tpca_.particleTraj().speed(tpca_.particleToca());
   }
@@ -33,18 +33,22 @@ namespace KinKal {
       auto const& closestApproach() const { return tpca_; }
       double timeVariance() const { return tvar_; }
       double widthVariance() const { return wvar_; }
-      auto precision() const { return tpca_.precision(); }
+      double precision() const { return precision_; }
     private:
       Line saxis_; // symmetry axis of this sensor
       double tvar_; // variance in the time measurement: assumed independent of propagation distance/time
       double wvar_; // variance in transverse position of the sensor/measurement in mm.  Assumes cylindrical error, could be more general
       CA tpca_; // reference time and position of closest approach to the axis
       Residual rresid_; // residual WRT most recent reference parameters
+      double precision_; // nominal TCA precision
+      double tcaprec_; // TCA precision for the current meta-iteration
+      CAConfig caconfig_; // TCA configuration for the current meta-iteration
   };
 
   template <class KTRAJ> ScintHit<KTRAJ>::ScintHit(PCA const& pca, double tvar, double wvar) :
     saxis_(pca.sensorTraj()), tvar_(tvar), wvar_(wvar),
-    tpca_(pca.localTraj(),saxis_,pca.precision(),pca.tpData(),pca.dDdP(),pca.dTdP())
+    tpca_(pca.localTraj(),saxis_,pca.precision(),pca.tpData(),pca.dDdP(),pca.dTdP()),
+    precision_(pca.precision()), tcaprec_(precision_)
   {}
 
   template <class KTRAJ> Residual const& ScintHit<KTRAJ>::refResidual(unsigned ires) const {
@@ -55,11 +59,14 @@ namespace KinKal {
   template <class KTRAJ> void ScintHit<KTRAJ>::updateReference(KTRAJPTR const& ktrajptr) {
     // use previous hint, or initialize from the sensor time
     CAHint tphint = tpca_.usable() ?  tpca_.hint() : CAHint(saxis_.t0(), saxis_.t0());
-    tpca_ = CA(ktrajptr,saxis_,tphint,precision());
+    tpca_ = CA(ktrajptr,saxis_,tphint,tcaprec_,caconfig_);
     if(!tpca_.usable())throw std::runtime_error("ScintHit TPOCA failure");
   }
 
   template <class KTRAJ> void ScintHit<KTRAJ>::updateState(MetaIterConfig const& config,bool first) {
+    // closest approach policy used when updating the reference in this meta-iteration
+    tcaprec_ = config.tcaPrecision(precision());
+    caconfig_.maxiter_ = config.tcaMaxIterations();
     // check that TPCA position is consistent with the physical sensor. This can be off if the CA algorithm finds the wrong helix branch
     // early in the fit when t0 has very large errors.
     // If it is unphysical try to adjust it back using a better hint.
@@ -76,7 +83,7 @@ namespace KinKal {
       double sdist = (ppos - saxis_.position3(saxis_.range().mid())).Dot(saxis_.direction());
       auto tphint = tpca_.hint();
       tphint.particleToca_ -= sdist/sspeed;
-      tpca_ = CA(tpca_.particleTrajPtr(),saxis_,tphint,precision());
+      tpca_ = CA(tpca_.particleTrajPtr(),saxis_,tphint,tcaprec_,caconfig_);
       // should check if this is still unphysical and disable the hit if so FIXME
     }
     // residual is just delta-T at CA.
@@ -42,12 +42,13 @@ namespace KinKal {
       double timeVariance() const { return tvar_; }
       double minDOCA() const { return mindoca_; }
       int id() const { return id_; }
+      // closest approach of the fit excluding this hit.  If this hit dominates the fit there are no unbiased parameters, and the result isn't usable
       CA unbiasedClosestApproach() const;
       auto const& closestApproach() const { return ca_; }
       auto const& hitState() const { return whstate_; }
       auto const& wire() const { return wire_; }
       auto const& bfield() const { return bfield_; }
-      auto precision() const { return ca_.precision(); }
+      double precision() const { return precision_; }
     private:
       BFieldMap const& bfield_; // drift calculation requires the BField for ExB effects
       WireHitState whstate_; // current state
@@ -63,6 +64,9 @@ namespace KinKal {
       double tvar_; // constant time variance
       double rcell_; // straw radius
       int id_; // id
+      double precision_; // nominal TCA precision
+      double tcaprec_; // TCA precision for the current meta-iteration
+      CAConfig caconfig_; // TCA configuration for the current meta-iteration
       void updateResiduals();
  };
 
@@ -77,14 +81,14 @@ namespace KinKal {
     bfield_(bfield),
     whstate_(whstate), wire_(pca.sensorTraj()),
     ca_(pca.localTraj(),wire_,pca.precision(),pca.tpData(),pca.dDdP(),pca.dTdP()),
-    mindoca_(mindoca), dvel_(driftspeed), tvar_(tvar), rcell_(rcell), id_(id) {
+    mindoca_(mindoca), dvel_(driftspeed), tvar_(tvar), rcell_(rcell), id_(id), precision_(pca.precision()), tcaprec_(precision_) {
     }
 
   template <class KTRAJ> void SimpleWireHit<KTRAJ>::updateReference(KTRAJPTR const& ktrajptr) {
     // if we already computed PCA in the previous iteration, use that to set the hint.  This speeds convergence
     // otherwise use the time at the center of the wire
     CAHint tphint = ca_.usable() ?  ca_.hint() : CAHint(wire_.range().mid(),wire_.range().mid());
-    ca_ = CA(ktrajptr,wire_,tphint,precision());
+    ca_ = CA(ktrajptr,wire_,tphint,tcaprec_,caconfig_);
     if(!ca_.usable())throw std::runtime_error("WireHit TPOCA failure");
   }
 
@@ -107,6 +111,9 @@ namespace KinKal {
   }
 
   template <class KTRAJ> void SimpleWireHit<KTRAJ>::updateState(MetaIterConfig const& miconfig, bool first) {
+    // closest approach policy used when updating the reference in this meta-iteration
+    tcaprec_ = miconfig.tcaPrecision(precision());
+    caconfig_.maxiter_ = miconfig.tcaMaxIterations();
     if(first){
       // look for an updater; if found, use it to update the state
       auto nwhu = miconfig.findUpdater<NullWireHitUpdater>();
@@ -164,7 +171,14 @@ namespace KinKal {
  template <class KTRAJ> ClosestApproach<KTRAJ,Line> SimpleWireHit<KTRAJ>::unbiasedClosestApproach() const {
     // compute the unbiased closest approach; this is brute force, but works
     auto const& ca = this->closestApproach();
-    auto uparams = HIT::unbiasedParameters();
+    Parameters uparams;
+    try {
+      uparams = HIT::unbiasedParameters();
+    } catch (std::runtime_error const&) {
+      // this hit dominates the reference information, so there are no unbiased parameters.  Return a closest approach without a solution
+      // (status invalid), so the caller treats the hit as an outlier
+      return CA(ca.particleTrajPtr(),this->wire(),ca.precision(),ca.config());
+    }
     KTRAJ utraj(uparams,ca.particleTraj());
     return CA(utraj,this->wire(),ca.hint(),ca.precision());
   }
@@ -11,6 +11,8 @@
 #include <iostream>
 #include <stdexcept>
 #include <array>
+#include <limits>
+#include <algorithm>
 #include <ostream>
 
 namespace KinKal {
@@ -28,6 +30,8 @@ namespace KinKal {
       void print(std::ostream& ost=std::cout,int detail=0) const override;
       void append(PTRAJ& fit,TimeDir tdir) override;
       Chisq chisq(Parameters const& pdata) const override { return Chisq();}
+      double change(Parameters const& refparams) const override;
+      void reuse(TimeDir tdir) override {} // no state from processing
       auto const& parameterChange() const { return dpfwd_; }
       virtual ~BField(){}
       // disallow copy and equivalence
@@ -35,7 +39,7 @@ namespace KinKal {
       BField& operator =(BField const& ) = delete;
       // create from the domain range, the effect, and the
       BField(Config const& config, BFieldMap const& bfield,TimeRange const& drange) :
-        bfield_(bfield), drange_(drange), bfcorr_(config.bfcorr_) {}
+        bfield_(bfield), drange_(drange), bfcorr_(config.bfcorr_), processed_{false,false}, pbfcorr_{false,false} {}
       TimeRange const& range() const { return drange_; }
 
     private:
@@ -43,15 +47,31 @@ namespace KinKal {
       TimeRange drange_; // extent of this effect.  The middle is at the transition point between 2 bfield domains (domain transition)
       DVEC dpfwd_; // aggregate effect in parameter space of BFieldMap change over this domain in the forwards time direction
       bool bfcorr_; // apply correction or not
+      // parameter change when last processed in each direction.  These are kept separately so the directions can be processed concurrently
+      std::array<DVEC,2> pdpfwd_;
+      std::array<bool,2> processed_, pbfcorr_; // whether each direction has been processed, and if the correction was applied then
   };
 
   template<class KTRAJ> void BField<KTRAJ>::process(FitState& kkdata,TimeDir tdir) {
+    size_t idir = static_cast<size_t>(tdir);
+    processed_[idir] = true;
+    pbfcorr_[idir] = bfcorr_;
+    pdpfwd_[idir] = dpfwd_;
     if(bfcorr_){
       kkdata.append(dpfwd_,tdir);
       // rotate the covariance matrix for the change in BField.  This requires 2nd derivatives TODO
     }
   }
 
+  template<class KTRAJ> double BField<KTRAJ>::change(Parameters const& refparams) const {
+    double retval(0.0);
+    for(size_t idir=0; idir < pdpfwd_.size(); idir++){
+      if(!processed_[idir] || bfcorr_ != pbfcorr_[idir]) return std::numeric_limits<double>::max();
+      if(bfcorr_)retval = std::max(retval,KKEFF::parameterChange(pdpfwd_[idir],dpfwd_,refparams.covariance()));
+    }
+    return retval;
+  }
+
   template<class KTRAJ> void BField<KTRAJ>::append(PTRAJ& ptraj,TimeDir tdir) {
     if(bfcorr_){
       double etime = time();
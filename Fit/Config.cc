@@ -10,6 +10,12 @@ namespace KinKal {
       << " fractional momentum tolerance " << kkconfig.tol_
       << " min NDOF " << kkconfig.minndof_
       << " BField correction " << kkconfig.bfcorr_
+      << " cache states " << kkconfig.cachestates_
+      << " incremental " << kkconfig.incremental_
+      << " incremental tolerance " << kkconfig.inctol_
+      << " min parallel effects " << kkconfig.minparallel_
+      << " parameter update " << kkconfig.paramupdate_
+      << " weight noise " << kkconfig.wnoise_
       << " with " << kkconfig.schedule().size()
       << " Meta-iterations:" << std::endl;
     for(auto const& miconfig : kkconfig.schedule() ) {
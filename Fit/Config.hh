@@ -20,7 +20,7 @@ namespace KinKal {
     using Schedule =  std::vector<MetaIterConfig>;
     explicit Config(Schedule const& schedule) : Config() { schedule_ = schedule; }
     Config() : maxniter_(10), dwt_(1.0e6), convdchisq_(0.01), divdchisq_(10.0), pdchisq_(1.0e6), divgap_(10.0),
-    tol_(1.0e-4), minndof_(5), bfcorr_(true), ends_(true), plevel_(none) {}
+    tol_(1.0e-4), minndof_(5), bfcorr_(true), ends_(true), cachestates_(false), incremental_(false), inctol_(1.0e-3), minparallel_(0), paramupdate_(false), wnoise_(false), plevel_(none) {}
     Schedule& schedule() { return schedule_; }
     Schedule const& schedule() const { return schedule_; }
 
@@ -35,6 +35,13 @@ namespace KinKal {
     unsigned minndof_; // minimum number of DOFs to continue fit
     bool bfcorr_; // whether to make BFieldMap corrections in the fit
     bool ends_; // process the passive effects at each end of the track after schedule completion
+    bool cachestates_; // keep the forward and backward fit states at each effect, to compute unbiased hit parameters without inversion
+    bool incremental_; // reuse the cached fit states around effects (and the seed) whose contribution hasn't changed since the previous iteration.
+                       // The result approximates the full refit, each reused contribution being within inctol_ of its current value
+    double inctol_; // maximum change (units of chisquared) in an effect's contribution for it to be considered unchanged in incremental fits
+    size_t minparallel_; // minimum number of effects in the fit range to run the forward and backward passes on separate threads (0 = never)
+    bool paramupdate_; // apply measurements directly to the parameters (Kalman gain) when the fit state is in parameter space, avoiding inversions
+    bool wnoise_; // add low-rank material noise directly to the weights (Woodbury) when the fit state is in weight space, avoiding inversions
     printLevel plevel_; // print level
     // schedule of meta-iterations.  These will be executed sequentially until completion or failure
     Schedule schedule_;
@@ -11,6 +11,7 @@
 #include "KinKal/Fit/Config.hh"
 #include "KinKal/General/TimeRange.hh"
 #include <array>
+#include <cmath>
 #include <memory>
 #include <ostream>
 
@@ -38,13 +39,50 @@ namespace KinKal {
       virtual void updateReference(KTRAJPTR const& ltraj) =0;
       // chisquared WRT a given local parameter set, assumed uncorrelatedd  This is used for convergence testing
       virtual Chisq chisq(Parameters const& pdata) const  = 0;
+      // dimensionless (chisquared) size of the change in this effect's contribution to the fit since it was last processed,
+      // given the reference parameters (with covariance) at this effect.  This is used to decide if an incremental fit can skip it
+      virtual double change(Parameters const& refparams) const = 0;
+      // account for this effect without processing it, when the fit state around it is reused from a previous pass
+      virtual void reuse(TimeDir tdir) = 0;
       // diagnostic printout
       virtual void print(std::ostream& ost=std::cout,int detail=0) const =0;
       // disallow copy and equivalence
       Effect(Effect const& ) = delete;
       Effect& operator =(Effect const& ) = delete;
+      // change of a weight-space contribution, projected on the reference covariance.  This is also used for the fit seed
+      static double weightChange(Weights const& oldwt, Weights const& newwt, DMAT const& refcov);
+      // change of a parameter-space contribution, using just the diagonal of the reference covariance (to avoid inversion)
+      static double parameterChange(Parameters const& oldpars, Parameters const& newpars, DMAT const& refcov);
+      static double parameterChange(DVEC const& oldpvec, DVEC const& newpvec, DMAT const& refcov);
   };
 
+  template<class KTRAJ> double Effect<KTRAJ>::weightChange(Weights const& oldwt, Weights const& newwt, DMAT const& refcov) {
+    // the vector change shifts the parameters by refcov*dvec, the matrix change scales the information
+    DVEC dvec = newwt.weightVec() - oldwt.weightVec();
+    DMAT dmat = newwt.weightMat() - oldwt.weightMat();
+    double trace(0.0);
+    for(size_t ipar=0; ipar < NParams(); ipar++)
+      for(size_t jpar=0; jpar < NParams(); jpar++)
+        trace += refcov(ipar,jpar)*dmat(jpar,ipar);
+    return ROOT::Math::Similarity(dvec,refcov) + fabs(trace);
+  }
+
+  template<class KTRAJ> double Effect<KTRAJ>::parameterChange(Parameters const& oldpars, Parameters const& newpars, DMAT const& refcov) {
+    double retval = parameterChange(oldpars.parameters(),newpars.parameters(),refcov);
+    for(size_t ipar=0; ipar < NParams(); ipar++)
+      retval += fabs(newpars.covariance()(ipar,ipar) - oldpars.covariance()(ipar,ipar))/refcov(ipar,ipar);
+    return retval;
+  }
+
+  template<class KTRAJ> double Effect<KTRAJ>::parameterChange(DVEC const& oldpvec, DVEC const& newpvec, DMAT const& refcov) {
+    double retval(0.0);
+    for(size_t ipar=0; ipar < NParams(); ipar++){
+      double dpar = newpvec(ipar) - oldpvec(ipar);
+      retval += dpar*dpar/refcov(ipar,ipar);
+    }
+    return retval;
+  }
+
   template <class KTRAJ> std::ostream& operator <<(std::ostream& ost, Effect<KTRAJ> const& eff) {
     ost << (eff.active() ? "Active " : "Inactive ") << "time " << eff.time();
     return ost;
@@ -0,0 +1,60 @@
+#include "KinKal/Fit/FitProfile.hh"
+#include <iostream>
+namespace KinKal {
+
+  std::string const& FitProfile::phaseName(Phase phase) {
+    static const std::array<std::string,nphases+1> names = {"UpdateState","ForwardProcess","BackwardProcess","Append","SetStatus",
+      "CreateDomains","ReplaceTraj","Unknown"};
+    return phase < nphases ? names[phase] : names[nphases];
+  }
+
+  FitProfile::PhaseProfile& FitProfile::PhaseProfile::operator +=(PhaseProfile const& other) {
+    time_ += other.time_;
+    ncalls_ += other.ncalls_;
+    counts_.ninversions_ += other.counts_.ninversions_;
+    counts_.ntcaiters_ += other.counts_.ntcaiters_;
+    counts_.npieceallocs_ += other.counts_.npieceallocs_;
+    return *this;
+  }
+
+  FitProfile::PHASES FitProfile::total() const {
+    PHASES retval = setup();
+    for(auto const& iprof : iterations())
+      for(size_t iphase=0; iphase < nphases; iphase++) retval[iphase] += iprof.phases_[iphase];
+    return retval;
+  }
+
+  void FitProfile::print(std::ostream& ost,int detail) const {
+    auto printPhases = [&ost](PHASES const& phases) {
+      for(size_t iphase=0; iphase < nphases; iphase++){
+        auto const& phase = phases[iphase];
+        if(phase.ncalls_ > 0)
+          ost << "  " << phaseName(static_cast<Phase>(iphase))
+            << " time " << phase.time_*1.0e6 << " us"
+            << " calls " << phase.ncalls_
+            << " inversions " << phase.counts_.ninversions_
+            << " TCA iterations " << phase.counts_.ntcaiters_
+            << " piece allocations " << phase.counts_.npieceallocs_ << std::endl;
+      }
+    };
+    if(!enabled()){
+      ost << "Fit profiling disabled (build with KINKAL_PROFILE)" << std::endl;
+      return;
+    }
+    ost << "Fit Profile " << iterations().size() << " iterations, total" << std::endl;
+    printPhases(total());
+    if(detail > 0){
+      ost << " Setup" << std::endl;
+      printPhases(setup());
+      for(auto const& iprof : iterations()){
+        ost << " Meta-iteration " << iprof.miter_ << " iteration " << iprof.iter_ << std::endl;
+        printPhases(iprof.phases_);
+      }
+    }
+  }
+
+  std::ostream& operator <<(std::ostream& ost, FitProfile const& profile) {
+    profile.print(ost,0);
+    return ost;
+  }
+}
@@ -0,0 +1,98 @@
+#ifndef KinKal_FitProfile_hh
+#define KinKal_FitProfile_hh
+//
+//  Profile of where the time of a fit goes: wall time, calls, matrix inversions, TCA iterations and trajectory piece allocations
+//  for each phase of each fit iteration.  Work done outside the iterations (construction and extension) is recorded separately.
+//  Recording is only compiled in when KINKAL_PROFILE is defined (cmake -DKINKAL_PROFILE=ON).  Otherwise the timers
+//  do nothing and the profile stays empty.  The class layout doesn't depend on KINKAL_PROFILE, so code built with and
+//  without it (eg a client of an installed KinKal) can share Track objects.
+//
+#include "KinKal/General/ProfileCounters.hh"
+#include <array>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+
+namespace KinKal {
+  class FitProfile {
+    public:
+      enum Phase {updateState=0,forwardProcess,backwardProcess,append,setStatus,createDomains,replaceTraj,nphases};
+      static std::string const& phaseName(Phase phase);
+      static constexpr bool enabled() {
+#ifdef KINKAL_PROFILE
+        return true;
+#else
+        return false;
+#endif
+      }
+      // resource use of a single phase
+      struct PhaseProfile {
+        double time_ = 0.0; // wall time (seconds)
+        unsigned long ncalls_ = 0; // number of times this phase was executed
+        ProfileCounters counts_; // low-level operations done in this phase
+        PhaseProfile& operator +=(PhaseProfile const& other);
+      };
+      using PHASES = std::array<PhaseProfile,nphases>;
+      struct IterationProfile {
+        unsigned miter_, iter_; // meta-iteration and iteration, as in Status
+        PHASES phases_;
+        IterationProfile(unsigned miter, unsigned iter) : miter_(miter), iter_(iter) {}
+      };
+      // record a phase for the lifetime of this object
+      class Timer {
+        public:
+          Timer(FitProfile& profile, Phase phase);
+          ~Timer();
+          Timer(Timer const&) = delete;
+          Timer& operator =(Timer const&) = delete;
+        private:
+          using Clock = std::chrono::steady_clock;
+          PhaseProfile* phase_ = nullptr; // phase being recorded; null when profiling is disabled
+          ProfileCounters counts_; // counters when the phase started
+          Clock::time_point start_;
+      };
+      // start recording a new iteration.  This must not be called while a Timer is active
+      void beginIteration(unsigned miter, unsigned iter) {
+        if(enabled()){
+          iterations_.emplace_back(miter,iter);
+          initer_ = true;
+        }
+      }
+      // subsequent phases are outside the fit iterations
+      void endIteration() { initer_ = false; }
+      // accessors; without profiling these are always empty
+      std::vector<IterationProfile> const& iterations() const { return iterations_; }
+      PHASES const& setup() const { return setup_; }
+      // sum over all iterations and the setup
+      PHASES total() const;
+      void print(std::ostream& ost=std::cout,int detail=0) const;
+    private:
+      PHASES& current() { return initer_ && iterations_.size() > 0 ? iterations_.back().phases_ : setup_; }
+      std::vector<IterationProfile> iterations_; // profile of each iteration
+      PHASES setup_; // profile of work outside the iterations
+      bool initer_ = false; // whether an iteration is being recorded
+  };
+
+  inline FitProfile::Timer::Timer(FitProfile& profile, Phase phase) {
+#ifdef KINKAL_PROFILE
+    phase_ = &profile.current()[phase];
+    counts_ = ProfileCounters::local();
+    start_ = Clock::now();
+#endif
+  }
+
+  inline FitProfile::Timer::~Timer() {
+#ifdef KINKAL_PROFILE
+    auto const& counts = ProfileCounters::local();
+    phase_->time_ += std::chrono::duration<double>(Clock::now()-start_).count();
+    phase_->ncalls_++;
+    phase_->counts_.ninversions_ += counts.ninversions_ - counts_.ninversions_;
+    phase_->counts_.ntcaiters_ += counts.ntcaiters_ - counts_.ntcaiters_;
+    phase_->counts_.npieceallocs_ += counts.npieceallocs_ - counts_.npieceallocs_;
+#endif
+  }
+
+  std::ostream& operator <<(std::ostream& ost, FitProfile const& profile);
+}
+#endif
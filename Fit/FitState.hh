@@ -44,6 +44,21 @@ namespace KinKal {
         hasParameters_ = false;
       }
 
+      // update the parameters in place.  The function should return false (without modifying them) if it can't.  This requires
+      // the state to have parameters.  A successful update invalidates the weight information
+      template <class FUNC> bool updateParameters(FUNC const& func) {
+        if(!hasParameters_ || !func(pdata_)) return false;
+        hasWeights_ = false;
+        return true;
+      }
+
+      // same for the weights.  A successful update invalidates the parameter information
+      template <class FUNC> bool updateWeights(FUNC const& func) {
+        if(!hasWeights_ || !func(wdata_)) return false;
+        hasParameters_ = false;
+        return true;
+      }
+
       Parameters& pData() {
         if(!hasParameters_ && hasWeights_ ){
           // invert the weight
@@ -2,7 +2,8 @@
 #define KinKal_Material_hh
 //
 // Class to describe effect of a particle passing through discrete material on the fit (ie material transport)
-// This effect adds no information content, just noise, and is KKEFF::processed in params space
+// This effect adds no information content, just noise, and is KKEFF::processed in params space, or optionally in weight space
+// using the low-rank form of the noise
 //
 #include "KinKal/Fit/Effect.hh"
 #include "KinKal/Detector/ElementXing.hh"
@@ -10,6 +11,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <array>
+#include <limits>
 #include <ostream>
 
 namespace KinKal {
@@ -24,45 +26,90 @@ namespace KinKal {
       bool active() const override { return  exing_->active(); }
       void process(FitState& kkdata,TimeDir tdir) override;
       void updateState(MetaIterConfig const& miconfig,bool first) override;
-      void updateConfig(Config const& config) override {}
+      void updateConfig(Config const& config) override { wnoise_ = config.wnoise_; }
       void append(PTRAJ& fit,TimeDir tdir) override;
       void updateReference(KTRAJPTR const& ltrajptr) override;
       Chisq chisq(Parameters const& pdata) const override { return Chisq();}
+      double change(Parameters const& refparams) const override;
+      void reuse(TimeDir tdir) override;
       void print(std::ostream& ost=std::cout,int detail=0) const override;
       virtual ~Material(){}
-      // create from the material and a trajectory
-      Material(EXINGPTR const& dxing, PTRAJ const& ptraj);
+      // create from the material, a trajectory and the fit configuration
+      Material(EXINGPTR const& dxing, PTRAJ const& ptraj, Config const& config);
       // accessors
-      auto const& cache() const { return cache_; }
+      Weights cache() const; // combined weights of the processing in both directions
       auto const& elementXing() const { return *exing_; }
       auto const& elementXingPtr() const { return exing_; }
       auto const& referenceTrajectory() const { return exing_->referenceTrajectory(); }
     private:
       EXINGPTR exing_; // element crossing for this effect
-      Weights cache_; // cache of weight processing in opposite directions, used to build the fit trajectory
+      bool wnoise_; // add the noise in weight space when possible
+      // cache of weight processing in opposite directions, used to build the fit trajectory.  Processing in one direction
+      // only touches that direction's data, so the passes can run concurrently
+      std::array<Weights,2> cache_;
+      std::array<bool,2> cached_; // whether each direction's cache is set for the current iteration
+      std::array<Parameters,2> pparams_; // parameter change in each direction when last processed
+      std::array<bool,2> processed_, pactive_; // whether each direction has been processed, and if this was active then
   };
 
-  template<class KTRAJ> Material<KTRAJ>::Material(EXINGPTR const& dxing, PTRAJ const& ptraj) : exing_(dxing) {}
+  template<class KTRAJ> Material<KTRAJ>::Material(EXINGPTR const& dxing, PTRAJ const& ptraj, Config const& config) : exing_(dxing),
+  wnoise_(config.wnoise_), cached_{false,false}, processed_{false,false}, pactive_{false,false} {}
 
   template<class KTRAJ> void Material<KTRAJ>::process(FitState& kkdata,TimeDir tdir) {
-    if(exing_->active()){
+    size_t idir = static_cast<size_t>(tdir);
+    processed_[idir] = true;
+    pactive_[idir] = exing_->active();
+    if(pactive_[idir]){
+      pparams_[idir] = exing_->parameters(tdir);
+      // if the state is in weight space (ie after a measurement) add the noise there if the xing allows, to avoid inversions
+      auto append = [this,&kkdata,tdir,idir](){
+        if(!(wnoise_ && kkdata.updateWeights([this,tdir](Weights& wdata){
+                typename EXING::NOISEFACTOR gmat;
+                DVEC dpvec;
+                return exing_->lowRankParameters(tdir,dpvec,gmat) && wdata.addNoise(dpvec,gmat); })))
+          kkdata.append(pparams_[idir]);
+      };
       // forwards, set the cache AFTER processing this effect
       if(tdir == TimeDir::forwards) {
-        kkdata.append(exing_->parameters(tdir));
-        cache_ += kkdata.wData();
+        append();
+        cache_[idir] = kkdata.wData();
       } else {
         // backwards, set the cache BEFORE processing this effect, to avoid double-counting it
-        cache_ += kkdata.wData();
-        kkdata.append(exing_->parameters(tdir));
+        cache_[idir] = kkdata.wData();
+        append();
       }
+      cached_[idir] = true;
+    }
+  }
+
+  template<class KTRAJ> double Material<KTRAJ>::change(Parameters const& refparams) const {
+    double retval(0.0);
+    for(TimeDir tdir=TimeDir::forwards; tdir < TimeDir::end; ++tdir){
+      size_t idir = static_cast<size_t>(tdir);
+      if(!processed_[idir] || exing_->active() != pactive_[idir]) return std::numeric_limits<double>::max();
+      if(pactive_[idir])retval = std::max(retval,KKEFF::parameterChange(pparams_[idir],exing_->parameters(tdir),refparams.covariance()));
     }
+    return retval;
+  }
+
+  template<class KTRAJ> void Material<KTRAJ>::reuse(TimeDir tdir) {
+    // the cache from the last processing in this direction is still valid
+    size_t idir = static_cast<size_t>(tdir);
+    if(pactive_[idir])cached_[idir] = true;
   }
 
   template<class KTRAJ> void Material<KTRAJ>::updateState(MetaIterConfig const& miconfig,bool first) {
     // update the ElementXing
     exing_->updateState(miconfig,first);
-    // reset the cached weights
-    cache_ = Weights();
+    // invalidate the cached weights
+    cached_ = {false,false};
+  }
+
+  template<class KTRAJ> Weights Material<KTRAJ>::cache() const {
+    Weights retval;
+    for(size_t idir=0; idir < cache_.size(); idir++)
+      if(cached_[idir])retval += cache_[idir];
+    return retval;
   }
 
   template<class KTRAJ> void Material<KTRAJ>::append(PTRAJ& ptraj,TimeDir tdir) {
@@ -74,7 +121,7 @@ namespace KinKal {
           (tdir == TimeDir::backwards && etime > ptraj.front().range().end()) )
         throw std::invalid_argument("New piece overlaps existing");
       KTRAJ newpiece = (tdir == TimeDir::forwards) ? ptraj.back() : ptraj.front();
-      newpiece.params() = Parameters(cache_);
+      newpiece.params() = Parameters(cache());
       // make sure the range includes the transit time
       newpiece.range() = (tdir == TimeDir::forwards) ? TimeRange(etime,std::max(ptraj.range().end(),etime+exing_->transitTime())) :
         TimeRange(std::min(ptraj.range().begin(),etime-exing_->transitTime()),etime);
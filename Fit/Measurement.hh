@@ -9,6 +9,9 @@
 #include "KinKal/Detector/Hit.hh"
 #include <ostream>
 #include <memory>
+#include <limits>
+#include <array>
+#include <algorithm>
 
 namespace KinKal {
   template <class KTRAJ> class Measurement : public Effect<KTRAJ> {
@@ -23,26 +26,50 @@ namespace KinKal {
       bool active() const override { return hit_->active(); }
       void process(FitState& kkdata,TimeDir tdir) override;
       void updateState(MetaIterConfig const& miconfig,bool first) override;
-      void updateConfig(Config const& config) override {}
+      void updateConfig(Config const& config) override { paramupdate_ = config.paramupdate_; }
       void updateReference(KTRAJPTR const& ltrajptr) override;
       void append(PTRAJ& fit,TimeDir tdir) override;
       Chisq chisq(Parameters const& pdata) const override;
+      double change(Parameters const& refparams) const override;
+      void reuse(TimeDir tdir) override {} // hits have no state from processing
       void print(std::ostream& ost=std::cout,int detail=0) const override;
       virtual ~Measurement(){}
       // local functions
-      // construct from a hit and reference trajectory
-      Measurement(HITPTR const& hit);
+      // construct from a hit and the fit configuration
+      Measurement(HITPTR const& hit, Config const& config);
       // access the underlying hit
       HITPTR const& hit() const { return hit_; }
     private:
       HITPTR hit_ ; // hit used for this constraint
+      bool paramupdate_; // update states in parameter space when possible
+      // weight used when last processed in each direction.  These are kept separately so the directions can be processed concurrently
+      std::array<Weights,2> pweight_;
+      std::array<bool,2> processed_, pactive_; // whether each direction has been processed, and if this was active then
   };
 
-  template<class KTRAJ> Measurement<KTRAJ>::Measurement(HITPTR const& hit) : hit_(hit) {}
+  template<class KTRAJ> Measurement<KTRAJ>::Measurement(HITPTR const& hit, Config const& config) : hit_(hit), paramupdate_(config.paramupdate_),
+  processed_{false,false}, pactive_{false,false} {}
 
   template<class KTRAJ> void Measurement<KTRAJ>::process(FitState& kkdata,TimeDir tdir) {
     // add this effect's information. direction is irrelevant for processing hits
-    if(this->active())kkdata.append(hit_->weight());
+    size_t idir = static_cast<size_t>(tdir);
+    processed_[idir] = true;
+    pactive_[idir] = this->active();
+    if(pactive_[idir]){
+      pweight_[idir] = hit_->weight();
+      // if the state is in parameter space (ie after a material effect), update it there if the hit allows, to avoid inversions
+      if(!(paramupdate_ && kkdata.updateParameters([this](Parameters& pdata){ return hit_->kalmanUpdate(pdata); })))
+        kkdata.append(pweight_[idir]);
+    }
+  }
+
+  template<class KTRAJ> double Measurement<KTRAJ>::change(Parameters const& refparams) const {
+    double retval(0.0);
+    for(size_t idir=0; idir < pweight_.size(); idir++){
+      if(!processed_[idir] || this->active() != pactive_[idir]) return std::numeric_limits<double>::max();
+      if(pactive_[idir])retval = std::max(retval,KKEFF::weightChange(pweight_[idir],hit_->weight(),refparams.covariance()));
+    }
+    return retval;
   }
 
   template<class KTRAJ> void Measurement<KTRAJ>::updateState(MetaIterConfig const& miconfig,bool first) {
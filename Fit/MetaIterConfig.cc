@@ -3,6 +3,8 @@ namespace KinKal {
   std::ostream& operator <<(std::ostream& ost, MetaIterConfig const& miconfig ) {
       ost << "Meta-Iteration temp " << miconfig.temperature();
       ost << " with " << miconfig.nUpdaters() << " Dedicated Updaters";
+      if(miconfig.tcaPrecision() > 0.0) ost << " TCA precision " << miconfig.tcaPrecision();
+      ost << " TCA max iterations " << miconfig.tcaMaxIterations();
       return ost;
   }
 }
@@ -12,18 +12,26 @@
 namespace KinKal {
   class MetaIterConfig {
     public:
-      MetaIterConfig() : temp_(0.0) {}
-      MetaIterConfig(double temp) : temp_(temp) {}
+      MetaIterConfig() : temp_(0.0), tcaprec_(0.0), tcamaxiter_(100) {}
+      MetaIterConfig(double temp) : temp_(temp), tcaprec_(0.0), tcamaxiter_(100) {}
       // add updater
       void addUpdater(std::any const& updater) { updaters_.push_back(updater); }
+      // set the closest approach (TCA) calculation policy used by hits and xings when updating their reference in this meta-iteration.
+      // Early (high temperature) meta-iterations can use coarse solves.  A precision of 0 keeps the nominal precision of each hit or xing
+      void setTCAPolicy(double precision, unsigned maxiter) { tcaprec_ = precision; tcamaxiter_ = maxiter; }
       // accessors
       double temperature() const { return temp_; } // dimensionless parameter interpreted Additively, scaled by the relevant parameter error
       double varianceScale() const { return (1.0+temp_)*(1.0+temp_); } // variance scaling factor
       size_t nUpdaters() const { return updaters_.size(); }
+      double tcaPrecision() const { return tcaprec_; }
+      double tcaPrecision(double nominal) const { return tcaprec_ > 0.0 ? tcaprec_ : nominal; } // precision to use given the nominal value
+      unsigned tcaMaxIterations() const { return tcamaxiter_; }
       // find a particular updater: note that at most 1 of a type is allowed for a given meta-iteration
       template<class UPDATER> const UPDATER* findUpdater() const;
     private:
       double temp_; // 'temperature' to use in the simulated annealing (dimensionless, roughly equivalent to 'sigma')
+      double tcaprec_; // TCA precision (ns), or 0 to use the nominal precision
+      unsigned tcamaxiter_; // maximum number of TCA iterations
       // payload for effects needing special updating; specific Effect subclasses can find their particular updater inside the vector
       std::vector<std::any> updaters_;
   };
@@ -39,18 +39,24 @@
 #include "KinKal/Fit/FitState.hh"
 #include "KinKal/Fit/Effect.hh"
 #include "KinKal/Fit/Measurement.hh"
+#include "KinKal/Detector/ResidualHit.hh"
 #include "KinKal/Fit/Material.hh"
 #include "KinKal/Fit/BField.hh"
 #include "KinKal/Fit/Config.hh"
 #include "KinKal/Fit/Status.hh"
+#include "KinKal/Fit/FitProfile.hh"
 #include "KinKal/General/BFieldMap.hh"
 #include "KinKal/General/TimeDir.hh"
+#include "KinKal/General/BackgroundWorker.hh"
 #include "TMath.h"
 #include <set>
 #include <vector>
+#include <algorithm>
 #include <array>
 #include <iterator>
+#include <numeric>
 #include <memory>
+#include <exception>
 #include <cmath>
 #include <limits>
 #include <stdexcept>
@@ -60,24 +66,23 @@ namespace KinKal {
   template<class KTRAJ> class Track {
     public:
       using KKEFF = Effect<KTRAJ>;
+      using KKMEAS = Measurement<KTRAJ>;
+      using KKMAT = Material<KTRAJ>;
+      using KKBFIELD = BField<KTRAJ>;
       struct KKEFFComp { // comparator to sort effects by time
         bool operator()(std::unique_ptr<KKEFF> const& a, std::unique_ptr<KKEFF> const&  b) const {
-          if(a.get() != b.get())
-            return a->time() < b->time();
-          else
-            return false;
+          return a->time() < b->time();
         }
       };
       using KKEFFCOL = std::vector<std::unique_ptr<KKEFF>>; // container type for effects
-      using KKEFFFWD = typename std::vector<std::unique_ptr<KKEFF>>::iterator;
-      using KKEFFREV = typename std::vector<std::unique_ptr<KKEFF>>::reverse_iterator;
+      using KKEFFFWD = typename KKEFFCOL::iterator;
+      using KKEFFREV = typename KKEFFCOL::reverse_iterator;
       using KKEFFFWDBND = std::array<KKEFFFWD,2>;
       using KKEFFREVBND = std::array<KKEFFREV,2>;
-      using KKMEAS = Measurement<KTRAJ>;
-      using KKMAT = Material<KTRAJ>;
-      using KKBFIELD = BField<KTRAJ>;
       using PTRAJ = ParticleTrajectory<KTRAJ>;
       using PTRAJPTR = std::unique_ptr<PTRAJ>;
+      using PIECEBUFFER = PieceBuffer<KTRAJ>;
+      using PIECEBUFFERPTR = std::shared_ptr<PIECEBUFFER>;
       using HIT = Hit<KTRAJ>;
       using HITPTR = std::shared_ptr<HIT>;
       using HITCOL = std::vector<HITPTR>;
@@ -87,6 +92,7 @@ namespace KinKal {
       using DOMAINCOL = std::vector<TimeRange>;
       using CONFIGCOL = std::vector<Config>;
       using FitStateArray = std::array<FitState,2>;
+      using FITSTATECOL = std::vector<FitStateArray>;
       // construct from a set of hits and passive material crossings
       Track(Config const& config, BFieldMap const& bfield, PTRAJ const& seedtraj, HITCOL& hits, EXINGCOL& exings );
       // extend an existing track with either new configuration, new hits, and/or new material xings
@@ -94,15 +100,30 @@ namespace KinKal {
       // accessors
       std::vector<Status> const& history() const { return history_; }
       Status const& fitStatus() const { return history_.back(); } // most recent status
+      FitProfile const& profile() const { return profile_; } // where the fit time went; only recorded if built with KINKAL_PROFILE
       PTRAJ const& seedTraj() const { return seedtraj_; }
       PTRAJ const& fitTraj() const { return *fittraj_; }
       KKEFFCOL const& effects() const { return effects_; }
+      KKMEAS const* measurement(size_t ieff) const { return effmeas_[ieff]; } // the effect as a measurement, or null if it isn't one
       Config const& config() const { return config_.back(); }
       CONFIGCOL const& configs() const { return config_; }
       BFieldMap const& bfield() const { return bfield_; }
       HITCOL const& hits() const { return hits_; }
       EXINGCOL const& exings() const { return exings_; }
       DOMAINCOL const& domains() const { return domains_; }
+      // forward [0] and backward [1] fit states just before each effect was processed in the last iteration, indexed in parallel with effects().
+      // These are only kept if requested in the configuration (or for incremental fits); effects outside the fit range have empty states
+      FITSTATECOL const& effectStates() const { return effstates_; }
+      bool hasStates(size_t ieff) const;
+      // unbiased weights and parameters at a measurement effect, combining the adjacent forward and backward states.
+      // The weights require no matrix inversion (unless measurements update parameters directly), the parameters just 1.  These require cached states.
+      // The parameters throw std::runtime_error if the unbiased weight isn't positive-definite
+      Weights unbiasedWeights(size_t ieff) const;
+      Parameters unbiasedParameters(size_t ieff) const { return Parameters(unbiasedWeights(ieff)); }
+      // unbiased residual and pull of a measurement effect's hit, projected onto the unbiased parameters from the cached states.
+      // These throw std::invalid_argument if the effect isn't a measurement of a ResidualHit, and otherwise as the parameters
+      Residual unbiasedResidual(size_t ieff, unsigned ires) const;
+      double unbiasedPull(size_t ieff, unsigned ires) const { return unbiasedResidual(ieff,ires).pull(); }
       void print(std::ostream& ost=std::cout,int detail=0) const;
     protected:
       Track(Config const& cfg, BFieldMap const& bfield, PTRAJ const& seedtraj );
@@ -124,20 +145,37 @@ namespace KinKal {
       auto& status() { return history_.back(); } // most recent status
                                                  // divide a kinematic trajectory range into magnetic 'domains' within which the BField inhomogeneity effects are within tolerance
       void createDomains(PTRAJ const& ptraj, TimeRange const& range, std::vector<TimeRange>& ranges, TimeDir tdir=TimeDir::forwards) const;
+      // sort the effects by time, keeping the measurement index parallel.  Return true if they were reordered
+      bool sortEffects();
+      void findChanges(std::array<Weights,2> const& seedwts, size_t ibeg, size_t iend, size_t& ifirst, size_t& ilast) const;
+      // filter passes, these only touch their own direction's data so they can run concurrently
+      void forwardPass(FitState& state, size_t ibeg, size_t ifirst, size_t iend, bool cache);
+      void backwardPass(FitState& state, size_t ibeg, size_t ilast, size_t iend, bool cache, double& mintime, double& maxtime);
+      void clearCache() { effstates_.clear(); effchisq_.clear(); }
+      bool activeMeasurement(size_t ieff) const { auto const* kkmeas = effmeas_[ieff]; return kkmeas != 0 && kkmeas->active(); }
       // payload
       CONFIGCOL config_; // configuration
       BFieldMap const& bfield_; // magnetic field map
       std::vector<Status> history_; // fit status history; records the current iteration
+      mutable FitProfile profile_; // fit profile, in parallel with the history.  This is mutable so const functions can be profiled.  Empty without KINKAL_PROFILE
       PTRAJ seedtraj_; // seed for the fit
+      PIECEBUFFERPTR buffer_; // storage for the fit trajectory pieces, reused between iterations
       PTRAJPTR fittraj_; // result of the current fit
+      PTRAJPTR sparetraj_; // previous iteration result, recycled to build the next
       KKEFFCOL effects_; // effects used in this fit, sorted by time
+      std::vector<KKMEAS*> effmeas_; // measurement of each effect (null for other effects), in parallel with effects_.  This avoids RTTI in the iteration
       HITCOL hits_; // hits used in this fit
       EXINGCOL exings_; // material xings used in this fit
       DOMAINCOL domains_; // BField domains used in this fit
+      FITSTATECOL effstates_; // optional cache of the fit states at each effect from the last iteration
+      std::vector<Chisq> effchisq_; // chisquared increment of each effect, cached with the states
+      FitStateArray endstates_; // fit states at the end of each pass, cached with the states
+      std::array<size_t,2> cachebnds_; // index range of the effects processed when the states were cached
+      std::array<Weights,2> seedwts_; // seed information at each end included in the cached states
   };
   // sub-class constructor, based just on the seed.  It requires added hits to create a functional track
   template <class KTRAJ> Track<KTRAJ>::Track(Config const& cfg, BFieldMap const& bfield, PTRAJ const& seedtraj ) :
-    bfield_(bfield), seedtraj_(seedtraj)
+    bfield_(bfield), seedtraj_(seedtraj), buffer_(std::make_shared<PIECEBUFFER>()), cachebnds_{0,0}
   {
     config_.push_back(cfg);
     if(config().schedule().size() ==0)throw std::invalid_argument("Invalid configuration: no schedule");
@@ -214,13 +252,20 @@ namespace KinKal {
 
   // replace the traj with one describing the 'same' trajectory in space, but using the local BField as reference
   template <class KTRAJ> void Track<KTRAJ>::replaceTraj(DOMAINCOL const& domains) {
+    FitProfile::Timer timer(profile_,FitProfile::replaceTraj);
     // create new traj
-    auto newtraj = std::make_unique<PTRAJ>();
+    auto newtraj = std::make_unique<PTRAJ>(buffer_);
+    // find the BField at the start of each domain in 1 call
+    std::vector<VEC3> dpos, dfield(domains.size());
+    dpos.reserve(domains.size());
+    for(auto const& domain : domains) dpos.push_back(fittraj_->position3(domain.begin()));
+    bfield_.fieldVect(dpos.data(),dpos.size(),dfield.data());
     // loop over domains
-    for(auto const& domain : domains) {
+    for(size_t idom=0; idom < domains.size(); ++idom) {
+      auto const& domain = domains[idom];
       double dtime = domain.begin();
       // Set the BField to the start of this domain
-      auto bf = bfield_.fieldVect(fittraj_->position3(dtime));
+      auto const& bf = dfield[idom];
       // loop until we're either out of this domain or the piece is out of this domain
       while(dtime < domain.end()){
         // find the nearest piece of the current reftraj
@@ -237,10 +282,10 @@ namespace KinKal {
         dtime = newpiece.range().end()+epsilon; // to avoid boundary
       }
     }
-    // update existing effects to reference this trajectory
+    // update existing effects to reference this trajectory.  These are time-ordered, so use a cursor for the lookup
+    size_t hint(0);
     for (auto& eff : effects_) {
-      auto const& ltrajptr = newtraj->nearestTraj(eff->time());
-      eff->updateReference(ltrajptr);
+      eff->updateReference(newtraj->nearestTraj(eff->time(),hint));
     }
 
     // swap
@@ -263,10 +308,16 @@ namespace KinKal {
     if(config().bfcorr_ ) {
       if(fittraj_)throw std::invalid_argument("Initial reference trajectory must be empty");
       if(domains.size() == 0)throw std::invalid_argument("Empty domain collection");
-      fittraj_ = std::make_unique<PTRAJ>();
-      for(auto const& domain : domains) {
+      fittraj_ = std::make_unique<PTRAJ>(buffer_);
+      // find the BField at the start of each domain in 1 call
+      std::vector<VEC3> dpos, dfield(domains.size());
+      dpos.reserve(domains.size());
+      for(auto const& domain : domains) dpos.push_back(seedtraj.position3(domain.begin()));
+      bfield_.fieldVect(dpos.data(),dpos.size(),dfield.data());
+      for(size_t idom=0; idom < domains.size(); ++idom) {
+        auto const& domain = domains[idom];
         // Set the BField to the start of this domain
-        auto bf = bfield_.fieldVect(seedtraj.position3(domain.begin()));
+        auto const& bf = dfield[idom];
         KTRAJ newpiece(seedtraj.nearestPiece(domain.begin()),bf,domain.begin());
         newpiece.range() = domain;
         fittraj_->append(newpiece);
@@ -279,23 +330,27 @@ namespace KinKal {
       KTRAJ firstpiece(seedtraj.nearestPiece(tref),bf,tref);
       firstpiece.range() = range;
       // create the piecewise trajectory from this
-      fittraj_ = std::make_unique<PTRAJ>(firstpiece);
+      fittraj_ = std::make_unique<PTRAJ>(firstpiece,buffer_);
     }
   }
 
   template <class KTRAJ> void Track<KTRAJ>::createEffects( HITCOL& hits, EXINGCOL& exings,DOMAINCOL const& domains ) {
     // pre-allocate as needed
     effects_.reserve(effects_.size()+hits.size()+exings.size()+domains.size());
+    effmeas_.reserve(effects_.capacity());
     // append the effects.  First, loop over the hits
     for(auto& hit : hits ) {
       // create the hit effects and insert them in the collection
-      effects_.emplace_back(std::make_unique<KKMEAS>(hit));
+      auto kkmeas = std::make_unique<KKMEAS>(hit,config());
+      effmeas_.push_back(kkmeas.get());
+      effects_.emplace_back(std::move(kkmeas));
       // update hit reference; this should be done on construction FIXME
       hit->updateReference(fittraj_->nearestTraj(hit->time()));
     }
     //add material effects
     for(auto& exing : exings) {
-      effects_.emplace_back(std::make_unique<KKMAT>(exing,*fittraj_));
+      effects_.emplace_back(std::make_unique<KKMAT>(exing,*fittraj_,config()));
+      effmeas_.push_back(0);
       // update xing reference; should be done on construction FIXME
       exing->updateReference(fittraj_->nearestTraj(exing->time()));
     }
@@ -303,9 +358,10 @@ namespace KinKal {
     for( auto const& domain : domains) {
       // create the BField effect for integrated differences over this range
       effects_.emplace_back(std::make_unique<KKBFIELD>(config(),bfield_,domain));
+      effmeas_.push_back(0);
     }
     // sort
-    std::sort(effects_.begin(),effects_.end(),KKEFFComp ());
+    sortEffects();
     // store the inputs; these are just for convenience
     hits_.insert(hits_.end(),hits.begin(),hits.end());
     exings_.insert(exings_.end(),exings.begin(),exings.end());
@@ -322,6 +378,7 @@ namespace KinKal {
       unsigned niter(0);
       do{
         history_.push_back(Status(nmeta,niter++));
+        profile_.beginIteration(fitStatus().miter_,fitStatus().iter_);
         // catch exceptions and record them in the status
         try {
           iterate(miconfig);
@@ -332,6 +389,7 @@ namespace KinKal {
       } while(canIterate());
       if(!status().usable())break;
     }
+    profile_.endIteration();
     // if the fit is usable, process the passive effects on either end
     if(config().ends_ && status().usable()) processEnds();
     if(config().plevel_ > Config::none)print(std::cout, config().plevel_);
@@ -342,17 +400,22 @@ namespace KinKal {
     if(config().plevel_ >= Config::basic)std::cout << "Processing fit iteration " << fitStatus().iter_ << std::endl;
     // update the effects for this configuration; this will sort the effects and find the iteration bounds
     bool first = status().iter_ == 0; // 1st iteration of a meta-iteration: update the effect internals
-    for(auto& ieff : effects_ ) ieff->updateState(miconfig,first);
-    // sort the sites, and set the iteration bounds
-    std::sort(effects_.begin(),effects_.end(),KKEFFComp ());
+    {
+      FitProfile::Timer timer(profile_,FitProfile::updateState);
+      for(auto& ieff : effects_ ) ieff->updateState(miconfig,first);
+    }
+    // sort the sites, and set the iteration bounds.  Reordering invalidates any cached states
+    if(sortEffects() || !config().incremental_)clearCache();
     KKEFFFWDBND fwdbnds;
     KKEFFREVBND revbnds;
     setBounds(fwdbnds,revbnds );
+    // index range of the effects processed in this iteration
+    size_t ibeg = std::distance(effects_.begin(),fwdbnds[0]);
+    size_t iend = std::distance(effects_.begin(),fwdbnds[1]);
     int ndof(0); ndof -= NParams();
-    for(auto feff=fwdbnds[0];feff!=fwdbnds[1];++feff){
-      auto const* kkmeas = dynamic_cast<const KKMEAS*>(feff->get());
+    for(size_t ieff=ibeg; ieff < iend; ++ieff){
 //      if(kkmeas && kkmeas->active())ndof += kkmeas->hit()->nDOF();
-      if(kkmeas && kkmeas->active())ndof++; // this is more conservative than the above, but still not a complete test, since some measurements
+      if(activeMeasurement(ieff))ndof++; // this is more conservative than the above, but still not a complete test, since some measurements
       // have redundant DOFs.FIXME
     }
     if(ndof >= (int)config().minndof_) {
@@ -360,26 +423,41 @@ namespace KinKal {
       // To be consistent with hit errors I should scale by the ratio of current to previous temperature.  Or maybe skip this?? FIXME
       FitStateArray states;
       initFitState(states, config().dwt_/miconfig.varianceScale());
-      // loop over relevant effects, adding their info to the fit state.  Also compute chisquared
-      for(auto feff=fwdbnds[0];feff!=fwdbnds[1];++feff){
-        auto effptr = feff->get();
-        // update chisquared increment WRT the current state: only needed once
-        Chisq dchisq = effptr->chisq(states[0].pData());
-        status().chisq_ += dchisq;
-        // process
-        effptr->process(states[0],TimeDir::forwards);
-        if(config().plevel_ >= Config::detailed && dchisq.nDOF() > 0){
-          std::cout << "Chisq increment " << dchisq << " ";
-          effptr->print(std::cout,config().plevel_-Config::detailed);
-        }
+      // the forward pass reprocesses effects [ifirst,iend), the backward pass [ibeg,ilast).  For an incremental fit these are bounded by
+      // the first and last changed effects: the cached states outside those spans are reused
+      size_t ifirst(ibeg), ilast(iend);
+      std::array<Weights,2> seedwts = {states[0].wData(),states[1].wData()};
+      if(config().incremental_ && effstates_.size() == effects_.size() && cachebnds_[0] == ibeg && cachebnds_[1] == iend)
+        findChanges(seedwts,ibeg,iend,ifirst,ilast);
+      bool cache = config().cachestates_ || config().incremental_;
+      if(cache){
+        effstates_.resize(effects_.size());
+        effchisq_.resize(effects_.size());
+        cachebnds_ = {ibeg,iend};
+        // the cached states only include the current seed if the pass restarted from it.  Otherwise they keep the older seed,
+        // against which the next change must be measured, so sub-tolerance changes can't accumulate
+        if(ifirst == ibeg) seedwts_[0] = seedwts[0];
+        if(ilast == iend) seedwts_[1] = seedwts[1];
       }
       double mintime(std::numeric_limits<double>::max());
       double maxtime(-std::numeric_limits<float>::max());
-      for(auto beff = revbnds[0]; beff!=revbnds[1]; ++beff){
-        auto effptr = beff->get();
-        effptr->process(states[1],TimeDir::backwards);
-        mintime = std::min(mintime,effptr->time());
-        maxtime = std::max(maxtime,effptr->time());
+      // the forward and backward passes are independent: for long tracks process them concurrently, running the backward pass
+      // on the persistent helper thread of the calling thread, so no thread is created per iteration
+      if(config().minparallel_ > 0 && iend-ibeg >= config().minparallel_){
+        auto backward = [&](){ backwardPass(states[1],ibeg,ilast,iend,cache,mintime,maxtime); };
+        auto& worker = BackgroundWorker::threadLocal();
+        worker.submit(backward);
+        try {
+          forwardPass(states[0],ibeg,ifirst,iend,cache);
+        } catch (...) {
+          // the backward pass references this frame: let it finish before propagating the error
+          try { worker.wait(); } catch (...) {}
+          throw;
+        }
+        worker.wait();
+      } else {
+        forwardPass(states[0],ibeg,ifirst,iend,cache);
+        backwardPass(states[1],ibeg,ilast,iend,cache,mintime,maxtime);
       }
       // convert the fit result into a new trajectory
       // initialize the parameters to the backward processing end
@@ -390,29 +468,124 @@ namespace KinKal {
 //          std::max(fittraj_->range().end(),revbnds[0]->get()->time()));
       TimeRange maxrange(mintime-0.1,maxtime+0.1); // FIXME
       front.setRange(maxrange);
-      auto ptraj = std::make_unique<PTRAJ>(front);
+      // rebuild into the spare trajectory: this reuses the storage of the previous iterations
+      if(!sparetraj_) sparetraj_ = std::make_unique<PTRAJ>(buffer_);
+      auto& ptraj = sparetraj_;
+      ptraj->clear();
+      ptraj->append(front);
       // process forwards, adding pieces as necessary.  This also sets the effects to reference the new trajectory
-      for(auto& ieff=fwdbnds[0]; ieff != fwdbnds[1]; ++ieff) {
-        ieff->get()->append(*ptraj,TimeDir::forwards);
+      {
+        FitProfile::Timer timer(profile_,FitProfile::append);
+        for(auto& ieff=fwdbnds[0]; ieff != fwdbnds[1]; ++ieff) {
+          ieff->get()->append(*ptraj,TimeDir::forwards);
+        }
       }
       setStatus(ptraj); // set the status for this iteration
       // prepare for the next iteration: first, update the references for effects outside the fit range
       // (the ones inside the range were updated above in 'append')
       if(status().usable()){
+        // effects are time-ordered, so use a cursor for the piece lookup
+        size_t hint = ptraj->pieces().size()-1;
         for(auto feff=fwdbnds[1]; feff != effects_.end(); ++feff)
-          feff->get()->updateReference(ptraj->nearestTraj(feff->get()->time()));
+          feff->get()->updateReference(ptraj->nearestTraj(feff->get()->time(),hint));
+        hint = 0;
         for(auto beff=revbnds[1]; beff != effects_.rend(); ++beff)
-          beff->get()->updateReference(ptraj->nearestTraj(beff->get()->time()));
+          beff->get()->updateReference(ptraj->nearestTraj(beff->get()->time(),hint));
       }
-      // now all effects reference the new traj: we can swap it with the old
+      // now all effects reference the new traj: we can swap it with the old, which becomes the spare
       fittraj_.swap(ptraj);
       if(config().plevel_ >= Config::complete)fittraj_->print(std::cout,1);
     } else {
+      clearCache();
       status().chisq_ = Chisq(-1.0,ndof);
       status().status_ = Status::lowNDOF;
     }
   }
 
+  // forward filter pass over effects [ibeg,iend), processing from ifirst and reusing the cached states before that.  Also compute chisquared
+  template <class KTRAJ> void Track<KTRAJ>::forwardPass(FitState& state, size_t ibeg, size_t ifirst, size_t iend, bool cache) {
+    FitProfile::Timer timer(profile_,FitProfile::forwardProcess);
+    if(ifirst > ibeg){
+      state = ifirst < iend ? effstates_[ifirst][0] : endstates_[0];
+      for(size_t ieff=ibeg; ieff < ifirst; ++ieff){
+        status().chisq_ += effchisq_[ieff];
+        effects_[ieff]->reuse(TimeDir::forwards);
+      }
+    }
+    // loop over the remaining effects, adding their info to the fit state
+    for(size_t ieff=ifirst; ieff < iend; ++ieff){
+      // measurements are processed in weight space unless they can update parameters directly, so converting the state before caching costs no extra inversion
+      if(cache && activeMeasurement(ieff) && !(config().paramupdate_ && state.hasParameters()))state.wData();
+      auto effptr = effects_[ieff].get();
+      // update chisquared increment WRT the current state: only needed once
+      Chisq dchisq = effptr->chisq(state.pData());
+      status().chisq_ += dchisq;
+      if(cache){
+        effstates_[ieff][0] = state;
+        effchisq_[ieff] = dchisq;
+      }
+      // process
+      effptr->process(state,TimeDir::forwards);
+      if(config().plevel_ >= Config::detailed && dchisq.nDOF() > 0){
+        std::cout << "Chisq increment " << dchisq << " ";
+        effptr->print(std::cout,config().plevel_-Config::detailed);
+      }
+    }
+    if(cache)endstates_[0] = state;
+  }
+
+  // backward filter pass over effects [ibeg,iend), processing from ilast and reusing the cached states after that.  Also find the time range
+  template <class KTRAJ> void Track<KTRAJ>::backwardPass(FitState& state, size_t ibeg, size_t ilast, size_t iend, bool cache, double& mintime, double& maxtime) {
+    FitProfile::Timer timer(profile_,FitProfile::backwardProcess);
+    if(ilast < iend){
+      state = ilast > ibeg ? effstates_[ilast-1][1] : endstates_[1];
+      for(size_t ieff=ilast; ieff < iend; ++ieff){
+        mintime = std::min(mintime,effects_[ieff]->time());
+        maxtime = std::max(maxtime,effects_[ieff]->time());
+        effects_[ieff]->reuse(TimeDir::backwards);
+      }
+    }
+    for(size_t ieff=ilast; ieff > ibeg; --ieff){
+      auto effptr = effects_[ieff-1].get();
+      if(cache){
+        if(activeMeasurement(ieff-1) && !(config().paramupdate_ && state.hasParameters()))state.wData();
+        effstates_[ieff-1][1] = state;
+      }
+      effptr->process(state,TimeDir::backwards);
+      mintime = std::min(mintime,effptr->time());
+      maxtime = std::max(maxtime,effptr->time());
+    }
+    if(cache)endstates_[1] = state;
+  }
+
+  // find the span of effects whose contribution changed significantly since they were last processed
+  template <class KTRAJ> void Track<KTRAJ>::findChanges(std::array<Weights,2> const& seedwts, size_t ibeg, size_t iend, size_t& ifirst, size_t& ilast) const {
+    // measure the changes against the current fit, which has the full information at each effect
+    size_t hint(0);
+    auto changed = [this,&hint](std::unique_ptr<KKEFF> const& eff) {
+      return eff->change(fittraj_->nearestPiece(eff->time(),hint).params()) > config().inctol_;
+    };
+    // the cached states also include the seed, which is rebuilt from the ends of the current fit.  If it changed significantly,
+    // the pass starting from that end can't reuse any state
+    bool fwdseed = KKEFF::weightChange(seedwts_[0],seedwts[0],fittraj_->front().params().covariance()) > config().inctol_;
+    bool revseed = KKEFF::weightChange(seedwts_[1],seedwts[1],fittraj_->back().params().covariance()) > config().inctol_;
+    ifirst = fwdseed ? ibeg : iend;
+    ilast = revseed ? iend : ibeg;
+    for(size_t ieff=ibeg; ieff < ifirst; ++ieff){
+      if(changed(effects_[ieff])){
+        ifirst = ieff;
+        break;
+      }
+    }
+    hint = fittraj_->pieces().size()-1;
+    for(size_t ieff=iend; ieff > std::max(ifirst,ilast); --ieff){
+      if(changed(effects_[ieff-1])){
+        ilast = ieff;
+        break;
+      }
+    }
+  }
+
   // initialize statess used before iteration
   template <class KTRAJ> void Track<KTRAJ>::initFitState(FitStateArray& states, double dwt) {
     auto fwdtraj = fittraj_->front();
@@ -428,20 +601,21 @@ namespace KinKal {
 
   // finalize after iteration
   template <class KTRAJ> void Track<KTRAJ>::setStatus(PTRAJPTR& ptraj) {
+    FitProfile::Timer timer(profile_,FitProfile::setStatus);
     // to test for compute parameter difference WRT previous iteration.  Compare at front and back ends
     // to test for compute parameter difference WRT previous iteration.  Compare at front and back ends
     auto const& ffront = ptraj->front();
     auto const& sfront = fittraj_->nearestPiece(ffront.range().mid());
     DVEC dpfront = ffront.params().parameters() - sfront.params().parameters();
     DMAT frontwt = sfront.params().covariance();
-    if(! frontwt.Invert())throw std::runtime_error("Reference covariance uninvertible");
+    if(! invertSPD(frontwt))throw std::runtime_error("Reference covariance uninvertible");
     double dpchisqfront = ROOT::Math::Similarity(dpfront,frontwt);
     // back
     auto const& fback = ptraj->back();
     auto const& sback = fittraj_->nearestPiece(fback.range().mid());
     DVEC dpback = fback.params().parameters() - sback.params().parameters();
     DMAT backwt = sback.params().covariance();
-    if(! backwt.Invert())throw std::runtime_error("Reference covariance uninvertible");
+    if(! invertSPD(backwt))throw std::runtime_error("Reference covariance uninvertible");
     double dpchisqback = ROOT::Math::Similarity(dpback,backwt);
     // fit chisquared chang3
     double dchisq = config().convdchisq_ + 1e-4;  // initialize to insure 0th iteration doesn't converge
@@ -472,24 +646,41 @@ namespace KinKal {
   // update between iterations
   template <class KTRAJ> void Track<KTRAJ>::setBounds(KKEFFFWDBND& fwdbnds, KKEFFREVBND& revbnds) {
 // find bounds between first and last measurement
-    for(auto ieff=effects_.begin();ieff!=effects_.end();++ieff){
-      auto const* kkmeas = dynamic_cast<const KKMEAS*>(ieff->get());
-      if(kkmeas != 0 && kkmeas->active()){
-        fwdbnds[0] = ieff;
-        revbnds[1] = KKEFFREV(ieff);
+    for(size_t ieff=0; ieff < effects_.size(); ++ieff){
+      if(activeMeasurement(ieff)){
+        fwdbnds[0] = effects_.begin() + ieff;
+        revbnds[1] = KKEFFREV(fwdbnds[0]);
         break;
       }
     }
-    for(auto ieff=effects_.rbegin();ieff!=effects_.rend();++ieff){
-      auto const* kkmeas = dynamic_cast<const KKMEAS*>(ieff->get());
-      if(kkmeas != 0 && kkmeas->active()){
-        revbnds[0] = ieff;
-        fwdbnds[1] = ieff.base();
+    for(size_t ieff=effects_.size(); ieff > 0; --ieff){
+      if(activeMeasurement(ieff-1)){
+        fwdbnds[1] = effects_.begin() + ieff;
+        revbnds[0] = KKEFFREV(fwdbnds[1]);
         break;
       }
     }
   }
 
+  template <class KTRAJ> bool Track<KTRAJ>::sortEffects() {
+    if(std::is_sorted(effects_.begin(),effects_.end(),KKEFFComp())) return false;
+    // sort a permutation and apply it to both the effects and the measurement index
+    std::vector<size_t> order(effects_.size());
+    std::iota(order.begin(),order.end(),0);
+    std::sort(order.begin(),order.end(),[this](size_t i, size_t j){ return effects_[i]->time() < effects_[j]->time(); });
+    KKEFFCOL effects;
+    std::vector<KKMEAS*> effmeas;
+    effects.reserve(effects_.capacity());
+    effmeas.reserve(effects_.capacity());
+    for(auto ieff : order){
+      effects.push_back(std::move(effects_[ieff]));
+      effmeas.push_back(effmeas_[ieff]);
+    }
+    effects_.swap(effects);
+    effmeas_.swap(effmeas);
+    return true;
+  }
+
   template <class KTRAJ> void Track<KTRAJ>::processEnds() {
     // sort the end sites
     KKEFFFWDBND fwdbnds; // bounds for iterating
@@ -497,10 +688,11 @@ namespace KinKal {
     setBounds(fwdbnds,revbnds);
     // update the end effects: this makes their internal content consistent with the others
     // use the final meta-iteration
+    auto const& miconfig = config().schedule().back();
     for(auto feff=fwdbnds[1]; feff != effects_.end(); ++feff)
-      feff->get()->updateState(config().schedule().back(),false);
+      feff->get()->updateState(miconfig,false);
     for(auto reff=revbnds[1]; reff != effects_.rend(); ++reff)
-      reff->get()->updateState(config().schedule().back(),false);
+      reff->get()->updateState(miconfig,false);
     // then process these sites.  Start with the state at the apropriate end, but without any deweighting
     FitStateArray states;
     initFitState(states, 1.0); // no deweighting
@@ -516,6 +708,33 @@ namespace KinKal {
       if(reff->get()->time() < fittraj_->front().range().rbegin())reff->get()->append(*fittraj_,TimeDir::backwards);
   }
 
+  template<class KTRAJ> bool Track<KTRAJ>::hasStates(size_t ieff) const {
+    if(ieff >= effstates_.size()) return false;
+    // effects outside the fit range are not processed in the iteration, so their states are empty
+    for(auto const& state : effstates_[ieff])
+      if(!(state.hasWeights() || state.hasParameters()))return false;
+    return true;
+  }
+
+  template<class KTRAJ> Weights Track<KTRAJ>::unbiasedWeights(size_t ieff) const {
+    if(!hasStates(ieff))throw std::invalid_argument("No cached fit states for this effect");
+    // copy, as the conversion is lazy.  States cached at active measurements already have their weights
+    auto states = effstates_[ieff];
+    // the forward state excludes this effect and everything after it, the backward state this effect and everything before it,
+    // so their sum is the information of all the other effects.  Note the (deweighted) seed information is counted twice
+    Weights retval = states[0].wData();
+    retval += states[1].wData();
+    return retval;
+  }
+
+  template<class KTRAJ> Residual Track<KTRAJ>::unbiasedResidual(size_t ieff, unsigned ires) const {
+    auto const* kkmeas = measurement(ieff);
+    if(kkmeas == 0)throw std::invalid_argument("Effect is not a measurement");
+    auto const* rhit = dynamic_cast<ResidualHit<KTRAJ> const*>(kkmeas->hit().get());
+    if(rhit == 0)throw std::invalid_argument("Measurement hit has no residuals");
+    return rhit->residual(unbiasedParameters(ieff),ires);
+  }
+
   template<class KTRAJ> bool Track<KTRAJ>::canIterate() const {
     return fitStatus().needsFit() && fitStatus().iter_ < config().maxniter_;
   }
@@ -542,6 +761,7 @@ namespace KinKal {
   // divide a trajectory into magnetic 'domains' used to apply the BField corrections
   template<class KTRAJ> void Track<KTRAJ>::createDomains(PTRAJ const& ptraj, TimeRange const& range, std::vector<TimeRange>& ranges,
       TimeDir tdir) const {
+    FitProfile::Timer timer(profile_,FitProfile::createDomains);
     double tstart;
     tstart = range.begin();
     do {
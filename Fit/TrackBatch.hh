@@ -0,0 +1,59 @@
+#ifndef KinKal_TrackBatch_hh
+#define KinKal_TrackBatch_hh
+//
+//  Fit a batch of independent tracks concurrently.  Each input is a seed trajectory plus the hits and material
+//  crossings specific to that track.  All the fits share a single (immutable) configuration and BField map.
+//  The fits are distributed over a work-stealing thread pool, and the results are returned in input order.
+//  Hits and material crossings must not be shared between inputs, as the fit updates their internal state.
+//
+#include "KinKal/Fit/Track.hh"
+#include "KinKal/Fit/Config.hh"
+#include "KinKal/General/BFieldMap.hh"
+#include "KinKal/General/WorkStealingPool.hh"
+#include <vector>
+#include <memory>
+
+namespace KinKal {
+  template<class KTRAJ> class TrackBatch {
+    public:
+      using KKTRK = Track<KTRAJ>;
+      using KKTRKPTR = std::unique_ptr<KKTRK>;
+      using KKTRKCOL = std::vector<KKTRKPTR>;
+      using PTRAJ = typename KKTRK::PTRAJ;
+      using HITCOL = typename KKTRK::HITCOL;
+      using EXINGCOL = typename KKTRK::EXINGCOL;
+      struct Input {
+        Input(PTRAJ const& seedtraj, HITCOL const& hits, EXINGCOL const& exings) : seedtraj_(seedtraj), hits_(hits), exings_(exings) {}
+        PTRAJ seedtraj_; // seed for this fit
+        HITCOL hits_; // hits for this fit
+        EXINGCOL exings_; // material xings for this fit
+      };
+      using INPUTCOL = std::vector<Input>;
+      // construct from the shared configuration and BField.  These must outlive the batch and the tracks it creates
+      // nthreads=0 means use the hardware concurrency
+      TrackBatch(Config const& config, BFieldMap const& bfield, unsigned nthreads=0) : config_(config), bfield_(bfield), pool_(nthreads) {
+        if(config_.schedule().size() ==0)throw std::invalid_argument("Invalid configuration: no schedule");
+      }
+      // fit all the inputs.  The result has the same order as the input
+      KKTRKCOL fit(INPUTCOL& inputs) const;
+      // accessors
+      Config const& config() const { return config_; }
+      BFieldMap const& bfield() const { return bfield_; }
+      unsigned nThreads() const { return pool_.nThreads(); }
+    private:
+      Config config_; // configuration shared by all fits
+      BFieldMap const& bfield_; // magnetic field map shared by all fits
+      WorkStealingPool pool_; // thread pool
+  };
+
+  template <class KTRAJ> typename TrackBatch<KTRAJ>::KKTRKCOL TrackBatch<KTRAJ>::fit(INPUTCOL& inputs) const {
+    KKTRKCOL tracks(inputs.size());
+    // each task writes only its own slot, so no synchronization is needed on the output
+    pool_.process(inputs.size(),[&](size_t itrk, unsigned iworker) {
+      auto& input = inputs[itrk];
+      tracks[itrk] = std::make_unique<KKTRK>(config_,bfield_,input.seedtraj_,input.hits_,input.exings_);
+    });
+    return tracks;
+  }
+}
+#endif
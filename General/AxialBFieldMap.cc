@@ -1,5 +1,6 @@
 //
 #include "KinKal/General/AxialBFieldMap.hh"
+#include "KinKal/General/BFieldMapImage.hh"
 #include <cmath>
 #include <fstream>
 namespace KinKal {
@@ -9,7 +10,18 @@ namespace KinKal {
   }
 
   AxialBFieldMap::AxialBFieldMap(std::string const& file) {
-    // read the file
+    // images are small for axial maps, so just copy the values
+    if(BFieldMapImage::isImage(file)){
+      BFieldMapImage image(file);
+      if(image.type() != BFieldMapImage::axial)throw std::invalid_argument("BField image isn't axial");
+      auto field = static_cast<double const*>(image.data());
+      axial_.assign(field,field+image.nZ());
+      zmin_ = image.z0();
+      zstep_ = image.dz();
+      zmax_ = zmin_ + zstep_*(axial_.size()-1);
+      return;
+    }
+    // read the text file
     std::ifstream spectrum_stream(file);
     if ( (spectrum_stream.rdstate() & std::ifstream::failbit ) != 0 ){
       std::string errmsg = std::string("can't open Axial field file ") + file;
@@ -89,4 +101,17 @@ namespace KinKal {
     return axial_[index];
   }
 
+  // batch functions: qualified calls to the single-point functions are resolved statically, so they can be inlined
+  void AxialBFieldMap::fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const {
+    for(size_t ipt=0; ipt < n; ++ipt) fields[ipt] = AxialBFieldMap::fieldVect(positions[ipt]);
+  }
+
+  void AxialBFieldMap::fieldGrad(VEC3 const* positions, size_t n, Grad* grads) const {
+    for(size_t ipt=0; ipt < n; ++ipt) grads[ipt] = AxialBFieldMap::fieldGrad(positions[ipt]);
+  }
+
+  void AxialBFieldMap::fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const {
+    for(size_t ipt=0; ipt < n; ++ipt) derivs[ipt] = AxialBFieldMap::fieldDeriv(positions[ipt],velocities[ipt]);
+  }
+
 }
@@ -8,11 +8,14 @@
 namespace KinKal {
   class AxialBFieldMap : public BFieldMap {
     public:
-      AxialBFieldMap(std::string const& file); // read from a file of Z positions and field values; must be evenly spaced
+      AxialBFieldMap(std::string const& file); // read from a file of Z positions and field values (must be evenly spaced), or a BFieldMapImage
       AxialBFieldMap(double zmin, double zmax, std::vector<double> const& field); // field values are assumed to be evenly spaced
       VEC3 fieldVect(VEC3 const& position) const override;
       Grad fieldGrad(VEC3 const& position) const override;
       VEC3 fieldDeriv(VEC3 const& position, VEC3 const& velocity) const override;
+      void fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const override;
+      void fieldGrad(VEC3 const* positions, size_t n, Grad* grads) const override;
+      void fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const override;
       bool inRange(VEC3 const& position) const override { return position.Z() > zmin_ && position.Z() < zmax_; }
       double zMin() const { return zmin_; }
       double zMax() const { return zmax_; }
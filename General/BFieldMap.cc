@@ -2,6 +2,18 @@
 
 namespace KinKal {
 
+   void BFieldMap::fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const {
+     for(size_t ipt=0; ipt < n; ++ipt) fields[ipt] = fieldVect(positions[ipt]);
+   }
+
+   void BFieldMap::fieldGrad(VEC3 const* positions, size_t n, Grad* grads) const {
+     for(size_t ipt=0; ipt < n; ++ipt) grads[ipt] = fieldGrad(positions[ipt]);
+   }
+
+   void BFieldMap::fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const {
+     for(size_t ipt=0; ipt < n; ++ipt) derivs[ipt] = fieldDeriv(positions[ipt],velocities[ipt]);
+   }
+
    VEC3 CompositeBFieldMap::fieldVect(VEC3 const&position) const  {
      VEC3 fvec;
      for(auto const field : fields_ ){
@@ -26,6 +38,43 @@ namespace KinKal {
      return dBdt;
    }
 
+   // the batch functions make 1 call per constituent for each block of points, summing through a fixed-size buffer
+   void CompositeBFieldMap::fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const {
+     std::fill(fields,fields+n,VEC3());
+     VEC3 fblock[blocksize_];
+     for(size_t ioff=0; ioff < n; ioff += blocksize_){
+       size_t nblock = std::min(blocksize_,n-ioff);
+       for(auto const field : fields_ ){
+         field->fieldVect(positions+ioff,nblock,fblock);
+         for(size_t ipt=0; ipt < nblock; ++ipt) fields[ioff+ipt] += fblock[ipt];
+       }
+     }
+   }
+
+   void CompositeBFieldMap::fieldGrad(VEC3 const* positions, size_t n, Grad* grads) const {
+     std::fill(grads,grads+n,Grad());
+     Grad gblock[blocksize_];
+     for(size_t ioff=0; ioff < n; ioff += blocksize_){
+       size_t nblock = std::min(blocksize_,n-ioff);
+       for(auto const field : fields_ ){
+         field->fieldGrad(positions+ioff,nblock,gblock);
+         for(size_t ipt=0; ipt < nblock; ++ipt) grads[ioff+ipt] += gblock[ipt];
+       }
+     }
+   }
+
+   void CompositeBFieldMap::fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const {
+     std::fill(derivs,derivs+n,VEC3());
+     VEC3 dblock[blocksize_];
+     for(size_t ioff=0; ioff < n; ioff += blocksize_){
+       size_t nblock = std::min(blocksize_,n-ioff);
+       for(auto const field : fields_ ){
+         field->fieldDeriv(positions+ioff,velocities+ioff,nblock,dblock);
+         for(size_t ipt=0; ipt < nblock; ++ipt) derivs[ioff+ipt] += dblock[ipt];
+       }
+     }
+   }
+
    bool CompositeBFieldMap::inRange(VEC3 const& position) const {
      bool retval(true);
      for(auto const field : fields_ ){
@@ -56,4 +105,16 @@ namespace KinKal {
      return VEC3(-0.5*grad_*velocity.X(),-0.5*grad_*velocity.Y(),grad_*velocity.Z());
    }
 
+   void GradientBFieldMap::fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const {
+     double hgrad = -0.5*grad_;
+     for(size_t ipt=0; ipt < n; ++ipt)
+       fields[ipt].SetXYZ(hgrad*positions[ipt].X(), hgrad*positions[ipt].Y(), b0_ + grad_*(positions[ipt].Z()-z0_));
+   }
+
+   void GradientBFieldMap::fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const {
+     double hgrad = -0.5*grad_;
+     for(size_t ipt=0; ipt < n; ++ipt)
+       derivs[ipt].SetXYZ(hgrad*velocities[ipt].X(), hgrad*velocities[ipt].Y(), grad_*velocities[ipt].Z());
+   }
+
 }
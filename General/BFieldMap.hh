@@ -7,6 +7,7 @@
 #include "KinKal/General/PhysicalConstants.h"
 #include "Math/SMatrix.h"
 #include <vector>
+#include <array>
 #include <limits>
 #include <algorithm>
 #include <cstdarg>
@@ -25,6 +26,11 @@ namespace KinKal {
       virtual VEC3 fieldDeriv(VEC3 const& position, VEC3 const& velocity) const = 0;
       // is the point inside the range of this map?
       virtual bool inRange(VEC3 const& position) const = 0;
+      // batch versions of the above for n points, filling the output arrays.  The defaults loop over the single-point
+      // functions; subclasses override these to avoid the per-point virtual call and share work between points
+      virtual void fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const;
+      virtual void fieldGrad(VEC3 const* positions, size_t n, Grad* grads) const;
+      virtual void fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const;
       virtual ~BFieldMap(){}
       virtual void print(std::ostream& os ) const = 0;
       BFieldMap(){}
@@ -42,14 +48,19 @@ namespace KinKal {
 
   template<class KTRAJ> VEC3 BFieldMap::integrate(KTRAJ const& ktraj, TimeRange const& trange) const {
     // take a fixed number of steps.  This may fail for long ranges FIXME!
-    unsigned nsteps(10);
+    static constexpr unsigned nsteps(10);
     double dt = trange.range()/nsteps;
+    // evaluate the field at all the steps in 1 call
+    std::array<VEC3,nsteps> positions, fields;
+    for(unsigned istep=0; istep< nsteps; istep++)
+      positions[istep] = ktraj.position3(trange.begin() + (0.5+istep)*dt);
+    fieldVect(positions.data(),nsteps,fields.data());
     // now integrate
     VEC3 dmom;
     for(unsigned istep=0; istep< nsteps; istep++){
       double tstep = trange.begin() + (0.5+istep)*dt;
       VEC3 vel = ktraj.velocity(tstep);
-      VEC3 db = fieldVect(ktraj.position3(tstep)) - ktraj.bnom(tstep);
+      VEC3 db = fields[istep] - ktraj.bnom(tstep);
       dmom += cbar()*ktraj.charge()*dt*vel.Cross(db);
     }
     return dmom;
@@ -75,6 +86,9 @@ namespace KinKal {
       VEC3 fieldVect(VEC3 const& position) const override { return fvec_; }
       Grad fieldGrad(VEC3 const& position) const override { return Grad(); }
       VEC3 fieldDeriv(VEC3 const& position, VEC3 const& velocity) const override { return VEC3(); }
+      void fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const override { std::fill(fields,fields+n,fvec_); }
+      void fieldGrad(VEC3 const* positions, size_t n, Grad* grads) const override { std::fill(grads,grads+n,Grad()); }
+      void fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const override { std::fill(derivs,derivs+n,VEC3()); }
       void print(std::ostream& os =std::cout) const override { os << "Uniform BField, B = " << fvec_ << std::endl; }
       UniformBFieldMap(VEC3 const& bnom) : fvec_(bnom) {}
       UniformBFieldMap(double BZ) : UniformBFieldMap(VEC3(0.0,0.0,BZ)) {}
@@ -94,6 +108,9 @@ namespace KinKal {
       VEC3 fieldVect(VEC3 const& position) const override;
       Grad fieldGrad(VEC3 const& position) const override;
       VEC3 fieldDeriv(VEC3 const& position, VEC3 const& velocity) const override;
+      void fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const override;
+      void fieldGrad(VEC3 const* positions, size_t n, Grad* grads) const override;
+      void fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const override;
       void print(std::ostream& os =std::cout) const override;
       bool inRange(VEC3 const& position) const override;
       CompositeBFieldMap () {}
@@ -105,6 +122,7 @@ namespace KinKal {
       CompositeBFieldMap& operator =(CompositeBFieldMap const& ) = delete;
 
     private:
+      static constexpr size_t blocksize_ = 32; // number of points processed together by the batch functions
       FCOL fields_; // fields
   };
 
@@ -115,6 +133,9 @@ namespace KinKal {
       VEC3 fieldVect(VEC3 const& position) const override;
       Grad fieldGrad(VEC3 const& position) const override { return fgrad_; }
       VEC3 fieldDeriv(VEC3 const& position, VEC3 const& velocity) const override;
+      void fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const override;
+      void fieldGrad(VEC3 const* positions, size_t n, Grad* grads) const override { std::fill(grads,grads+n,fgrad_); }
+      void fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const override;
       bool inRange(VEC3 const& position) const override { return true; }
       void print(std::ostream& os =std::cout) const override { os << "BField with  constant gradient of " << grad_ << " Tesla/mm" << std::endl; }
       double gradient() const { return grad_; }
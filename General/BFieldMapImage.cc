@@ -0,0 +1,136 @@
+#include "KinKal/General/BFieldMapImage.hh"
+#include "KinKal/General/CylBFieldGrid.hh"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace KinKal {
+  namespace {
+    // image layout: header, then the field data starting on a 64-byte boundary
+    constexpr char magic[8] = {'K','K','B','F','I','E','L','D'};
+    constexpr uint32_t byteorder = 0x01020304;
+    constexpr uint64_t dataalign = 64;
+    struct Header {
+      char magic[8];
+      uint32_t version, byteorder;
+      uint64_t size; // total image size
+      uint32_t type, pad;
+      uint64_t nr, nz; // number of grid nodes
+      double r0, dr, z0, dz; // grid origin and spacing
+      uint64_t data, ndata; // data offset and size in bytes
+    };
+
+    uint64_t align(uint64_t offset) { return (offset+dataalign-1) & ~(dataalign-1); }
+    Header const& header(void const* base) { return *static_cast<Header const*>(base); }
+
+    // expected size of the data given the grid
+    uint64_t dataSize(Header const& header) {
+      if(header.type == BFieldMapImage::cylindrical)
+        return (header.nr-1)*(header.nz-1)*sizeof(CylBFieldGrid::Cell);
+      else
+        return header.nz*sizeof(double);
+    }
+
+    bool validImage(void const* base, size_t size) {
+      if(size < sizeof(Header))return false;
+      auto const& hdr = header(base);
+      if(memcmp(hdr.magic,magic,sizeof(magic)) != 0 || hdr.version != BFieldMapImage::version()
+          || hdr.byteorder != byteorder || hdr.size != size)return false;
+      if(hdr.type == BFieldMapImage::cylindrical){
+        if(hdr.nr < 2 || hdr.nr > (1u<<20) || !(hdr.dr > 0.0 && std::isfinite(hdr.r0) && std::isfinite(hdr.dr)))return false;
+      } else if(hdr.type != BFieldMapImage::axial)return false;
+      if(hdr.nz < 2 || hdr.nz > (1u<<20) || !(hdr.dz > 0.0 && std::isfinite(hdr.z0) && std::isfinite(hdr.dz)))return false;
+      return hdr.data%dataalign == 0 && hdr.data <= size && hdr.ndata == dataSize(hdr) && hdr.ndata <= size-hdr.data;
+    }
+
+    void writeImage(std::string const& filename, Header& hdr, void const* data) {
+      memcpy(hdr.magic,magic,sizeof(magic));
+      hdr.version = BFieldMapImage::version();
+      hdr.byteorder = byteorder;
+      hdr.data = align(sizeof(Header));
+      hdr.ndata = dataSize(hdr);
+      hdr.size = hdr.data + hdr.ndata;
+      std::vector<char> image(hdr.size,0);
+      memcpy(image.data(),&hdr,sizeof(hdr));
+      memcpy(image.data()+hdr.data,data,hdr.ndata);
+      // write a temporary file in the same directory and rename it over the target.  Processes that have the old image mapped
+      // keep the old inode, so its pages are neither truncated nor changed under them
+      std::string tmpname = filename + ".tmp" + std::to_string(getpid());
+      std::ofstream out(tmpname,std::ios::binary|std::ios::trunc);
+      out.write(image.data(),image.size());
+      out.close();
+      if(out.fail() || std::rename(tmpname.c_str(),filename.c_str()) != 0){
+        std::remove(tmpname.c_str());
+        throw std::runtime_error("BFieldMapImage: failed to write " + filename);
+      }
+    }
+  }
+
+  bool BFieldMapImage::isImage(std::string const& filename) {
+    char fmagic[sizeof(magic)];
+    std::ifstream in(filename,std::ios::binary);
+    return in.read(fmagic,sizeof(fmagic)) && memcmp(fmagic,magic,sizeof(magic)) == 0;
+  }
+
+  BFieldMapImage::BFieldMapImage(std::string const& filename) : base_(0), size_(0) {
+    int fd = open(filename.c_str(),O_RDONLY);
+    if(fd < 0)throw std::invalid_argument("can't open BField image file " + filename);
+    struct stat st;
+    if(fstat(fd,&st) == 0 && st.st_size > 0){
+      // shared read-only mapping: the pages are shared with other processes mapping the same file
+      void* base = mmap(0,st.st_size,PROT_READ,MAP_SHARED,fd,0);
+      if(base != MAP_FAILED){
+        if(validImage(base,st.st_size)){
+          base_ = base;
+          size_ = st.st_size;
+        } else
+          munmap(base,st.st_size);
+      }
+    }
+    close(fd);
+    if(base_ == 0)throw std::invalid_argument(filename + " is not a valid version " + std::to_string(version()) + " BField image");
+  }
+
+  BFieldMapImage::~BFieldMapImage() {
+    munmap(const_cast<void*>(base_),size_);
+  }
+
+  BFieldMapImage::maptype BFieldMapImage::type() const { return static_cast<maptype>(header(base_).type); }
+  size_t BFieldMapImage::nR() const { return header(base_).nr; }
+  size_t BFieldMapImage::nZ() const { return header(base_).nz; }
+  double BFieldMapImage::r0() const { return header(base_).r0; }
+  double BFieldMapImage::dr() const { return header(base_).dr; }
+  double BFieldMapImage::z0() const { return header(base_).z0; }
+  double BFieldMapImage::dz() const { return header(base_).dz; }
+  void const* BFieldMapImage::data() const { return static_cast<char const*>(base_) + header(base_).data; }
+
+  void BFieldMapImage::write(std::string const& filename, CylBFieldGrid const& grid) {
+    Header hdr;
+    memset(&hdr,0,sizeof(hdr));
+    hdr.type = cylindrical;
+    hdr.nr = grid.nR();
+    hdr.nz = grid.nZ();
+    hdr.r0 = grid.r0();
+    hdr.dr = grid.dr();
+    hdr.z0 = grid.z0();
+    hdr.dz = grid.dz();
+    writeImage(filename,hdr,grid.cells());
+  }
+
+  void BFieldMapImage::write(std::string const& filename, double zmin, double zmax, std::vector<double> const& field) {
+    if(field.size() < 2)throw std::invalid_argument("BFieldMapImage: axial field needs at least 2 values");
+    Header hdr;
+    memset(&hdr,0,sizeof(hdr));
+    hdr.type = axial;
+    hdr.nz = field.size();
+    hdr.z0 = zmin;
+    hdr.dz = (zmax-zmin)/double(field.size()-1);
+    writeImage(filename,hdr,field.data());
+  }
+}
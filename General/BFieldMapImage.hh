@@ -0,0 +1,46 @@
+#ifndef KinKal_BFieldMapImage_hh
+#define KinKal_BFieldMapImage_hh
+//
+//  Versioned binary image of a field map, loaded by memory-mapping the file so that the field values are used in place, without
+//  parsing or copying, and are shared between processes through the page cache.  Cylindrical maps store the cells of a
+//  CylBFieldGrid directly; axial maps store the field values.  CylBFieldMap and AxialBFieldMap read images transparently: use
+//  MakeBFieldImage to convert a text map.  An image with a different version or byte order, or an inconsistent layout, is rejected.
+//
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace KinKal {
+  class CylBFieldGrid;
+  class BFieldMapImage {
+    public:
+      enum maptype {axial=1, cylindrical};
+      // image format version; increment when the layout changes
+      static constexpr uint32_t version() { return 1; }
+      // test if a file starts like an image, to choose between the image and text readers
+      static bool isImage(std::string const& filename);
+      // map the image in the given file.  Throws if the file isn't a valid image
+      explicit BFieldMapImage(std::string const& filename);
+      ~BFieldMapImage();
+      BFieldMapImage(BFieldMapImage const&) = delete;
+      BFieldMapImage& operator =(BFieldMapImage const&) = delete;
+      // accessors.  The r grid is only defined for cylindrical maps
+      maptype type() const;
+      size_t nR() const;
+      size_t nZ() const;
+      double r0() const;
+      double dr() const;
+      double z0() const;
+      double dz() const;
+      // start of the field data, aligned to 64 bytes
+      void const* data() const;
+      // write images.  An existing file is replaced atomically, so processes mapping it are unaffected.  Throws on failure
+      static void write(std::string const& filename, CylBFieldGrid const& grid);
+      static void write(std::string const& filename, double zmin, double zmax, std::vector<double> const& field);
+    private:
+      void const* base_; // start of the mapped image
+      size_t size_; // size of the mapped image
+  };
+}
+#endif
@@ -0,0 +1,92 @@
+#ifndef KinKal_BackgroundWorker_hh
+#define KinKal_BackgroundWorker_hh
+//
+//  A persistent helper thread running 1 task at a time, for overlapping a short task with work on the calling thread.
+//  The thread is created once and waits on a condition variable between tasks, so submitting a task costs a wakeup
+//  (a few microseconds) rather than a thread creation.  Each calling thread can get its own worker with threadLocal(),
+//  so concurrent callers (ie TrackBatch workers) never share one.  Exceptions thrown by the task are rethrown by wait().
+//
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+
+namespace KinKal {
+  class BackgroundWorker {
+    public:
+      BackgroundWorker() : thread_([this](){ loop(); }) {}
+      ~BackgroundWorker();
+      BackgroundWorker(BackgroundWorker const&) = delete;
+      BackgroundWorker& operator =(BackgroundWorker const&) = delete;
+      // run func() on the worker thread.  func must stay valid until wait() returns.  Only 1 task can be pending
+      template <class FUNC> void submit(FUNC& func);
+      // wait for the submitted task to finish, rethrowing any exception it threw
+      void wait();
+      // persistent worker belonging to the calling thread
+      static BackgroundWorker& threadLocal() { thread_local BackgroundWorker worker; return worker; }
+    private:
+      void loop();
+      std::mutex mutex_;
+      std::condition_variable cond_;
+      void (*task_)(void*) = nullptr; // pending task, called with its context.  This avoids allocating a std::function
+      void* context_ = nullptr;
+      bool done_ = true, stop_ = false;
+      std::exception_ptr error_; // exception thrown by the last task
+      std::thread thread_; // declared last, so the thread starts after everything else is initialized
+  };
+
+  inline BackgroundWorker::~BackgroundWorker() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+  }
+
+  template <class FUNC> void BackgroundWorker::submit(FUNC& func) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(!done_)throw std::logic_error("BackgroundWorker task already pending");
+      task_ = [](void* context){ (*static_cast<FUNC*>(context))(); };
+      context_ = &func;
+      done_ = false;
+      error_ = nullptr;
+    }
+    cond_.notify_all();
+  }
+
+  inline void BackgroundWorker::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock,[this](){ return done_; });
+    if(error_){
+      auto error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  inline void BackgroundWorker::loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true){
+      cond_.wait(lock,[this](){ return stop_ || task_ != nullptr; });
+      if(task_ == nullptr) return; // stopped with nothing pending
+      auto task = task_;
+      auto context = context_;
+      task_ = nullptr;
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        task(context);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+      error_ = error;
+      done_ = true;
+      cond_.notify_all();
+    }
+  }
+}
+#endif
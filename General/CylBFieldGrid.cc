@@ -0,0 +1,43 @@
+#include "KinKal/General/CylBFieldGrid.hh"
+#include <stdexcept>
+
+namespace KinKal {
+  void CylBFieldGrid::setSpacing(double r0, double dr, double z0, double dz) {
+    if(!(dr > 0.0 && dz > 0.0))throw std::invalid_argument("Invalid CylBFieldGrid spacing");
+    r0_ = r0;
+    z0_ = z0;
+    dr_ = dr;
+    dz_ = dz;
+    invdr_ = 1.0/dr_;
+    invdz_ = 1.0/dz_;
+  }
+
+  CylBFieldGrid::CylBFieldGrid(std::shared_ptr<const BFieldMapImage> const& image) :
+    nr_(image->nR()), nz_(image->nZ()), image_(image), cells_(static_cast<Cell const*>(image->data())) {
+    if(image->type() != BFieldMapImage::cylindrical)throw std::invalid_argument("BField image isn't cylindrical");
+    setSpacing(image->r0(),image->dr(),image->z0(),image->dz());
+  }
+
+  CylBFieldGrid::CylBFieldGrid(VEC const& r, VEC const& z, MAT const& br, MAT const& bz) :
+    nr_(r.size()), nz_(z.size()), cells_(0) {
+    if(nr_ < 2 || nz_ < 2 || br.size() != r.size() || bz.size() != r.size())
+      throw std::invalid_argument("Invalid CylBFieldGrid dimensions");
+    setSpacing(r[0],r[1]-r[0],z[0],z[1]-z[0]);
+    for(int ir=0; ir < nr_; ++ir)
+      if(br[ir].size() != z.size() || bz[ir].size() != z.size())throw std::invalid_argument("Invalid CylBFieldGrid dimensions");
+    owned_.resize(nCells());
+    for(int ir=0; ir < nr_-1; ++ir){
+      for(int iz=0; iz < nz_-1; ++iz){
+        double* b = owned_[ir*(nz_-1)+iz].b_;
+        int icorner(0);
+        for(int jz=iz; jz <= iz+1; ++jz){
+          for(int jr=ir; jr <= ir+1; ++jr){
+            b[icorner++] = br[jr][jz];
+            b[icorner++] = bz[jr][jz];
+          }
+        }
+      }
+    }
+    cells_ = owned_.data();
+  }
+}
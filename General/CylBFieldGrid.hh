@@ -0,0 +1,82 @@
+#ifndef KinKal_CylBFieldGrid_hh
+#define KinKal_CylBFieldGrid_hh
+//
+//  Flat grid of a cylindrically-symmetric field (Br,Bz) on a regular (r,z) grid, used by CylBFieldMap.  Each cell stores the
+//  interleaved (Br,Bz) values at its 4 corners in 1 cache line, so a single lookup returns the bilinear interpolation of both
+//  components and their gradients, reading 1 cache line and without allocating.  Outside the grid the nearest cell is extrapolated.
+//  The cells are either owned, or used in place from a memory-mapped BFieldMapImage.
+//
+#include "KinKal/General/BFieldMapImage.hh"
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+namespace KinKal {
+  class CylBFieldGrid {
+    public:
+      using VEC = std::vector<double>;
+      using MAT = std::vector<VEC>;
+      // field components and their derivatives WRT r and z at a point
+      struct FieldGrad {
+        double br_, bz_;
+        double dbrdr_, dbrdz_, dbzdr_, dbzdz_;
+      };
+      // corners in the order (ir,iz), (ir+1,iz), (ir,iz+1), (ir+1,iz+1), each as (Br,Bz)
+      struct alignas(64) Cell { double b_[8]; };
+      // build from the (uniformly spaced) r and z node coordinates and the field values at the nodes, indexed as [ir][iz]
+      CylBFieldGrid(VEC const& r, VEC const& z, MAT const& br, MAT const& bz);
+      // use the cells of a cylindrical image in place; the grid shares ownership of the image
+      explicit CylBFieldGrid(std::shared_ptr<const BFieldMapImage> const& image);
+      // the cells may point into owned storage, so disallow copy
+      CylBFieldGrid(CylBFieldGrid const&) = delete;
+      CylBFieldGrid& operator =(CylBFieldGrid const&) = delete;
+      // interpolate the field and its gradient
+      FieldGrad evaluate(double r, double z) const;
+      // accessors
+      int nR() const { return nr_; }
+      int nZ() const { return nz_; }
+      double r0() const { return r0_; }
+      double z0() const { return z0_; }
+      double dr() const { return dr_; }
+      double dz() const { return dz_; }
+      size_t nCells() const { return size_t(nr_-1)*size_t(nz_-1); }
+      Cell const* cells() const { return cells_; }
+      // field values at a grid node
+      double br(int ir, int iz) const { return node(ir,iz)[0]; }
+      double bz(int ir, int iz) const { return node(ir,iz)[1]; }
+    private:
+      void setSpacing(double r0, double dr, double z0, double dz);
+      double const* node(int ir, int iz) const;
+      double r0_, z0_, dr_, dz_, invdr_, invdz_;
+      int nr_, nz_; // number of nodes in r and z
+      std::vector<Cell> owned_; // cells built from text input
+      std::shared_ptr<const BFieldMapImage> image_; // image holding the cells, if mapped
+      Cell const* cells_; // (nr-1)*(nz-1) cells, with z varying fastest
+  };
+
+  inline double const* CylBFieldGrid::node(int ir, int iz) const {
+    // the last row and column of nodes are only stored as the upper corners of the last cells
+    int icr = std::min(ir,nr_-2), icz = std::min(iz,nz_-2);
+    return cells_[icr*(nz_-1)+icz].b_ + 2*((ir-icr) + 2*(iz-icz));
+  }
+
+  inline CylBFieldGrid::FieldGrad CylBFieldGrid::evaluate(double r, double z) const {
+    // find the cell enclosing (r,z), or the nearest one
+    int ir = std::max(0, std::min(nr_-2, int((r-r0_)*invdr_)));
+    int iz = std::max(0, std::min(nz_-2, int((z-z0_)*invdz_)));
+    // fractional position in the cell
+    double t = (r-(r0_+ir*dr_))*invdr_;
+    double u = (z-(z0_+iz*dz_))*invdz_;
+    double const* b = cells_[ir*(nz_-1)+iz].b_;
+    double w00 = (1.-t)*(1.-u), w10 = t*(1.-u), w01 = (1.-t)*u, w11 = t*u;
+    FieldGrad retval;
+    retval.br_ = w00*b[0] + w10*b[2] + w01*b[4] + w11*b[6];
+    retval.bz_ = w00*b[1] + w10*b[3] + w01*b[5] + w11*b[7];
+    retval.dbrdr_ = invdr_*((1.-u)*(b[2]-b[0]) + u*(b[6]-b[4]));
+    retval.dbzdr_ = invdr_*((1.-u)*(b[3]-b[1]) + u*(b[7]-b[5]));
+    retval.dbrdz_ = invdz_*((1.-t)*(b[4]-b[0]) + t*(b[6]-b[2]));
+    retval.dbzdz_ = invdz_*((1.-t)*(b[5]-b[1]) + t*(b[7]-b[3]));
+    return retval;
+  }
+}
+#endif
@@ -4,59 +4,67 @@ namespace KinKal{
   using VEC = std::vector<double>;
   using MAT = std::vector<std::vector<double>>;
   
-  CylBFieldMap::CylBFieldMap(std::string const& file)
-    : B_dat(file), Br_interp(B_dat.r_, B_dat.z_, B_dat.Br_),
-    Bz_interp(B_dat.r_, B_dat.z_, B_dat.Bz_) {}
+  CylBFieldMap::CylBFieldMap(std::string const& file) : grid_(readGrid(file)) {}
+
+  CylBFieldGrid CylBFieldMap::readGrid(std::string const& file) {
+    // images are used in place; text maps are parsed and packed into the grid
+    if(BFieldMapImage::isImage(file)) return CylBFieldGrid(std::make_shared<const BFieldMapImage>(file));
+    CylBMap bmap(file);
+    return CylBFieldGrid(bmap.r_, bmap.z_, bmap.Br_, bmap.Bz_);
+  }
 
   VEC3 CylBFieldMap::fieldVect(VEC3 const& position) const {
     // calcualte interpolated field value at position, in cartesian coordinates
-    double Bz = Bz_interp.interp(position.Rho(), position.Z());
-    double Br = Br_interp.interp(position.Rho(), position.Z());
+    double rho = position.Rho();
+    auto fgrad = grid_.evaluate(rho, position.Z());
     // handle case where R=0 -- R=X
-    if (position.Rho() < 1e-6) {
-      return VEC3(Br, 0., Bz);
+    if (rho < 1e-6) {
+      return VEC3(fgrad.br_, 0., fgrad.bz_);
     }
     else {
-      return VEC3(Br*position.X()/position.Rho(), Br*position.Y()/position.Rho(), Bz);
+      double rinv = 1.0/rho;
+      return VEC3(fgrad.br_*position.X()*rinv, fgrad.br_*position.Y()*rinv, fgrad.bz_);
     }
   }
 
-  CylBFieldMap::Grad CylBFieldMap::fieldGrad(VEC3 const& position) const {
-    // calculate gradient matrix at position, in cartesian coordinates
-    // calculate needed field and gradient values
-    double Br = Br_interp.interp(position.Rho(), position.Z());
-    VEC dBz = Bz_interp.gradient(position.Rho(), position.Z());
-    VEC dBr = Br_interp.gradient(position.Rho(), position.Z());
-    // vector to fill, will instantiate final Grad
-    VEC dBi(9);
+  CylBFieldMap::Grad CylBFieldMap::cartesianGrad(VEC3 const& position, double rho, CylBFieldGrid::FieldGrad const& fgrad) {
+    Grad retval;
     // handle case where R=0 -- R=X, dR/dX=1, dR/dY=0
-    if (position.Rho() < 1e-6) {
-      dBi = VEC{dBr[0], 0., dBr[1],
-      0.,0.,0.,
-      dBz[0], 0., dBz[1]};
+    if (rho < 1e-6) {
+      retval(0,0) = fgrad.dbrdr_; retval(0,2) = fgrad.dbrdz_;
+      retval(2,0) = fgrad.dbzdr_; retval(2,2) = fgrad.dbzdz_;
     }
     else {
       // store values that are calculated multiple times
-      double xr=position.X()/position.Rho(), yr=position.Y()/position.Rho();
+      double rinv = 1.0/rho;
+      double xr=position.X()*rinv, yr=position.Y()*rinv;
       double xryr = xr*yr, xrxr=xr*xr, yryr=yr*yr;
-      double rinv = 1/position.Rho();
-      dBi = VEC{dBr[0]*xrxr + Br * rinv*(1 - xrxr),
-        dBr[0]*xryr + Br * (- xryr * rinv),
-        xr * dBr[1],
-        dBr[0]*xryr + Br * (- xryr * rinv),
-        dBr[0]*yryr + Br * rinv*(1 - yryr),
-        yr * dBr[1],
-        dBz[0]*xr,dBz[0]*yr,dBz[1]};
+      double brr = fgrad.br_*rinv;
+      retval(0,0) = fgrad.dbrdr_*xrxr + brr*(1 - xrxr);
+      retval(0,1) = (fgrad.dbrdr_ - brr)*xryr;
+      retval(0,2) = xr*fgrad.dbrdz_;
+      retval(1,0) = retval(0,1);
+      retval(1,1) = fgrad.dbrdr_*yryr + brr*(1 - yryr);
+      retval(1,2) = yr*fgrad.dbrdz_;
+      retval(2,0) = fgrad.dbzdr_*xr;
+      retval(2,1) = fgrad.dbzdr_*yr;
+      retval(2,2) = fgrad.dbzdz_;
     }
-    Grad retval(dBi.begin(), dBi.end());
     return retval;
   }
 
+  CylBFieldMap::Grad CylBFieldMap::fieldGrad(VEC3 const& position) const {
+    // calculate gradient matrix at position, in cartesian coordinates, from a single grid lookup
+    double rho = position.Rho();
+    return cartesianGrad(position, rho, grid_.evaluate(rho, position.Z()));
+  }
+
   VEC3 CylBFieldMap::fieldDeriv(VEC3 const& position, VEC3 const& velocity) const {
-    Grad grad = fieldGrad(position);
-    VEC3 retval(grad[0][0]*velocity.X()+grad[0][1]*velocity.Y()+grad[0][2]*velocity.Z(),
-      grad[1][0]*velocity.X()+grad[1][1]*velocity.Y()+grad[1][2]*velocity.Z(),
-      grad[2][0]*velocity.X()+grad[2][1]*velocity.Y()+grad[2][2]*velocity.Z());
+    double rho = position.Rho();
+    Grad grad = cartesianGrad(position, rho, grid_.evaluate(rho, position.Z()));
+    VEC3 retval(grad(0,0)*velocity.X()+grad(0,1)*velocity.Y()+grad(0,2)*velocity.Z(),
+      grad(1,0)*velocity.X()+grad(1,1)*velocity.Y()+grad(1,2)*velocity.Z(),
+      grad(2,0)*velocity.X()+grad(2,1)*velocity.Y()+grad(2,2)*velocity.Z());
     return retval;
   }
 
@@ -66,4 +74,18 @@ namespace KinKal{
     bool zrange = (position.Z() >= zMin()) && (position.Z() <= zMax());
     return rrange && zrange;
   }
+
+  // batch functions: qualified calls to the single-point functions are resolved statically, so they can be inlined
+  void CylBFieldMap::fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const {
+    for(size_t ipt=0; ipt < n; ++ipt) fields[ipt] = CylBFieldMap::fieldVect(positions[ipt]);
+  }
+
+  void CylBFieldMap::fieldGrad(VEC3 const* positions, size_t n, Grad* grads) const {
+    for(size_t ipt=0; ipt < n; ++ipt) grads[ipt] = CylBFieldMap::fieldGrad(positions[ipt]);
+  }
+
+  void CylBFieldMap::fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const {
+    for(size_t ipt=0; ipt < n; ++ipt) derivs[ipt] = CylBFieldMap::fieldDeriv(positions[ipt],velocities[ipt]);
+  }
+
 }
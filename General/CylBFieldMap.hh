@@ -2,7 +2,7 @@
 #define KinKal_CylBFieldMap_hh
 
 #include "KinKal/General/CylBMap.hh"
-#include "KinKal/General/InterpBilinear.hh"
+#include "KinKal/General/CylBFieldGrid.hh"
 #include "KinKal/General/BFieldMap.hh"
 
 namespace KinKal {
@@ -10,31 +10,38 @@ namespace KinKal {
     public:
       using VEC = std::vector<double>;
       using MAT = std::vector<std::vector<double>>;
-      CylBFieldMap(std::string const& file); // supply data file
+      CylBFieldMap(std::string const& file); // supply data file, either text or a BFieldMapImage
       VEC3 fieldVect(VEC3 const& position) const override;
       Grad fieldGrad(VEC3 const& position) const override;
       VEC3 fieldDeriv(VEC3 const& position, VEC3 const& velocity) const override;
+      void fieldVect(VEC3 const* positions, size_t n, VEC3* fields) const override;
+      void fieldGrad(VEC3 const* positions, size_t n, Grad* grads) const override;
+      void fieldDeriv(VEC3 const* positions, VEC3 const* velocities, size_t n, VEC3* derivs) const override;
       bool inRange(VEC3 const& position) const override;
       // TO DO!
       void print(std::ostream& os=std::cout) const override {
         os << "Cylindrically symmetric Bfield with boundaries z=[" << zMin() << ", " << zMax() << "] and r=["
-          << rMin() << ", " << rMax() << "] with " << B_dat.ntot_
-          << " field values from (lower left, upper left): Br=(" << B_dat.Br_.front().front() << ", "
-          << B_dat.Br_.back().back() << ") Tesla and Bz=(" << B_dat.Bz_.front().front() << ", "
-          << B_dat.Bz_.back().back() << ") Tesla" << std::endl;
+          << rMin() << ", " << rMax() << "] with " << grid_.nR()*grid_.nZ()
+          << " field values from (lower left, upper left): Br=(" << grid_.br(0,0) << ", "
+          << grid_.br(grid_.nR()-1,grid_.nZ()-1) << ") Tesla and Bz=(" << grid_.bz(0,0) << ", "
+          << grid_.bz(grid_.nR()-1,grid_.nZ()-1) << ") Tesla" << std::endl;
       }
       virtual ~CylBFieldMap(){}
       // disallow copy and equivalence
       CylBFieldMap(CylBFieldMap const& ) = delete;
       CylBFieldMap& operator =(CylBFieldMap const& ) = delete;
       // getters
-      double zMax() const { return B_dat.z_.back(); }
-      double zMin() const { return B_dat.z_.front(); }
-      double rMax() const { return B_dat.r_.back(); }
-      double rMin() const { return B_dat.r_.front(); }
+      double zMax() const { return grid_.z0() + (grid_.nZ()-1)*grid_.dz(); }
+      double zMin() const { return grid_.z0(); }
+      double rMax() const { return grid_.r0() + (grid_.nR()-1)*grid_.dr(); }
+      double rMin() const { return grid_.r0(); }
+      CylBFieldGrid const& grid() const { return grid_; }
     private:
-      const CylBMap B_dat;
-      const InterpBilinear Br_interp, Bz_interp;
+      // read the grid from a text map or an image
+      static CylBFieldGrid readGrid(std::string const& file);
+      // convert the interpolated cylindrical field gradient to cartesian coordinates
+      static Grad cartesianGrad(VEC3 const& position, double rho, CylBFieldGrid::FieldGrad const& fgrad);
+      const CylBFieldGrid grid_; // field values, used for all lookups
   };
 }
 #endif
@@ -1,7 +1,8 @@
 #include "KinKal/General/CylBMap.hh"
 
 #include <fstream>
-#include <sstream>
+#include <stdexcept>
+#include <cstdlib>
 #include <math.h>
 
 namespace KinKal{
@@ -23,16 +24,11 @@ namespace KinKal{
   }
 
   CylBMap::CylBMap(const std::string& file) {
-    // read in data from a file
-    ntot_ = 0; // track number of lines
+    // read in data from a file in a single pass
     std::string line;
     std::ifstream stream(file);
-    while (std::getline(stream, line))
-      ++ntot_;
-    stream.close();
-    // loop through  again, saving data
+    if (!stream) throw std::invalid_argument("can't open field map file " + file);
     // first sift through header
-    stream.open(file);
     std::string const data_flag="data";
     std::string const grid_flag="grid";
     double R0=0., Z0=0., dR=0., dZ=0.;
@@ -41,7 +37,7 @@ namespace KinKal{
     while (line.substr(0, 4) != data_flag)
     {
       // get the next line
-      std::getline(stream, line);
+      if (!std::getline(stream, line)) throw std::invalid_argument("no data found in field map file!");
       // parse grid, if parameters in line
       if (line.substr(0, 4) == grid_flag)
       {
@@ -54,8 +50,6 @@ namespace KinKal{
         dZ = parse_param_double(line, "dZ=");
         grid_parsed=true;
       }
-      // decrease data count
-      --ntot_;
     }
     // throw if no grid parameters found
     if (!grid_parsed) throw std::invalid_argument("no grid parameters found in data file!");
@@ -63,7 +57,7 @@ namespace KinKal{
     m_ = nR;
     n_ = nZ;
     int ntot_exp = m_*n_;
-    if (ntot_ != ntot_exp) throw std::invalid_argument("number of data does not match expected, based on grid parameters");
+    if (m_ < 1 || n_ < 1) throw std::invalid_argument("invalid grid parameters");
     r_.resize(m_);
     z_.resize(n_);
     // set r and z from grid parameters
@@ -82,23 +76,20 @@ namespace KinKal{
       Br_[i].resize(n_);
       Bz_[i].resize(n_);
     }
-    // loop through data lines
-    double temp, delta_pos, z_temp, r_temp;
+    // loop through data lines, counting them as we go
+    double delta_pos, z_temp, r_temp;
     int step=0, i=0, j=0;
     while(std::getline(stream, line)) {
+      if (step >= ntot_exp) throw std::invalid_argument("number of data does not match expected, based on grid parameters");
       i = step / n_;
       j = step % n_;
-      std::istringstream iss(line);
-      // grab r & z values
-      iss >> temp;
-      r_temp = temp;
-      iss >> temp;
-      z_temp = temp;
-      // grab field values
-      iss >> temp;
-      Br_[i][j] = temp;
-      iss >> temp;
-      Bz_[i][j] = temp;
+      // grab r & z values, then field values
+      char const* pos = line.c_str();
+      char* end;
+      r_temp = std::strtod(pos, &end); pos = end;
+      z_temp = std::strtod(pos, &end); pos = end;
+      Br_[i][j] = std::strtod(pos, &end); pos = end;
+      Bz_[i][j] = std::strtod(pos, &end);
       // check that r and z grid values are correct
       delta_pos = pow(pow(r_temp-r_[i], 2) + pow(z_temp-z_[j], 2), 0.5);
       if(std::abs(delta_pos) > 1e-5) throw std::invalid_argument("field spacing isn't uniform! dist="+
@@ -107,7 +98,9 @@ namespace KinKal{
       // increment
       step++;
     }
-    // Shrink to fit -- fixes issues with passing in values to InterpBilinear
+    ntot_ = step;
+    if (ntot_ != ntot_exp) throw std::invalid_argument("number of data does not match expected, based on grid parameters");
+    // Shrink to fit
     r_.shrink_to_fit(), z_.shrink_to_fit(); 
     Br_.shrink_to_fit(), Bz_.shrink_to_fit();
     // shrink inner vectors
@@ -8,6 +8,7 @@
 #include "Math/SVector.h"
 #include "Math/SMatrix.h"
 #include "KinKal/General/Vectors.hh"
+#include "KinKal/General/SymInverse.hh"
 #include <stdexcept>
 
 namespace KinKal {
@@ -27,17 +28,11 @@ namespace KinKal {
       // scale the matrix
       void scale(double sfac) { mat_ *= sfac; }
       // inversion changes from params <-> weight.
-      // Invert in-place
+      // Invert in-place.  The matrix must be strictly positive-definite: this uses the dedicated kernel (which solves for the vector at the same time),
+      // and throws if any pivot is not positive and finite.  Singular or indefinite matrices, which general-purpose inversion might have accepted,
+      // are rejected, for instance a weight from which a measurement dominating it was subtracted (see Hit::unbiasedParameters)
       void invert() {
-        // first invert the matrix
-        if(mat_.Invert()){
-          vec_ = mat_*vec_;
-        } else {
-          throw std::runtime_error("Inversion failure");
-        }
-        // check
-        if(std::isnan(mat_(0,0)))throw std::runtime_error("Inversion failure");
-
+        if(!invertSPD(mat_,vec_))throw std::runtime_error("Inversion failure");
       }
       // append
       FitData & operator -= (FitData const& other) {
@@ -0,0 +1,72 @@
+//
+// Convert a text field map (CylBMap or AxialBFieldMap format) into a binary BFieldMapImage, which CylBFieldMap and AxialBFieldMap
+// then map in place instead of parsing the text
+//
+#include "KinKal/General/BFieldMapImage.hh"
+#include "KinKal/General/CylBFieldMap.hh"
+#include "KinKal/General/AxialBFieldMap.hh"
+
+#include <iostream>
+#include <stdio.h>
+#include <getopt.h>
+#include <string>
+
+using namespace KinKal;
+using namespace std;
+
+void print_usage() {
+  printf("Usage: MakeBFieldImage --cylindrical s | --axial s --output s\n");
+}
+
+int main(int argc, char **argv) {
+  string cylfile, axfile, output;
+  static struct option long_options[] = {
+    {"cylindrical",     required_argument, 0, 'c'  },
+    {"axial",     required_argument, 0, 'a'  },
+    {"output",     required_argument, 0, 'o'  },
+    {NULL, 0,0,0}
+  };
+  int long_index =0;
+  int opt;
+  while ((opt = getopt_long_only(argc, argv,"",
+          long_options, &long_index )) != -1) {
+    switch (opt) {
+      case 'c' : cylfile = string(optarg);
+                 break;
+      case 'a' : axfile = string(optarg);
+                 break;
+      case 'o' : output = string(optarg);
+                 break;
+      default: print_usage();
+               exit(EXIT_FAILURE);
+    }
+  }
+  if(output.empty() || cylfile.empty() == axfile.empty()){
+    print_usage();
+    exit(EXIT_FAILURE);
+  }
+  // convert, then verify the image can be read back and gives the same field
+  VEC3 testpos(100.0,-50.0,200.0);
+  VEC3 textfield, imagefield;
+  if(!cylfile.empty()){
+    CylBFieldMap textmap(cylfile);
+    BFieldMapImage::write(output,textmap.grid());
+    CylBFieldMap imagemap(output);
+    textfield = textmap.fieldVect(testpos);
+    imagefield = imagemap.fieldVect(testpos);
+    imagemap.print(cout);
+  } else {
+    AxialBFieldMap textmap(axfile);
+    BFieldMapImage::write(output,textmap.zMin(),textmap.zMax(),textmap.field());
+    AxialBFieldMap imagemap(output);
+    textfield = textmap.fieldVect(testpos);
+    imagefield = imagemap.fieldVect(testpos);
+    imagemap.print(cout);
+  }
+  if(textfield != imagefield){
+    cout << "Failed to verify " << output << endl;
+    return EXIT_FAILURE;
+  }
+  cout << "Wrote " << output << endl;
+  return EXIT_SUCCESS;
+}
@@ -1,5 +1,6 @@
 #include "KinKal/General/Parameters.hh"
 #include "KinKal/General/Weights.hh"
+#include "KinKal/General/SymInverse.hh"
 #include <stdexcept>
 namespace KinKal {
   Parameters::Parameters(Weights const& wdata) : fitdata_(wdata.fitData(),true) {}
@@ -10,7 +11,7 @@ namespace KinKal {
     // sum the covariances
     DMAT csum = covariance() + other.covariance();
     // invert and contract
-    if(!csum.Invert())throw std::runtime_error("Inversion failure");
+    if(!invertSPD(csum))throw std::runtime_error("Inversion failure");
     double retval = ROOT::Math::Similarity(pdiff,csum);
     return retval;
   }
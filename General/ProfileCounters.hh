@@ -0,0 +1,24 @@
+#ifndef KinKal_ProfileCounters_hh
+#define KinKal_ProfileCounters_hh
+//
+//  Per-thread counters of expensive low-level operations, used to build the fit profile (see Fit/FitProfile.hh).
+//  Counting is only compiled in when KINKAL_PROFILE is defined (cmake -DKINKAL_PROFILE=ON), otherwise KINKAL_PROFILE_COUNT is empty.
+//
+namespace KinKal {
+  struct ProfileCounters {
+    unsigned long ninversions_ = 0; // symmetric matrix inversions
+    unsigned long ntcaiters_ = 0; // closest approach iterations
+    unsigned long npieceallocs_ = 0; // heap allocations of trajectory pieces and piece storage blocks (other allocations are not counted)
+    // counters for the calling thread
+    static ProfileCounters& local() {
+      thread_local ProfileCounters counters;
+      return counters;
+    }
+  };
+}
+#ifdef KINKAL_PROFILE
+#define KINKAL_PROFILE_COUNT(counter,count) (KinKal::ProfileCounters::local().counter += (count))
+#else
+#define KINKAL_PROFILE_COUNT(counter,count)
+#endif
+#endif
@@ -0,0 +1,112 @@
+#ifndef KinKal_SymInverse_hh
+#define KinKal_SymInverse_hh
+//
+//  Inversion of symmetric positive-definite matrices (covariances and weights) using the LDL^T (square-root free Cholesky)
+//  decomposition.  The dimension is fixed at compile time, so the loops can be fully unrolled.  Failure (a pivot which is
+//  not positive and finite) is detected during the decomposition and reported through the return value, so the result
+//  doesn't need to be tested for NaNs.  The fused form also solves for a vector, as needed to convert between parameters and weights.
+//
+#include "Math/SMatrix.h"
+#include "Math/SVector.h"
+#include "KinKal/General/ProfileCounters.hh"
+#include <cmath>
+
+namespace KinKal {
+  template <unsigned N> class SymInverse {
+    public:
+      using MAT = ROOT::Math::SMatrix<double,N,N,ROOT::Math::MatRepSym<double,N>>;
+      using VEC = ROOT::Math::SVector<double,N>;
+      // decompose the matrix
+      explicit SymInverse(MAT const& mat);
+      // whether the matrix was positive-definite.  The functions below require this
+      bool valid() const { return valid_; }
+      // replace vec with (mat^-1)*vec
+      void solve(VEC& vec) const;
+      // fill the inverse
+      void inverse(MAT& inv) const;
+    private:
+      double l_[N][N]; // unit lower triangle; only the part below the diagonal is used
+      double invd_[N]; // inverse of the diagonal
+      bool valid_;
+  };
+
+  template <unsigned N> SymInverse<N>::SymInverse(MAT const& mat) : valid_(false) {
+    double const* arr = mat.Array(); // packed lower triangle, row-wise
+    double a[N][N];
+    unsigned ipack(0);
+    for(unsigned irow=0; irow < N; irow++)
+      for(unsigned icol=0; icol <= irow; icol++)
+        a[irow][icol] = arr[ipack++];
+    double d[N];
+    for(unsigned icol=0; icol < N; icol++){
+      d[icol] = a[icol][icol];
+      for(unsigned k=0; k < icol; k++) d[icol] -= l_[icol][k]*l_[icol][k]*d[k];
+      if(!(d[icol] > 0.0 && std::isfinite(d[icol]))) return; // not positive-definite
+      invd_[icol] = 1.0/d[icol];
+      for(unsigned irow=icol+1; irow < N; irow++){
+        double l = a[irow][icol];
+        for(unsigned k=0; k < icol; k++) l -= l_[irow][k]*l_[icol][k]*d[k];
+        l_[irow][icol] = l*invd_[icol];
+      }
+    }
+    valid_ = true;
+  }
+
+  template <unsigned N> void SymInverse<N>::solve(VEC& vec) const {
+    double x[N];
+    // forward substitution through the unit lower triangle
+    for(unsigned irow=0; irow < N; irow++){
+      x[irow] = vec[irow];
+      for(unsigned k=0; k < irow; k++) x[irow] -= l_[irow][k]*x[k];
+    }
+    for(unsigned irow=0; irow < N; irow++) x[irow] *= invd_[irow];
+    // back substitution through the transpose
+    for(unsigned irow=N; irow-- > 0; ){
+      for(unsigned k=irow+1; k < N; k++) x[irow] -= l_[k][irow]*x[k];
+      vec[irow] = x[irow];
+    }
+  }
+
+  template <unsigned N> void SymInverse<N>::inverse(MAT& inv) const {
+    // invert the unit lower triangle
+    double li[N][N];
+    for(unsigned icol=0; icol < N; icol++){
+      li[icol][icol] = 1.0;
+      for(unsigned irow=icol+1; irow < N; irow++){
+        double sum = l_[irow][icol];
+        for(unsigned k=icol+1; k < irow; k++) sum += l_[irow][k]*li[k][icol];
+        li[irow][icol] = -sum;
+      }
+    }
+    // inv = li^T D^-1 li, filling the packed lower triangle
+    double* arr = inv.Array();
+    unsigned ipack(0);
+    for(unsigned irow=0; irow < N; irow++){
+      for(unsigned icol=0; icol <= irow; icol++){
+        double sum(0.0);
+        for(unsigned k=irow; k < N; k++) sum += li[k][irow]*invd_[k]*li[k][icol];
+        arr[ipack++] = sum;
+      }
+    }
+  }
+
+  // invert mat in place and replace vec with (mat^-1)*vec.  Return false (leaving the inputs unchanged) if mat isn't positive-definite
+  template <unsigned N> bool invertSPD(ROOT::Math::SMatrix<double,N,N,ROOT::Math::MatRepSym<double,N>>& mat, ROOT::Math::SVector<double,N>& vec) {
+    KINKAL_PROFILE_COUNT(ninversions_,1);
+    SymInverse<N> sinv(mat);
+    if(!sinv.valid()) return false;
+    sinv.solve(vec);
+    sinv.inverse(mat);
+    return true;
+  }
+
+  // invert mat in place.  Return false (leaving the input unchanged) if mat isn't positive-definite
+  template <unsigned N> bool invertSPD(ROOT::Math::SMatrix<double,N,N,ROOT::Math::MatRepSym<double,N>>& mat) {
+    KINKAL_PROFILE_COUNT(ninversions_,1);
+    SymInverse<N> sinv(mat);
+    if(!sinv.valid()) return false;
+    sinv.inverse(mat);
+    return true;
+  }
+}
+#endif
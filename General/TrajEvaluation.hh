@@ -0,0 +1,25 @@
+#ifndef KinKal_TrajEvaluation_hh
+#define KinKal_TrajEvaluation_hh
+//
+//  Result of a fused evaluation of a kinematic trajectory at a given time.  The trajectory 'evaluate' function fills
+//  everything requested by the content flags from a single phase (trig) and rotation evaluation, instead of repeating
+//  these for each of position4, velocity, direction, dXdPar and dPardM.  The acceleration describes the local curvature,
+//  as used to improve closest approach calculations.
+//
+#include "KinKal/General/Vectors.hh"
+#include "KinKal/General/MomBasis.hh"
+
+namespace KinKal {
+  struct TrajEvaluation {
+    // optional content; position, velocity and the momentum direction are always filled
+    enum Content : unsigned {basic=0, basis=1, dXdPar=2, dPardM=4, acceleration=8};
+    VEC4 pos_; // position and time
+    VEC3 vel_; // velocity
+    VEC3 acc_; // acceleration
+    VEC3 dir_[MomBasis::ndir]; // direction basis, indexed by MomBasis::Direction.  Only momdir_ is filled without the basis flag
+    DVDP dXdP_; // derivative of the (global) position WRT the parameters
+    DPDV dPdM_; // derivative of the parameters WRT the (global) momentum
+    VEC3 const& direction(MomBasis::Direction mdir=MomBasis::momdir_) const { return dir_[mdir]; }
+  };
+}
+#endif
@@ -36,6 +36,9 @@ namespace KinKal {
         fitdata_.mat() *= scale;
         return *this;
       }
+      // add parameter-space noise G*G^T (rank <= N), and shift the parameters by dpvec, without leaving weight space.
+      // The Woodbury identity means only an NxN matrix is inverted.  Return false (leaving the weights unchanged) if that fails
+      template <unsigned N> bool addNoise(DVEC const& dpvec, ROOT::Math::SMatrix<double,NParams(),N> const& gmat);
       Weights scale(double scale) const {
         Weights retval = *this;
         retval *= scale;
@@ -50,5 +53,27 @@ namespace KinKal {
       FitData fitdata_; // data payload
   };
   std::ostream& operator << (std::ostream& ost, Weights const& wdata);
+
+  template <unsigned N> bool Weights::addNoise(DVEC const& dpvec, ROOT::Math::SMatrix<double,NParams(),N> const& gmat) {
+    // W' = W - WG (1 + G^T W G)^-1 G^T W
+    ROOT::Math::SMatrix<double,NParams(),N> wg = weightMat()*gmat;
+    ROOT::Math::SMatrix<double,N,N,ROOT::Math::MatRepSym<double,N>> mmat;
+    for(unsigned irow=0; irow < N; irow++){
+      for(unsigned icol=0; icol <= irow; icol++){
+        double sum = irow == icol ? 1.0 : 0.0;
+        for(size_t ipar=0; ipar < NParams(); ipar++) sum += gmat(ipar,irow)*wg(ipar,icol);
+        mmat(irow,icol) = sum;
+      }
+    }
+    if(!invertSPD(mmat)) return false;
+    ROOT::Math::SMatrix<double,NParams(),N> kmat = wg*mmat;
+    // the weight vector is W'(p + dp), and W'p = w - K G^T w
+    weightVec() -= kmat*(ROOT::Math::Transpose(gmat)*weightVec());
+    for(size_t ipar=0; ipar < NParams(); ipar++)
+      for(size_t jpar=0; jpar <= ipar; jpar++)
+        for(unsigned k=0; k < N; k++) weightMat()(ipar,jpar) -= kmat(ipar,k)*wg(jpar,k);
+    weightVec() += weightMat()*dpvec;
+    return true;
+  }
 }
 #endif
@@ -0,0 +1,100 @@
+#ifndef KinKal_WorkStealingPool_hh
+#define KinKal_WorkStealingPool_hh
+//
+//  Minimal work-stealing thread pool for processing a fixed set of independent tasks.
+//  Tasks are identified by their index, and are initially distributed in contiguous blocks
+//  to per-worker queues.  Each worker consumes its own queue from the back, and when it runs dry
+//  steals from the front of the other workers queues.  This balances the load when the task cost
+//  varies widely (ie track fits with very different numbers of hits and iterations).
+//  Exceptions thrown by a task are captured and rethrown (lowest task index first) after all workers finish.
+//
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+#include <memory>
+#include <cstddef>
+
+namespace KinKal {
+  class WorkStealingPool {
+    public:
+      // construct with a number of worker threads.  0 means use the hardware concurrency
+      explicit WorkStealingPool(unsigned nthreads=0) : nthreads_(nthreads) {
+        if(nthreads_ == 0) nthreads_ = std::max(1u,std::thread::hardware_concurrency());
+      }
+      unsigned nThreads() const { return nthreads_; }
+      // process tasks [0,ntasks).  FUNC is called as func(itask,iworker); calls with different itask may run concurrently.
+      template <class FUNC> void process(size_t ntasks, FUNC const& func) const;
+    private:
+      struct TaskQueue {
+        std::mutex mutex_;
+        std::deque<size_t> tasks_;
+      };
+      // take a task from this workers queue, or steal one from another worker.  Return false if all queues are empty
+      static bool nextTask(std::vector<std::unique_ptr<TaskQueue>>& queues, unsigned iworker, size_t& itask);
+      unsigned nthreads_; // number of worker threads
+  };
+
+  template <class FUNC> void WorkStealingPool::process(size_t ntasks, FUNC const& func) const {
+    if(ntasks == 0) return;
+    unsigned nworkers = static_cast<unsigned>(std::min<size_t>(nthreads_,ntasks));
+    // run serially without spawning threads if there's only 1 worker
+    if(nworkers == 1){
+      for(size_t itask=0; itask < ntasks; ++itask) func(itask,0u);
+      return;
+    }
+    std::vector<std::exception_ptr> errors(ntasks);
+    // distribute the tasks in contiguous blocks
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    queues.reserve(nworkers);
+    for(unsigned iworker=0; iworker < nworkers; ++iworker){
+      queues.emplace_back(std::make_unique<TaskQueue>());
+      size_t begin = (ntasks*iworker)/nworkers;
+      size_t end = (ntasks*(iworker+1))/nworkers;
+      for(size_t itask=begin; itask < end; ++itask) queues.back()->tasks_.push_back(itask);
+    }
+    auto work = [&](unsigned iworker) {
+      size_t itask;
+      while(nextTask(queues,iworker,itask)){
+        try {
+          func(itask,iworker);
+        } catch (...) {
+          errors[itask] = std::current_exception();
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(nworkers-1);
+    for(unsigned iworker=1; iworker < nworkers; ++iworker) threads.emplace_back(work,iworker);
+    work(0); // the calling thread is worker 0
+    for(auto& thread : threads) thread.join();
+    for(auto const& error : errors) if(error) std::rethrow_exception(error);
+  }
+
+  inline bool WorkStealingPool::nextTask(std::vector<std::unique_ptr<TaskQueue>>& queues, unsigned iworker, size_t& itask) {
+    // first, our own queue (LIFO)
+    {
+      auto& queue = *queues[iworker];
+      std::lock_guard<std::mutex> lock(queue.mutex_);
+      if(!queue.tasks_.empty()){
+        itask = queue.tasks_.back();
+        queue.tasks_.pop_back();
+        return true;
+      }
+    }
+    // then steal from the others (FIFO), starting with the neighbor
+    for(size_t ioff=1; ioff < queues.size(); ++ioff){
+      auto& queue = *queues[(iworker+ioff)%queues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex_);
+      if(!queue.tasks_.empty()){
+        itask = queue.tasks_.front();
+        queue.tasks_.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+}
+#endif
@@ -15,6 +15,7 @@
 //           Orion Ning, 01/12/21
 //------------------------------------------------------------------------------
 #include "KinKal/MatEnv/DetMaterial.hh"
+#include "KinKal/MatEnv/ErrLog.hh"
 #include <iostream>
 #include <cfloat>
 #include <string>
@@ -129,9 +130,9 @@ namespace MatEnv {
         double chic2 = _chic2*path*invb2*invmom2;
         double chia2 = _chia2_1*(1.0 + _chia2_2*invb2)*invmom2;
         double omega = chic2/chia2;
-        static double vfactor = 0.5/(1-_scatterfrac);
+        double vfactor, sig2factor;
+        scatterFactors(vfactor,sig2factor);
         double v = vfactor*omega;
-        static double sig2factor = 1.0/(1+_scatterfrac*_scatterfrac);
         double sig2 = sig2factor*chic2*( (1+v)*log(1+v)/v - 1);
         // protect against underflow
         double sigdl = sqrt(std::max(0.0,sig2));
@@ -141,9 +142,21 @@ namespace MatEnv {
         return 1.0; // 'infinite' scattering
     }
 
+  void DetMaterial::scatterFactors(double& vfactor, double& sig2factor) const {
+    // these are initialized from the first material used, as in the original scalar calculation, so the batch results match it
+    static double svfactor = 0.5/(1-_scatterfrac);
+    static double ssig2factor = 1.0/(1+_scatterfrac*_scatterfrac);
+    vfactor = svfactor;
+    sig2factor = ssig2factor;
+  }
+
   double
     DetMaterial::dEdx(double mom,dedxtype type,double mass) const {
       if(mom>0.0){
+        MOMTABLE::VALUES vals;
+        auto tab = table(mass);
+        if(tab != 0 && tab->interpolate(mom,vals))
+          return type == loss ? vals[dedxlossfun] : vals[dedxdepositfun];
         double Eexc2 = _eexc*_eexc ;
 
         // New energy loss implementation
@@ -189,9 +202,12 @@ namespace MatEnv {
   //from https://pdg.lbl.gov/2019/reviews/rpp2018-rev-passage-particles-matter.pdf
   double DetMaterial::energyLoss(double mom, double pathlen, double mass) const {
     if(mom>0.0){
-      double beta  = particleBeta(mom,mass) ;
-      double xi = eloss_xi(beta, pathlen);
-      double deltap = energyLossMPV(mom,pathlen,mass);
+      double deltap, xi;
+      if(!tabulatedLoss(mom,pathlen,mass,deltap,xi)){
+        double beta  = particleBeta(mom,mass) ;
+        xi = eloss_xi(beta, pathlen);
+        deltap = energyLossMPV(mom,pathlen,mass);
+      }
       //if using mean calculated from the Moyal Dist. Approx: (see end of file for more information)
       if(_elossmode == moyalmean) {
         return moyalMean(deltap, xi);
@@ -202,12 +218,15 @@ namespace MatEnv {
   }
 
   double DetMaterial::energyLossMPV(double mom, double pathlen, double mass) const {
+    double deltap, xi;
+    if(mom>0.0 && tabulatedLoss(mom,pathlen,mass,deltap,xi))
+      return deltap;
     if(mom>0.0){
       //taking positive lengths
       pathlen = fabs(pathlen) ;
 
       // New energy loss implementation
-      double gamma2,beta2,bg2,delta, deltap, sh, xi;
+      double gamma2,beta2,bg2,delta, sh;
       double beta  = particleBeta(mom,mass) ;
       double gamma = particleGamma(mom,mass) ;
       double j = 0.200 ;
@@ -237,6 +256,188 @@ namespace MatEnv {
       return 0.0;
   }
 
+  // the MPV energy loss is -xi*(mpvFactor + log(xi*beta^2/eexc)), where the first term depends only on the momentum
+  double DetMaterial::mpvFactor(double mom, double mass) const {
+    double beta  = particleBeta(mom,mass) ;
+    double gamma = particleGamma(mom,mass) ;
+    double j = 0.200 ;
+    double beta2 = beta*beta ;
+    double bg2 = beta2*gamma*gamma ;
+    return log(2.*e_mass_*bg2/_eexc) - log(beta2) - beta2 + j - densityCorrection(bg2) - shellCorrection(bg2, gamma-1);
+  }
+
+  void DetMaterial::tabulate(double mass, double pmin, double pmax, double tolerance) {
+    // set the existing tables aside while building the new one, so it is built from the analytic functions.  Any existing table for this mass is replaced
+    auto tables = std::move(_tables);
+    _tables.clear();
+    tables.erase(std::remove_if(tables.begin(),tables.end(),[mass](auto const& tab) { return sameMass(tab.first,mass); }),tables.end());
+    auto func = [this,mass](double mom, MOMTABLE::VALUES& vals) {
+      vals[mpvfun] = mpvFactor(mom,mass);
+      vals[dedxlossfun] = dEdx(mom,loss,mass);
+      vals[dedxdepositfun] = dEdx(mom,deposit,mass);
+    };
+    tables.emplace_back(mass,MOMTABLE(pmin,pmax,tolerance/lossMargin(),func));
+    _tables = std::move(tables);
+  }
+
+  std::vector<double> DetMaterial::tabulatedMasses() const {
+    std::vector<double> masses;
+    for(auto const& tab : _tables) masses.push_back(tab.first);
+    return masses;
+  }
+
+  DetMaterial::MOMTABLE const* DetMaterial::findTable(double mass) const {
+    for(auto const& tab : _tables) if(sameMass(tab.first,mass)) return &tab.second;
+    return 0;
+  }
+
+  DetMaterial::MOMTABLE const* DetMaterial::table(double mass) const {
+    if(_tables.empty())return 0;
+    auto tab = findTable(mass);
+    if(tab == 0 && !_untabulated.load(std::memory_order_relaxed) && !_untabulated.exchange(true,std::memory_order_relaxed)){
+      ErrMsg( warning ) << "DetMaterial " << _name << ": no interpolation table for mass " << mass
+        << ", using the analytic energy loss calculations" << endmsg;
+    }
+    return tab;
+  }
+
+  bool DetMaterial::tabulatedLoss(double mom, double pathlen, double mass, double& deltap, double& xi) const {
+    MOMTABLE::VALUES vals;
+    auto tab = table(mass);
+    if(tab == 0 || !tab->interpolate(mom,vals))return false;
+    // the log term is split as in the batch function, so both make the same choice
+    double kfactor = _dgev*_za*_density;
+    double mpv = vals[mpvfun] + log(kfactor/_eexc) + log(fabs(pathlen));
+    if(!tabulatedLossAccurate(tab,vals[mpvfun],mpv))return false;
+    xi = kfactor*fabs(pathlen)*(1.0 + mass*mass/(mom*mom));
+    deltap = -xi*mpv;
+    return true;
+  }
+
+  //
+  // batch functions.  The inputs are processed in fixed-size blocks.  The logarithms are computed in their own loop: these are
+  // libm calls, which the compiler can't vectorize (glibc only provides vector variants under -ffast-math).  The remaining loops
+  // are branch-free arithmetic, which does vectorize: the density and shell corrections are computed for both of their regimes and
+  // selected, and non-positive momenta (which give non-finite intermediate values) are masked at the end
+  //
+  constexpr size_t batchsize = 32;
+
+  void DetMaterial::energyLoss(double const* mom, double const* pathlen, size_t n, double mass, double* eloss) const {
+    constexpr static double moyalmeanfactor = 0.57721566490153286 + M_LN2 ; // see moyalMean
+    double mass2 = mass*mass;
+    double kfactor = _dgev*_za*_density;
+    double logkfactor = log(kfactor/_eexc);
+    double vals[batchsize], xi[batchsize], mpv[batchsize];
+    bool exact[batchsize];
+    auto tab = table(mass);
+    if(tab != 0){
+      // tabulated: the table lookup is per-element, the rest is arithmetic.  Elements outside the table use the scalar function
+      MOMTABLE::VALUES tvals;
+      for(size_t i0=0; i0 < n; i0 += batchsize){
+        size_t nb = std::min(batchsize,n-i0);
+        double const* bmom = mom + i0;
+        double const* bpath = pathlen + i0;
+        double* bout = eloss + i0;
+        for(size_t i=0; i < nb; ++i){
+          exact[i] = !(bmom[i] > 0.0 && tab->interpolate(bmom[i],tvals));
+          vals[i] = exact[i] ? 0.0 : tvals[mpvfun];
+        }
+        for(size_t i=0; i < nb; ++i) bout[i] = log(fabs(bpath[i]));
+        for(size_t i=0; i < nb; ++i){
+          xi[i] = kfactor*fabs(bpath[i])*(1.0 + mass2/(bmom[i]*bmom[i]));
+          mpv[i] = vals[i] + logkfactor + bout[i];
+          bout[i] = -xi[i]*mpv[i];
+        }
+        if(_elossmode == moyalmean){
+          for(size_t i=0; i < nb; ++i) bout[i] = -(fabs(bout[i]) + xi[i]*moyalmeanfactor);
+        }
+        for(size_t i=0; i < nb; ++i) if(exact[i] || !tabulatedLossAccurate(tab,vals[i],mpv[i])) bout[i] = energyLoss(bmom[i],bpath[i],mass);
+      }
+      return;
+    }
+    double j = 0.200 ;
+    double mpvnorm = 2.*e_mass_/(_eexc*_eexc);
+    // density correction constants: below x0 the correction is delta0*10^(2(x-x0)) = delta0*10^(-2x0)*bg2
+    double dlow = _delta0 > 0 ? _delta0*pow(10.0,-2*_x0) : 0.0;
+    // shell correction constants: below bg2lim the correction is the value at bg2lim scaled by log(tau/taul)/log(taulim/taul)
+    double sh0 = (*_shellCorrectionVector)[0], sh1 = (*_shellCorrectionVector)[1], sh2 = (*_shellCorrectionVector)[2];
+    double shlow = (sh0 + sh1/bg2lim)/bg2lim/log(taulim/_taul);
+    // local copies of the members, so the compiler knows the output doesn't alias them
+    double x0(_x0), x1(_x1), bigc(_bigc), afactor(_afactor), mpower(_mpower), taul(_taul);
+    double bg2[batchsize], beta2[batchsize], tau[batchsize], lbg2[batchsize], ltau[batchsize], dpow[batchsize];
+    for(size_t i0=0; i0 < n; i0 += batchsize){
+      size_t nb = std::min(batchsize,n-i0);
+      double const* bmom = mom + i0;
+      double const* bpath = pathlen + i0;
+      double* bout = eloss + i0;
+      // kinematics
+      for(size_t i=0; i < nb; ++i){
+        double p2 = bmom[i]*bmom[i];
+        beta2[i] = p2/(p2 + mass2);
+        bg2[i] = p2/mass2;
+        tau[i] = sqrt(p2 + mass2)/mass - 1.0;
+        xi[i] = kfactor*fabs(bpath[i])/beta2[i];
+      }
+      // transcendental functions
+      for(size_t i=0; i < nb; ++i){
+        lbg2[i] = log(bg2[i]);
+        ltau[i] = log(tau[i]/taul);
+        bout[i] = log(mpvnorm*bg2[i]*xi[i]);
+        double x = lbg2[i]/twoln10;
+        dpow[i] = x < x1 ? pow(x1 - x, mpower) : 0.0;
+      }
+      // corrections and most probable energy loss
+      for(size_t i=0; i < nb; ++i){
+        double x = lbg2[i]/twoln10;
+        double deltalow = dlow*bg2[i];
+        double deltahigh = lbg2[i] - bigc + afactor*dpow[i];
+        double delta = x < x0 ? deltalow : deltahigh;
+        double invbg2 = 1.0/bg2[i];
+        double shhigh = invbg2*(sh0 + invbg2*(sh1 + invbg2*sh2));
+        double sh = bg2[i] > bg2lim ? shhigh : shlow*ltau[i];
+        bout[i] = -xi[i]*(bout[i] - beta2[i] + j - delta - sh);
+      }
+      if(_elossmode == moyalmean){
+        for(size_t i=0; i < nb; ++i) bout[i] = -(fabs(bout[i]) + xi[i]*moyalmeanfactor);
+      }
+      for(size_t i=0; i < nb; ++i) bout[i] = bmom[i] > 0.0 ? bout[i] : 0.0;
+    }
+  }
+
+  void DetMaterial::energyLossVar(double const* mom, double const* pathlen, size_t n, double mass, double* elossvar) const {
+    double mass2 = mass*mass;
+    constexpr static double pisqrt2 = M_PI/M_SQRT2 ; // see energyLossRMS
+    double kfactor = pisqrt2*_dgev*_za*_density;
+    for(size_t i=0; i < n; ++i){
+      double rms = kfactor*fabs(pathlen[i])*(1.0 + mass2/(mom[i]*mom[i]));
+      elossvar[i] = rms*rms;
+    }
+    for(size_t i=0; i < n; ++i) elossvar[i] = mom[i] > 0.0 ? elossvar[i] : 0.0;
+  }
+
+  void DetMaterial::scatterAngleVar(double const* mom, double const* pathlen, size_t n, double mass, double* scatvar) const {
+    double mass2 = mass*mass;
+    double vfactor, sig2factor;
+    scatterFactors(vfactor,sig2factor);
+    double chic2[batchsize], v[batchsize];
+    for(size_t i0=0; i0 < n; i0 += batchsize){
+      size_t nb = std::min(batchsize,n-i0);
+      double const* bmom = mom + i0;
+      double const* bpath = pathlen + i0;
+      double* bout = scatvar + i0;
+      for(size_t i=0; i < nb; ++i){
+        double invmom2 = 1.0/(bmom[i]*bmom[i]);
+        double invb2 = 1.0 + mass2*invmom2;
+        chic2[i] = _chic2*fabs(bpath[i])*_density*invb2*invmom2;
+        double chia2 = _chia2_1*(1.0 + _chia2_2*invb2)*invmom2;
+        v[i] = vfactor*chic2[i]/chia2;
+      }
+      for(size_t i=0; i < nb; ++i) bout[i] = log(1+v[i]);
+      for(size_t i=0; i < nb; ++i) bout[i] = std::max(0.0,sig2factor*chic2[i]*( (1+v[i])*bout[i]/v[i] - 1));
+      for(size_t i=0; i < nb; ++i) bout[i] = bmom[i] > 0.0 ? bout[i] : 1.0;
+    }
+  }
+
   //////////////////////////////////////////////////////////
 
   //// Calculate Moyal mean
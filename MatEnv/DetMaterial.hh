@@ -18,11 +18,13 @@
 //  Babar includes
 //
 #include "KinKal/MatEnv/MtrPropObj.hh"
+#include "KinKal/MatEnv/OctaveTable.hh"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <math.h>
 #include <algorithm>
+#include <atomic>
 
 namespace MatEnv {
   class DetMaterial{
@@ -83,6 +85,13 @@ namespace MatEnv {
         return sarms*sarms;
       }
       double highlandSigma(double mom,double pathlen, double mass) const;
+      //
+      // Batch versions of the above, evaluated for n (momentum, pathlen) pairs and 1 mass hypothesis.  The inputs are processed
+      // in fixed-size blocks, separating the logarithms and table lookups (scalar calls) from the branch-free arithmetic, which
+      // vectorizes with the MatEnv release flags (see CMakeLists.txt).  Results agree with the scalar functions to rounding
+      void energyLoss(double const* mom, double const* pathlen, size_t n, double mass, double* eloss) const;
+      void energyLossVar(double const* mom, double const* pathlen, size_t n, double mass, double* elossvar) const;
+      void scatterAngleVar(double const* mom, double const* pathlen, size_t n, double mass, double* scatvar) const;
 
       static double particleEnergy(double mom,double mass) {
         return sqrt(pow(mom,2)+pow(mass,2)); }
@@ -121,6 +130,20 @@ namespace MatEnv {
       // by more than the given tolerance (fraction).  This is an _approximate_
       // function, based on a crude model of dE/dx.
       static double maxStepdEdx(double mom,double mass, double dEdx,double tol=0.05);
+      //
+      // Replace the analytic energy loss and dEdx calculations for the given mass hypothesis by interpolation tables over
+      // the given momentum range.  The tolerance bounds the relative interpolation error of dEdx and of mpvFactor (see OctaveTable).
+      // The MPV loss is -xi*(mpvFactor + log(xi*beta^2/eexc)), and in thin layers (xi*beta^2 < eexc) the log term partly cancels mpvFactor,
+      // which amplifies its error.  The table is only used for the loss where the amplified error is within the tolerance, so the tolerance
+      // also bounds the relative error of energyLoss and energyLossMPV.  This must be called before the material is shared between threads.
+      // Tables are matched to the mass of a calculation within a relative tolerance (massTolerance()).  Calculations for other masses
+      // use the analytic functions: the first time that happens a warning is logged
+      void tabulate(double mass, double pmin, double pmax, double tolerance);
+      bool tabulated(double mass) const { return findTable(mass) != 0; }
+      std::vector<double> tabulatedMasses() const;
+      static constexpr double massTolerance() { return 1.0e-9; }
+      // momentum-dependent factor of the most probable energy loss, which is tabulated
+      double mpvFactor(double mom,double mass) const;
     protected:
       //
       //  Constants used in material calculations
@@ -171,6 +194,24 @@ namespace MatEnv {
       double _chia2_1;
       double _chia2_2;
 
+      // interpolation tables: the MPV factor and dEdx (loss and deposit) vs momentum, per mass hypothesis
+      enum tablefunction {mpvfun=0, dedxlossfun, dedxdepositfun, ntablefun};
+      using MOMTABLE = OctaveTable<ntablefun>;
+      std::vector<std::pair<double,MOMTABLE>> _tables;
+      mutable std::atomic<bool> _untabulated{false}; // whether a calculation for an untabulated mass was requested
+      static bool sameMass(double m1, double m2) { return fabs(m1-m2) <= massTolerance()*std::max(fabs(m1),fabs(m2)); }
+      MOMTABLE const* findTable(double mass) const;
+      MOMTABLE const* table(double mass) const; // as findTable, but warns if there's no table for this mass
+      bool tabulatedLoss(double mom,double pathlen,double mass,double& deltap,double& xi) const;
+      // Tables are built to the requested tolerance divided by this margin, so the energy loss can use them where the cancellation amplifies
+      // the mpvFactor error by up to this factor (thin gas layers)
+      static constexpr double lossMargin() { return 4.0; }
+      // whether the table error of mpvFactor (fval), amplified by cancellation in the MPV factor (mpv), is within the requested tolerance
+      static bool tabulatedLossAccurate(MOMTABLE const* tab, double fval, double mpv) {
+        return tab->maxError()*fabs(fval) <= lossMargin()*tab->tolerance()*fabs(mpv); }
+      // factors of the Dahl-Lynch scattering formula
+      void scatterFactors(double& vfactor, double& sig2factor) const;
+
     public:
       // baseic accessors
       double ZA()const {return _za;}
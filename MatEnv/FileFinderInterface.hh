@@ -14,6 +14,8 @@ namespace MatEnv {
       virtual std::string matElmDictionaryFileName() const = 0;
       virtual std::string matIsoDictionaryFileName() const = 0;
       virtual std::string matMtrDictionaryFileName() const = 0;
+      // Precompiled binary image of the lists (see MatCatalog).  If empty or missing, the lists are parsed
+      virtual std::string matCatalogFileName() const { return std::string(); }
 
       // Find the specified file in the standard search path.
       virtual std::string findFile( std::string const& ) const = 0;
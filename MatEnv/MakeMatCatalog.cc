@@ -0,0 +1,55 @@
+//
+// Compile the isotope, element and material text lists into a binary MatCatalog image, which is then used instead
+// of parsing the text lists.  By default the image is written where SimpleFileFinder looks for it
+//
+#include "KinKal/MatEnv/MatCatalog.hh"
+#include "KinKal/MatEnv/SimpleFileFinder.hh"
+
+#include <iostream>
+#include <stdio.h>
+#include <getopt.h>
+#include <string>
+
+using namespace MatEnv;
+using namespace std;
+
+void print_usage() {
+  printf("Usage: MakeMatCatalog --output s\n");
+}
+
+int main(int argc, char **argv) {
+  string output;
+  static struct option long_options[] = {
+    {"output",     required_argument, 0, 'o'  },
+    {NULL, 0,0,0}
+  };
+  int long_index =0;
+  int opt;
+  while ((opt = getopt_long_only(argc, argv,"",
+          long_options, &long_index )) != -1) {
+    switch (opt) {
+      case 'o' : output = string(optarg);
+                 break;
+      default: print_usage();
+               exit(EXIT_FAILURE);
+    }
+  }
+  SimpleFileFinder sfinder;
+  if(output.empty())output = sfinder.matCatalogFileName();
+  MatIsotopeList isolist(sfinder.matIsoDictionaryFileName());
+  MatElementList elmlist(sfinder.matElmDictionaryFileName());
+  MatMaterialList mtrlist(sfinder.matMtrDictionaryFileName());
+  auto srcs = MatCatalog::sources(sfinder);
+  MatCatalog::write(output,*isolist.getIsotopeVector(),*elmlist.getElementVector(),*mtrlist.getMaterialVector(),srcs);
+  // verify the image can be read back
+  MatCatalog catalog(output,srcs.hash);
+  if(!catalog.valid() || catalog.nIsotopes() != isolist.getIsotopeVector()->size()
+      || catalog.nElements() != elmlist.getElementVector()->size()
+      || catalog.nMaterials() != mtrlist.getMaterialVector()->size()){
+    cout << "Failed to verify " << output << endl;
+    return EXIT_FAILURE;
+  }
+  cout << "Wrote " << catalog.nIsotopes() << " isotopes, " << catalog.nElements() << " elements and "
+    << catalog.nMaterials() << " materials to " << output << endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,368 @@
+#include "KinKal/MatEnv/MatCatalog.hh"
+#include "KinKal/MatEnv/ErrLog.hh"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <iterator>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MatEnv {
+  namespace {
+    // image layout: header, then fixed-size record sections (8-byte aligned), then the string table.
+    // Names are stored as offsets into the string table of null-terminated strings
+    constexpr char magic[8] = {'K','K','M','A','T','C','A','T'};
+    constexpr uint32_t byteorder = 0x01020304;
+    struct Header {
+      char magic[8];
+      uint32_t version, byteorder;
+      uint64_t size; // total image size
+      uint64_t srchash; // hash of the source text lists
+      uint64_t srcsizes[3]; // sizes and modification times of the source text lists
+      int64_t srcmtimes[3];
+      uint64_t nisotopes, nelements, nmaterials, ncomponents, nchars;
+      uint64_t isotopes, elements, materials, components, strings; // section offsets
+    };
+    struct IsotopeRecord {
+      uint32_t name;
+      int32_t z, n;
+      uint32_t pad;
+      double a;
+    };
+    struct ElementRecord {
+      uint32_t name, symbol;
+      int32_t z, nisotopes; // isotopes are stored as components
+      uint64_t first; // first component
+      double a;
+    };
+    struct MaterialRecord {
+      uint32_t name, state;
+      int32_t ncomp; // signed as in MatMaterialObj: < 0 for numbers of atoms
+      uint32_t pad;
+      uint64_t first; // first component
+      double density, zeff, aeff, radlen, intlen, refindex, temperature, pressure, tcut;
+    };
+    struct ComponentRecord {
+      double weight;
+      uint32_t name;
+      int32_t iflg;
+    };
+    static_assert(sizeof(IsotopeRecord)%8 == 0 && sizeof(ElementRecord)%8 == 0 &&
+        sizeof(MaterialRecord)%8 == 0 && sizeof(ComponentRecord)%8 == 0, "MatCatalog records must be 8-byte aligned");
+
+    // FNV-1a hash, continuing from a previous value
+    uint64_t fnv1a(char const* data, size_t nbytes, uint64_t hash = 0xcbf29ce484222325ULL) {
+      for(size_t ibyte=0; ibyte < nbytes; ++ibyte){
+        hash ^= static_cast<unsigned char>(data[ibyte]);
+        hash *= 0x100000001b3ULL;
+      }
+      return hash;
+    }
+
+    uint64_t align(uint64_t offset) { return (offset+7) & ~uint64_t(7); }
+    template <class T> T const* section(void const* base, uint64_t offset) {
+      return reinterpret_cast<T const*>(static_cast<char const*>(base) + offset);
+    }
+
+    // accumulate the string table
+    class StringTable {
+      public:
+        uint32_t add(std::string const& str) {
+          uint32_t offset = chars_.size();
+          chars_.insert(chars_.end(),str.begin(),str.end());
+          chars_.push_back('\0');
+          return offset;
+        }
+        std::vector<char> const& chars() const { return chars_; }
+      private:
+        std::vector<char> chars_;
+    };
+
+    // check the header and that all offsets are inside the image
+    bool validImage(void const* base, size_t size) {
+      if(size < sizeof(Header))return false;
+      auto const& header = *section<Header>(base,0);
+      if(memcmp(header.magic,magic,sizeof(magic)) != 0 || header.version != MatCatalog::version()
+          || header.byteorder != byteorder || header.size != size)return false;
+      auto inside = [size](uint64_t offset, uint64_t count, uint64_t recsize) {
+        return offset%8 == 0 && offset <= size && count <= (size-offset)/recsize; };
+      if(!(inside(header.isotopes,header.nisotopes,sizeof(IsotopeRecord)) &&
+            inside(header.elements,header.nelements,sizeof(ElementRecord)) &&
+            inside(header.materials,header.nmaterials,sizeof(MaterialRecord)) &&
+            inside(header.components,header.ncomponents,sizeof(ComponentRecord)) &&
+            inside(header.strings,header.nchars,1)))return false;
+      if(header.nchars == 0 || section<char>(base,header.strings)[header.nchars-1] != '\0')return false;
+      auto validname = [&header](uint32_t name) { return name < header.nchars; };
+      auto validcomps = [&header,&validname](uint64_t first, uint64_t ncomp, void const* base) {
+        if(first > header.ncomponents || ncomp > header.ncomponents-first)return false;
+        auto comps = section<ComponentRecord>(base,header.components);
+        for(uint64_t icomp=first; icomp < first+ncomp; ++icomp) if(!validname(comps[icomp].name))return false;
+        return true;
+      };
+      auto isos = section<IsotopeRecord>(base,header.isotopes);
+      for(uint64_t iiso=0; iiso < header.nisotopes; ++iiso) if(!validname(isos[iiso].name))return false;
+      auto elms = section<ElementRecord>(base,header.elements);
+      for(uint64_t ielm=0; ielm < header.nelements; ++ielm){
+        auto const& elm = elms[ielm];
+        if(!(validname(elm.name) && validname(elm.symbol) && elm.nisotopes >= 0 && validcomps(elm.first,elm.nisotopes,base)))return false;
+      }
+      auto mtrs = section<MaterialRecord>(base,header.materials);
+      for(uint64_t imtr=0; imtr < header.nmaterials; ++imtr){
+        auto const& mtr = mtrs[imtr];
+        if(!(validname(mtr.name) && validname(mtr.state) && validcomps(mtr.first,std::abs(mtr.ncomp),base)))return false;
+      }
+      return true;
+    }
+  }
+
+  MatCatalog::MatCatalog(std::string const& filename, uint64_t srchash) : base_(0), size_(0) {
+    map(filename);
+    if(valid() && srchash != 0 && sourceHash() != srchash){
+      ErrMsg( warning ) << "MatCatalog: " << filename << " is stale (the material lists have changed since it was compiled), ignoring it."
+        << " Rerun MakeMatCatalog" << endmsg;
+      release();
+    }
+  }
+
+  MatCatalog::MatCatalog(FileFinderInterface const& fileFinder, bool checkhash) : base_(0), size_(0) {
+    std::string filename = fileFinder.matCatalogFileName();
+    map(filename);
+    if(!valid())return;
+    // compare the file stamps first: these are cheap.  Only hash the lists if the stamps can't decide
+    Sources current = sources(fileFinder,false);
+    Sources image = sources();
+    bool stale = current.sizes != image.sizes;
+    if(!stale && (checkhash || current.mtimes != image.mtimes)){
+      current.hash = sourceHash(fileFinder);
+      if(current.hash == 0)
+        ErrMsg( warning ) << "MatCatalog: the material lists can't be read, so " << filename << " can't be checked against them" << endmsg;
+      else
+        stale = current.hash != image.hash;
+    }
+    if(stale){
+      ErrMsg( warning ) << "MatCatalog: " << filename << " is stale (the material lists have changed since it was compiled), ignoring it."
+        << " Rerun MakeMatCatalog" << endmsg;
+      release();
+    }
+  }
+
+  void MatCatalog::map(std::string const& filename) {
+    if(filename.empty())return;
+    int fd = open(filename.c_str(),O_RDONLY);
+    if(fd < 0)return; // no image: not an error
+    struct stat st;
+    if(fstat(fd,&st) == 0 && st.st_size > 0){
+      void* base = mmap(0,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+      if(base != MAP_FAILED){
+        if(validImage(base,st.st_size)){
+          base_ = base;
+          size_ = st.st_size;
+        } else
+          munmap(base,st.st_size);
+      }
+    }
+    close(fd);
+    if(base_ == 0)
+      ErrMsg( warning ) << "MatCatalog: " << filename << " is not a valid version " << version()
+        << " material catalog image, ignoring it" << endmsg;
+  }
+
+  void MatCatalog::release() {
+    if(base_ != 0)munmap(const_cast<void*>(base_),size_);
+    base_ = 0;
+    size_ = 0;
+  }
+
+  MatCatalog::Sources MatCatalog::sources() const {
+    Sources retval{{0,0,0},{0,0,0},0};
+    if(valid()){
+      auto const& header = *section<Header>(base_,0);
+      for(size_t ifile=0; ifile < 3; ++ifile){
+        retval.sizes[ifile] = header.srcsizes[ifile];
+        retval.mtimes[ifile] = header.srcmtimes[ifile];
+      }
+      retval.hash = header.srchash;
+    }
+    return retval;
+  }
+
+  MatCatalog::Sources MatCatalog::sources(FileFinderInterface const& fileFinder, bool hash) {
+    Sources retval{{0,0,0},{0,0,0},0};
+    std::array<std::string,3> filenames = {fileFinder.matIsoDictionaryFileName(),fileFinder.matElmDictionaryFileName(),fileFinder.matMtrDictionaryFileName()};
+    for(size_t ifile=0; ifile < filenames.size(); ++ifile){
+      struct stat st;
+      if(stat(filenames[ifile].c_str(),&st) == 0){
+        retval.sizes[ifile] = st.st_size;
+        retval.mtimes[ifile] = int64_t(st.st_mtim.tv_sec)*1000000000 + st.st_mtim.tv_nsec;
+      }
+    }
+    if(hash){
+      retval.hash = fnv1a(0,0);
+      for(auto const& filename : filenames){
+        std::ifstream in(filename,std::ios::binary);
+        if(!in.good()){
+          retval.hash = 0;
+          return retval;
+        }
+        std::string bytes((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+        retval.hash = fnv1a(bytes.data(),bytes.size(),retval.hash);
+        retval.hash = fnv1a("",1,retval.hash); // separate the files
+      }
+      if(retval.hash == 0)retval.hash = 1; // 0 is reserved for 'unknown'
+    }
+    return retval;
+  }
+
+  MatCatalog::~MatCatalog() {
+    release();
+  }
+
+  size_t MatCatalog::nIsotopes() const { return valid() ? section<Header>(base_,0)->nisotopes : 0; }
+  size_t MatCatalog::nElements() const { return valid() ? section<Header>(base_,0)->nelements : 0; }
+  size_t MatCatalog::nMaterials() const { return valid() ? section<Header>(base_,0)->nmaterials : 0; }
+
+  char const* MatCatalog::chars(uint32_t offset) const {
+    return section<char>(base_,section<Header>(base_,0)->strings) + offset;
+  }
+
+  std::unique_ptr<MatIsotopeList> MatCatalog::isotopeList() const {
+    if(!valid())throw std::invalid_argument("Invalid MatCatalog");
+    auto const& header = *section<Header>(base_,0);
+    auto isos = section<IsotopeRecord>(base_,header.isotopes);
+    std::vector<MatIsotopeObj*> isovec;
+    isovec.reserve(header.nisotopes);
+    for(uint64_t iiso=0; iiso < header.nisotopes; ++iiso){
+      auto const& iso = isos[iiso];
+      isovec.push_back(new MatIsotopeObj(chars(iso.name),iso.z,iso.n,iso.a));
+    }
+    return std::make_unique<MatIsotopeList>(isovec);
+  }
+
+  std::unique_ptr<MatElementList> MatCatalog::elementList() const {
+    if(!valid())throw std::invalid_argument("Invalid MatCatalog");
+    auto const& header = *section<Header>(base_,0);
+    auto elms = section<ElementRecord>(base_,header.elements);
+    auto comps = section<ComponentRecord>(base_,header.components);
+    std::vector<MatElementObj*> elmvec;
+    elmvec.reserve(header.nelements);
+    for(uint64_t ielm=0; ielm < header.nelements; ++ielm){
+      auto const& elm = elms[ielm];
+      MatElementObj* elmObj = new MatElementObj();
+      elmObj->setName(chars(elm.name));
+      elmObj->setSymbol(chars(elm.symbol));
+      elmObj->setZeff(elm.z);
+      elmObj->setAeff(elm.a);
+      elmObj->setNbrIsotope(elm.nisotopes);
+      for(int32_t iiso=0; iiso < elm.nisotopes; ++iiso){
+        auto const& comp = comps[elm.first+iiso];
+        elmObj->setWeight(comp.weight);
+        elmObj->setIsotopeName(chars(comp.name));
+      }
+      elmvec.push_back(elmObj);
+    }
+    return std::make_unique<MatElementList>(elmvec);
+  }
+
+  std::unique_ptr<MatMaterialList> MatCatalog::materialList() const {
+    if(!valid())throw std::invalid_argument("Invalid MatCatalog");
+    auto const& header = *section<Header>(base_,0);
+    auto mtrs = section<MaterialRecord>(base_,header.materials);
+    auto comps = section<ComponentRecord>(base_,header.components);
+    std::vector<MatMaterialObj*> mtrvec;
+    mtrvec.reserve(header.nmaterials);
+    for(uint64_t imtr=0; imtr < header.nmaterials; ++imtr){
+      auto const& mtr = mtrs[imtr];
+      MatMaterialObj* matObj = new MatMaterialObj();
+      matObj->setName(chars(mtr.name));
+      matObj->setDensity(mtr.density);
+      matObj->setZeff(mtr.zeff);
+      matObj->setAeff(mtr.aeff);
+      matObj->setNbrComp(mtr.ncomp);
+      for(int32_t icomp=0; icomp < std::abs(mtr.ncomp); ++icomp){
+        auto const& comp = comps[mtr.first+icomp];
+        matObj->setIflg(comp.iflg);
+        matObj->setWeight(comp.weight);
+        matObj->setCompName(chars(comp.name));
+      }
+      matObj->setRadLength(mtr.radlen);
+      matObj->setIntLength(mtr.intlen);
+      matObj->setRefIndex(mtr.refindex);
+      matObj->setTemperature(mtr.temperature);
+      matObj->setPressure(mtr.pressure);
+      matObj->setState(chars(mtr.state));
+      matObj->setTcut(mtr.tcut);
+      mtrvec.push_back(matObj);
+    }
+    return std::make_unique<MatMaterialList>(mtrvec);
+  }
+
+  void MatCatalog::write(std::string const& filename,
+      std::vector<MatIsotopeObj*> const& isotopes,
+      std::vector<MatElementObj*> const& elements,
+      std::vector<MatMaterialObj*> const& materials,
+      Sources const& srcs) {
+    StringTable strings;
+    std::vector<IsotopeRecord> isos;
+    std::vector<ElementRecord> elms;
+    std::vector<MaterialRecord> mtrs;
+    std::vector<ComponentRecord> comps;
+    for(auto const* iso : isotopes)
+      isos.push_back(IsotopeRecord{strings.add(iso->getName()),iso->getZ(),iso->getN(),0,iso->getA()});
+    for(auto const* elm : elements){
+      elms.push_back(ElementRecord{strings.add(elm->getName()),strings.add(elm->getSymbol()),
+          elm->getZeff(),elm->getNbrIsotope(),comps.size(),elm->getAeff()});
+      for(int iiso=0; iiso < elm->getNbrIsotope(); ++iiso)
+        comps.push_back(ComponentRecord{elm->getWeight(iiso),strings.add(elm->getIsotopeName(iiso)),0});
+    }
+    for(auto const* mtr : materials){
+      mtrs.push_back(MaterialRecord{strings.add(mtr->getName()),strings.add(mtr->getState()),mtr->getNbrComp(),0,comps.size(),
+          mtr->getDensity(),mtr->getZeff(),mtr->getAeff(),mtr->getRadLength(),mtr->getIntLength(),mtr->getRefIndex(),
+          mtr->getTemperature(),mtr->getPressure(),mtr->getTcut()});
+      for(int icomp=0; icomp < std::abs(mtr->getNbrComp()); ++icomp)
+        comps.push_back(ComponentRecord{mtr->getWeight(icomp),strings.add(mtr->getCompName(icomp)),mtr->getIflg(icomp)});
+    }
+    // lay out the sections
+    Header header;
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,magic,sizeof(magic));
+    header.version = version();
+    header.byteorder = byteorder;
+    header.srchash = srcs.hash;
+    for(size_t ifile=0; ifile < 3; ++ifile){
+      header.srcsizes[ifile] = srcs.sizes[ifile];
+      header.srcmtimes[ifile] = srcs.mtimes[ifile];
+    }
+    header.nisotopes = isos.size();
+    header.nelements = elms.size();
+    header.nmaterials = mtrs.size();
+    header.ncomponents = comps.size();
+    header.nchars = strings.chars().size();
+    header.isotopes = align(sizeof(Header));
+    header.elements = align(header.isotopes + isos.size()*sizeof(IsotopeRecord));
+    header.materials = align(header.elements + elms.size()*sizeof(ElementRecord));
+    header.components = align(header.materials + mtrs.size()*sizeof(MaterialRecord));
+    header.strings = align(header.components + comps.size()*sizeof(ComponentRecord));
+    header.size = header.strings + header.nchars;
+    std::vector<char> image(header.size,0);
+    auto copy = [&image](uint64_t offset, void const* data, size_t nbytes) { if(nbytes > 0)memcpy(image.data()+offset,data,nbytes); };
+    copy(0,&header,sizeof(header));
+    copy(header.isotopes,isos.data(),isos.size()*sizeof(IsotopeRecord));
+    copy(header.elements,elms.data(),elms.size()*sizeof(ElementRecord));
+    copy(header.materials,mtrs.data(),mtrs.size()*sizeof(MaterialRecord));
+    copy(header.components,comps.data(),comps.size()*sizeof(ComponentRecord));
+    copy(header.strings,strings.chars().data(),header.nchars);
+    // write a temporary file in the same directory and rename it over the target, so processes mapping the old image keep it
+    std::string tmpname = filename + ".tmp" + std::to_string(getpid());
+    std::ofstream out(tmpname,std::ios::binary|std::ios::trunc);
+    out.write(image.data(),image.size());
+    out.close();
+    if(out.fail() || std::rename(tmpname.c_str(),filename.c_str()) != 0){
+      std::remove(tmpname.c_str());
+      throw std::runtime_error("MatCatalog: failed to write " + filename);
+    }
+  }
+}
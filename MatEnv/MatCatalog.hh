@@ -0,0 +1,73 @@
+#ifndef KinKal_MatEnv_MatCatalog
+#define KinKal_MatEnv_MatCatalog
+//
+//  Compact binary image of the isotope, element and material lists, which can be loaded by memory-mapping instead of
+//  parsing the text lists.  The image is versioned: an image with a different version, byte order, or an inconsistent
+//  layout is rejected, and the caller falls back to the text lists.  Use MakeMatCatalog to compile the text lists into
+//  an image.  The image records the sizes and modification times of the text lists it was compiled from, and a hash of
+//  their contents.  Loading compares just the sizes and times, which costs a stat per list; the lists are only hashed if
+//  those differ (eg after copying the files) or if requested.  An image which doesn't match the current lists is rejected
+//  as stale.  The dictionaries built by RecoMatFactory share a single mapping of the image.
+//
+#include "KinKal/MatEnv/MatIsotopeList.hh"
+#include "KinKal/MatEnv/MatElementList.hh"
+#include "KinKal/MatEnv/MatMaterialList.hh"
+#include "KinKal/MatEnv/FileFinderInterface.hh"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+namespace MatEnv {
+  class MatCatalog {
+    public:
+      // image format version; increment when the layout changes
+      static constexpr uint32_t version() { return 3; }
+      // identification of the isotope, element and material text lists (in that order)
+      struct Sources {
+        std::array<uint64_t,3> sizes; // file sizes
+        std::array<int64_t,3> mtimes; // modification times (ns)
+        uint64_t hash; // hash of the contents, 0 if unknown
+      };
+      // map the image in the given file.  If the file doesn't exist, isn't a valid image, or (for non-zero srchash)
+      // was compiled from different text lists, the catalog is invalid
+      explicit MatCatalog(std::string const& filename, uint64_t srchash=0);
+      // map the image found by the file finder, checking it against the text lists it finds.  If checkhash is set the
+      // lists are always hashed, otherwise only if their sizes match the image but their modification times don't
+      explicit MatCatalog(FileFinderInterface const& fileFinder, bool checkhash=false);
+      ~MatCatalog();
+      MatCatalog(MatCatalog const&) = delete;
+      MatCatalog& operator =(MatCatalog const&) = delete;
+      bool valid() const { return base_ != 0; }
+      size_t nIsotopes() const;
+      size_t nElements() const;
+      size_t nMaterials() const;
+      // create transient lists from the image; these own their objects.  The catalog must be valid
+      std::unique_ptr<MatIsotopeList> isotopeList() const;
+      std::unique_ptr<MatElementList> elementList() const;
+      std::unique_ptr<MatMaterialList> materialList() const;
+      // identification of the source text lists the image was compiled from
+      Sources sources() const;
+      uint64_t sourceHash() const { return sources().hash; }
+      // identify the isotope, element and material text lists found by the file finder.  Hashing the contents is
+      // optional.  The hash is 0 if any of them can't be read, in which case an image can't be checked
+      static Sources sources(FileFinderInterface const& fileFinder, bool hash=true);
+      static uint64_t sourceHash(FileFinderInterface const& fileFinder) { return sources(fileFinder).hash; }
+      // compile the lists into an image file, recording their source.  An existing file is replaced atomically, so
+      // processes mapping it are unaffected.  Throws on failure
+      static void write(std::string const& filename,
+          std::vector<MatIsotopeObj*> const& isotopes,
+          std::vector<MatElementObj*> const& elements,
+          std::vector<MatMaterialObj*> const& materials,
+          Sources const& srcs);
+    private:
+      void map(std::string const& filename);
+      void release();
+      char const* chars(uint32_t offset) const;
+      void const* base_; // start of the mapped image, or null if invalid
+      size_t size_; // size of the mapped image
+  };
+}
+#endif
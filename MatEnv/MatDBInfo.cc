@@ -18,74 +18,56 @@
 
 #include <string>
 #include <map>
+#include <mutex>
 namespace MatEnv {
 
-  MatDBInfo::MatDBInfo(FileFinderInterface const& interface, DetMaterial::energylossmode elossmode ) :
-    _genMatFactory(RecoMatFactory::getInstance(interface)), _elossmode(elossmode)
-  {;}
+  MatDBInfo::MatDBInfo(FileFinderInterface const& interface, DetMaterial::energylossmode elossmode,
+      std::vector<std::string> const& matNames) : MatDBInfo(interface,elossmode,TableConfig(),matNames)
+  {}
 
-  MatDBInfo::~MatDBInfo() {
-    // delete the materials
-    std::map< std::string*, DetMaterial*, PtrLess >::iterator
-      iter = _matList.begin();
-    for (; iter != _matList.end(); ++iter) {
-      delete iter->first;
-      delete iter->second;
+  MatDBInfo::MatDBInfo(FileFinderInterface const& interface, DetMaterial::energylossmode elossmode, TableConfig const& tconfig,
+      std::vector<std::string> const& matNames) : _elossmode(elossmode), _tconfig(tconfig)
+  {
+    RecoMatFactory* factory = RecoMatFactory::getInstance(interface);
+    // the factory is shared by all catalogs and builds its properties lazily, so serialize access to it
+    std::lock_guard<std::mutex> lock(factory->mutex());
+    if(matNames.empty()){
+      for(auto const& imat : *factory->materialDictionary())
+        createDetMaterial(factory,*imat.first);
+    } else {
+      for(auto const& matName : matNames){
+        if(!createDetMaterial(factory,matName))
+          ErrMsg( error ) << "MatDBInfo: Cannot find requested material " << matName
+            << "." << endmsg;
+      }
     }
-    _matList.clear();
   }
 
-  void
-    MatDBInfo::declareMaterial( const std::string& db_name,
-        const std::string& detMatName )
-    {
-      _matNameMap[detMatName] = db_name;
-      materialNames().push_back( detMatName );
-      return;
-    }
+  MatDBInfo::~MatDBInfo() {}
 
   const DetMaterial* MatDBInfo::findDetMaterial( const std::string& matName ) const
   {
-    DetMaterial* theMat;
-    std::map< std::string*, DetMaterial*, PtrLess >::const_iterator pos;
-    if ((pos = _matList.find((std::string*)&matName)) != _matList.end()) {
-      theMat = pos->second;
-    } else {
-      // first, look for aliases
-      std::string theName;
-      std::map< std::string, std::string >::const_iterator matNamePos;
-      if ((matNamePos = _matNameMap.find(matName)) != _matNameMap.end()) {
-        theName = matNamePos->second;
-        theMat = createDetMaterial( theName, matName);
-      } else {
-        //then , try to find the material name directly
-        theMat = createDetMaterial( matName, matName);
-        // if we created a new material directly, add it to the list
-        if(theMat != 0)that()->declareMaterial(matName,matName);
-      }
-    }
-    if(theMat == 0){
-      ErrMsg( error ) << "MatDBInfo: Cannot find requested material " << matName
-        << "." << endmsg;
-    }
-    return theMat;
+    auto pos = _matList.find(matName);
+    if(pos != _matList.end()) return pos->second.get();
+    ErrMsg( error ) << "MatDBInfo: Cannot find requested material " << matName
+      << "." << endmsg;
+    return 0;
   }
 
-  DetMaterial* MatDBInfo::createDetMaterial( const std::string& db_name,
-      const std::string& detMatName ) const
+  bool MatDBInfo::createDetMaterial( RecoMatFactory* factory, const std::string& db_name )
   {
-    MtrPropObj* genMtrProp;
-    DetMaterial* theMat;
-
-    genMtrProp = _genMatFactory->GetMtrProperties(db_name);
+    if(_matList.find(db_name) != _matList.end()) return true;
+    MtrPropObj* genMtrProp = factory->GetMtrProperties(db_name);
     if(genMtrProp != 0){
-      theMat = new DetMaterial( detMatName.c_str(), genMtrProp ) ;
+      auto theMat = std::make_unique<DetMaterial>( db_name.c_str(), genMtrProp );
       theMat->setEnergyLossMode(_elossmode);
-      that()->_matList[new std::string( detMatName )] = theMat;
-      return theMat;
+      for(double mass : _tconfig.masses)
+        theMat->tabulate(mass,_tconfig.pmin,_tconfig.pmax,_tconfig.tolerance);
+      _matList.emplace(db_name,std::move(theMat));
+      materialNames().push_back( db_name );
+      return true;
     } else {
-      return 0;
+      return false;
     }
   }
 }
-
@@ -4,7 +4,9 @@
 //
 // Description:
 //      Class MatDBInfo.  Implementation of MaterialInfo interface
-//      using the database.
+//      using the database.  The catalog is frozen at construction:
+//      all requested materials are built up-front, after which lookup
+//      is read-only and can be shared between threads without locking.
 //
 // Environment:
 //      Software developed for the BaBar Detector at the SLAC B-Factory.
@@ -28,6 +30,8 @@
 #include "KinKal/MatEnv/FileFinderInterface.hh"
 #include <string>
 #include <map>
+#include <memory>
+#include <vector>
 
 namespace MatEnv {
 
@@ -36,27 +40,32 @@ namespace MatEnv {
 
   class MatDBInfo : public MaterialInfo {
     public:
-      MatDBInfo(FileFinderInterface const& interface, DetMaterial::energylossmode elossmode);
+      // optional interpolation tables for the energy loss and scattering calculations (see DetMaterial::tabulate)
+      struct TableConfig {
+        std::vector<double> masses; // mass hypotheses to tabulate.  If empty, the analytic calculations are used
+        double pmin = 1.0; // momentum range (MeV/c)
+        double pmax = 1.0e4;
+        double tolerance = 1.0e-4; // maximum relative interpolation error of the tabulated functions
+      };
+      // build the catalog from the named materials, or all materials in the database if none are given
+      MatDBInfo(FileFinderInterface const& interface, DetMaterial::energylossmode elossmode,
+          std::vector<std::string> const& matNames = std::vector<std::string>());
+      MatDBInfo(FileFinderInterface const& interface, DetMaterial::energylossmode elossmode, TableConfig const& tconfig,
+          std::vector<std::string> const& matNames = std::vector<std::string>());
       virtual ~MatDBInfo();
-      //  Find the material, given the name
+      // disallow copy and assign: handles into the catalog must stay valid
+      MatDBInfo(MatDBInfo const&) = delete;
+      MatDBInfo& operator =(MatDBInfo const&) = delete;
+      //  Find the material, given the name.  This is const in the strong sense and thread-safe
       const DetMaterial* findDetMaterial( const std::string& matName ) const override;
-      // utility functions
+      DetMaterial::energylossmode energyLossMode() const { return _elossmode; }
+      TableConfig const& tableConfig() const { return _tconfig; }
     private:
-      DetMaterial* createDetMaterial( const std::string& dbName,
-          const std::string& detMatName ) const;
-      void declareMaterial( const std::string& dbName,
-          const std::string& detMatName );
-      // Cache of RecoMatFactory pointer
-      RecoMatFactory* _genMatFactory;
-      // Cache of list of materials for DetectorModel
-      std::map< std::string*, DetMaterial*, PtrLess > _matList;
-      // Map for reco- and DB material names
-      std::map< std::string, std::string > _matNameMap;
-      // function to cast-off const
-      MatDBInfo* that() const {
-        return const_cast<MatDBInfo*>(this);
-      }
+      bool createDetMaterial( RecoMatFactory* factory, const std::string& dbName );
+      // frozen list of materials, keyed by name
+      std::map< std::string, std::unique_ptr<DetMaterial>, std::less<> > _matList;
       DetMaterial::energylossmode _elossmode;
+      TableConfig _tconfig;
   };
 
 }
@@ -29,17 +29,26 @@
 // Base Class Headers --
 //----------------------
 #include "KinKal/MatEnv/MatElmDictionary.hh"
+#include "KinKal/MatEnv/MatCatalog.hh"
 #include "KinKal/MatEnv/ErrLog.hh"
 using std::fstream;
 
 namespace MatEnv {
   // Create Constructor
 
-  MatElmDictionary::MatElmDictionary(FileFinderInterface const& fileFinder ) : fileFinder_(fileFinder)
+  MatElmDictionary::MatElmDictionary(FileFinderInterface const& fileFinder ) : MatElmDictionary(fileFinder,MatCatalog(fileFinder))
+  {}
+
+  MatElmDictionary::MatElmDictionary(FileFinderInterface const& fileFinder, MatCatalog const& catalog) : fileFinder_(fileFinder)
   {
-    std::string fullPath = fileFinder_.matElmDictionaryFileName();
-    MatElementList* elmList = new MatElementList(fullPath);
-    FillElmDict(elmList);
+    // use the precompiled image if there is one, otherwise parse the text list
+    if(catalog.valid()){
+      FillElmDict(catalog.elementList().get());
+    } else {
+      std::string fullPath = fileFinder_.matElmDictionaryFileName();
+      MatElementList* elmList = new MatElementList(fullPath);
+      FillElmDict(elmList);
+    }
   }
 
   void MatElmDictionary::FillElmDict(MatElementList* elmList)
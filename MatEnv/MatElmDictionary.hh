@@ -31,6 +31,7 @@
 // Collaborating Class Headers --
 //-------------------------------
 namespace MatEnv {
+  class MatCatalog;
 
   class MatElmDictionary : public std::map<std::string*, MatElementObj*, PtrLess>
   {
@@ -39,6 +40,8 @@ namespace MatEnv {
 
       // Constructor 
       MatElmDictionary(FileFinderInterface const& interface);
+      // use an already-mapped catalog image, if it's valid, instead of mapping it again
+      MatElmDictionary(FileFinderInterface const& interface, MatCatalog const& catalog);
 
       // Destructor
       virtual ~MatElmDictionary();
@@ -29,17 +29,26 @@
 // Base Class Headers --
 //----------------------
 #include "KinKal/MatEnv/MatIsoDictionary.hh"
+#include "KinKal/MatEnv/MatCatalog.hh"
 #include "KinKal/MatEnv/ErrLog.hh"
 using std::fstream;
 namespace MatEnv {
 
   // Create Constructor
 
-  MatIsoDictionary::MatIsoDictionary(FileFinderInterface const& fileFinder ) : fileFinder_(fileFinder)
+  MatIsoDictionary::MatIsoDictionary(FileFinderInterface const& fileFinder ) : MatIsoDictionary(fileFinder,MatCatalog(fileFinder))
+  {}
+
+  MatIsoDictionary::MatIsoDictionary(FileFinderInterface const& fileFinder, MatCatalog const& catalog) : fileFinder_(fileFinder)
   {
-    std::string fullPath = fileFinder_.matIsoDictionaryFileName();
-    MatIsotopeList* mtrList = new MatIsotopeList(fullPath);
-    FillIsoDict(mtrList);
+    // use the precompiled image if there is one, otherwise parse the text list
+    if(catalog.valid()){
+      FillIsoDict(catalog.isotopeList().get());
+    } else {
+      std::string fullPath = fileFinder_.matIsoDictionaryFileName();
+      MatIsotopeList* mtrList = new MatIsotopeList(fullPath);
+      FillIsoDict(mtrList);
+    }
   }
 
   void MatIsoDictionary::FillIsoDict(MatIsotopeList* isoList)
@@ -32,6 +32,7 @@
 // Collaborating Class Headers --
 //-------------------------------
 namespace MatEnv {
+  class MatCatalog;
 
   class MatIsoDictionary : public std::map<std::string*, MatIsotopeObj*, PtrLess>
   {
@@ -40,6 +41,8 @@ namespace MatEnv {
 
       // Constructor 
       MatIsoDictionary(FileFinderInterface const& interface );
+      // use an already-mapped catalog image, if it's valid, instead of mapping it again
+      MatIsoDictionary(FileFinderInterface const& interface, MatCatalog const& catalog);
 
       // Destructor
       virtual ~MatIsoDictionary();
@@ -30,6 +30,7 @@
 // Base Class Headers --
 //----------------------
 #include "KinKal/MatEnv/MatMtrDictionary.hh"
+#include "KinKal/MatEnv/MatCatalog.hh"
 #include "KinKal/MatEnv/ErrLog.hh"
 
 using std::fstream;
@@ -37,11 +38,19 @@ namespace MatEnv {
 
   // Create Constructor
 
-  MatMtrDictionary::MatMtrDictionary(FileFinderInterface const& fileFinder) : fileFinder_(fileFinder)
+  MatMtrDictionary::MatMtrDictionary(FileFinderInterface const& fileFinder) : MatMtrDictionary(fileFinder,MatCatalog(fileFinder))
+  {}
+
+  MatMtrDictionary::MatMtrDictionary(FileFinderInterface const& fileFinder, MatCatalog const& catalog) : fileFinder_(fileFinder)
   {
-    std::string fullPath = fileFinder_.matMtrDictionaryFileName();
-    MatMaterialList* mtrList = new MatMaterialList(fullPath);
-    FillMtrDict(mtrList);
+    // use the precompiled image if there is one, otherwise parse the text list
+    if(catalog.valid()){
+      FillMtrDict(catalog.materialList().get());
+    } else {
+      std::string fullPath = fileFinder_.matMtrDictionaryFileName();
+      MatMaterialList* mtrList = new MatMaterialList(fullPath);
+      FillMtrDict(mtrList);
+    }
   }
 
   void MatMtrDictionary::FillMtrDict(MatMaterialList* mtrList)
@@ -32,6 +32,7 @@
 // Collaborating Class Headers --
 //-------------------------------
 namespace MatEnv {
+  class MatCatalog;
 
   class MatMtrDictionary : public std::map<std::string*, MatMaterialObj*, PtrLess>
   {
@@ -40,6 +41,8 @@ namespace MatEnv {
 
       // Constructor 
       MatMtrDictionary(FileFinderInterface const& interface);
+      // use an already-mapped catalog image, if it's valid, instead of mapping it again
+      MatMtrDictionary(FileFinderInterface const& interface, MatCatalog const& catalog);
 
       // Destructor
       virtual ~MatMtrDictionary();
@@ -0,0 +1,104 @@
+#ifndef KinKal_MatEnv_OctaveTable
+#define KinKal_MatEnv_OctaveTable
+//
+//  Table of functions of 1 positive variable, linearly interpolated on a grid which is uniform within each octave (power of 2)
+//  of the variable.  The bin is found from the binary exponent, so lookup doesn't evaluate any transcendental function.
+//  The relative interpolation error is sampled at the 1/4, 1/2 and 3/4 points of every bin, and multiplied by a safety factor to cover
+//  the error between those points.  The grid is refined until this is below the tolerance in every bin.  For functions whose curvature
+//  varies little within a bin (the error is then close to quadratic in the position) this bounds the interpolation error.  Bins where the
+//  tolerance can't be reached (eg across a discontinuity) are flagged, and lookup in them fails so the caller evaluates the function exactly.
+//
+#include <array>
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <stdexcept>
+#include <algorithm>
+
+namespace MatEnv {
+  template <size_t NFUN> class OctaveTable {
+    public:
+      using VALUES = std::array<double,NFUN>;
+      // tabulate func(x,VALUES&) over at least [xmin,xmax].  The grid starts with minsub bins/octave and is refined up to maxsub bins/octave
+      template <class FUNC> OctaveTable(double xmin, double xmax, double tolerance, FUNC const& func,
+          unsigned minsub=8, unsigned maxsub=1024);
+      // interpolate the functions at x.  Return false if x is outside the table or in a flagged bin
+      bool interpolate(double x, VALUES& vals) const;
+      // accessors
+      double xMin() const { return xmin_; }
+      double xMax() const { return xmax_; }
+      unsigned nSub() const { return nsub_; }
+      size_t nBins() const { return exact_.size(); }
+      size_t nFlagged() const { return std::count(exact_.begin(),exact_.end(),true); }
+      double tolerance() const { return tolerance_; }
+      double maxError() const { return maxerr_; } // maximum relative error of unflagged bins, including the safety factor
+      static constexpr double safetyFactor() { return 2.0; } // applied to the sampled error
+    private:
+      double node(size_t inode) const { return ldexp(0.5 + double(inode%nsub_)/(2.0*nsub_), iexp0_ + int(inode/nsub_)); }
+      int iexp0_; // binary exponent of the first octave
+      unsigned nsub_; // bins per octave
+      double xmin_, xmax_; // table range
+      double tolerance_; // required relative accuracy
+      std::vector<VALUES> values_; // function values at the nodes
+      std::vector<bool> exact_; // bins where the interpolation isn't accurate enough
+      double maxerr_;
+  };
+
+  template <size_t NFUN> template <class FUNC> OctaveTable<NFUN>::OctaveTable(double xmin, double xmax, double tolerance, FUNC const& func,
+      unsigned minsub, unsigned maxsub) : nsub_(std::max(minsub,1u)), tolerance_(tolerance), maxerr_(0.0) {
+    if(!(xmin > 0.0 && xmax > xmin && tolerance > 0.0))throw std::invalid_argument("Invalid OctaveTable range");
+    int iexp1;
+    frexp(xmin,&iexp0_);
+    frexp(xmax,&iexp1);
+    unsigned noct = unsigned(iexp1 - iexp0_ + 1);
+    std::vector<double> errors;
+    VALUES exact;
+    while(true){
+      size_t nbins = size_t(noct)*nsub_;
+      values_.resize(nbins+1);
+      for(size_t inode=0; inode <= nbins; ++inode) func(node(inode),values_[inode]);
+      // test the interpolation inside each bin
+      errors.assign(nbins,0.0);
+      maxerr_ = 0.0;
+      for(size_t ibin=0; ibin < nbins; ++ibin){
+        for(double frac : {0.25,0.5,0.75}){
+          func(node(ibin) + frac*(node(ibin+1)-node(ibin)),exact);
+          for(size_t ifun=0; ifun < NFUN; ++ifun){
+            double interp = values_[ibin][ifun] + frac*(values_[ibin+1][ifun]-values_[ibin][ifun]);
+            double err = safetyFactor()*fabs(interp-exact[ifun])/std::max(fabs(exact[ifun]),DBL_MIN);
+            if(!std::isfinite(err))err = DBL_MAX;
+            errors[ibin] = std::max(errors[ibin],err);
+          }
+        }
+        maxerr_ = std::max(maxerr_,errors[ibin]);
+      }
+      if(maxerr_ <= tolerance || nsub_ >= maxsub)break;
+      nsub_ *= 2;
+    }
+    // flag the bins which didn't reach the tolerance
+    exact_.resize(errors.size());
+    maxerr_ = 0.0;
+    for(size_t ibin=0; ibin < errors.size(); ++ibin){
+      exact_[ibin] = errors[ibin] > tolerance;
+      if(!exact_[ibin])maxerr_ = std::max(maxerr_,errors[ibin]);
+    }
+    xmin_ = node(0);
+    xmax_ = node(exact_.size());
+  }
+
+  template <size_t NFUN> bool OctaveTable<NFUN>::interpolate(double x, VALUES& vals) const {
+    if(!(x >= xmin_ && x < xmax_))return false;
+    int iexp;
+    double mant = frexp(x,&iexp); // x = mant*2^iexp, with 0.5 <= mant < 1
+    double u = (mant-0.5)*2.0*nsub_; // position within the octave, in bins
+    unsigned isub = std::min(unsigned(u),nsub_-1);
+    size_t ibin = size_t(iexp-iexp0_)*nsub_ + isub;
+    if(exact_[ibin])return false;
+    double frac = u - isub;
+    auto const& v0 = values_[ibin];
+    auto const& v1 = values_[ibin+1];
+    for(size_t ifun=0; ifun < NFUN; ++ifun) vals[ifun] = v0[ifun] + frac*(v1[ifun]-v0[ifun]);
+    return true;
+  }
+}
+#endif
@@ -30,6 +30,7 @@
 #include "KinKal/MatEnv/MtrPropObj.hh"
 #include "KinKal/MatEnv/MatElmDictionary.hh"
 #include "KinKal/MatEnv/MatMtrDictionary.hh"
+#include "KinKal/MatEnv/MatCatalog.hh"
 #include "KinKal/MatEnv/BbrCollectionUtils.hh"
 #include <cstdlib>
 #include <string>
@@ -39,11 +40,13 @@ namespace MatEnv {
   // Constructors
 
   RecoMatFactory::RecoMatFactory(FileFinderInterface const& interface)
-    : _theElmDict( new MatElmDictionary(interface )),
-    _theMtrDict( new MatMtrDictionary(interface ) ),
-    _theElmPropDict( new std::map< std::string*, ElmPropObj*, PtrLess >),
+    : _theElmPropDict( new std::map< std::string*, ElmPropObj*, PtrLess >),
     _theMtrPropDict( new std::map< std::string*, MtrPropObj*, PtrLess >)
   {
+    // map the precompiled catalog image (if any) once, and share it between the dictionaries
+    MatCatalog catalog(interface);
+    _theElmDict = new MatElmDictionary(interface,catalog);
+    _theMtrDict = new MatMtrDictionary(interface,catalog);
   }
 
   RecoMatFactory*
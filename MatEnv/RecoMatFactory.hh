@@ -41,6 +41,7 @@
 
 #include <string>
 #include <map>
+#include <mutex>
 
 //------------------------------------
 // Collaborating Class Declarations --
@@ -73,6 +74,10 @@ namespace MatEnv {
       std::map<std::string*, MatElementObj*, PtrLess>* elementDictionary() const 
       { return _theElmDict; }
 
+      // The Get functions above build and cache properties on demand, so they modify the factory.
+      // Callers sharing the factory between threads must hold this mutex while using it
+      std::mutex& mutex() const { return _mutex; }
+
     private:
 
       // Singleton: constructor private
@@ -83,6 +88,7 @@ namespace MatEnv {
       MatMtrDictionary* _theMtrDict;
       std::map< std::string*, ElmPropObj*, PtrLess >* _theElmPropDict;
       std::map< std::string*, MtrPropObj*, PtrLess >* _theMtrPropDict; 
+      mutable std::mutex _mutex;
   };
 }
 #endif // RECOMATFACTORY_HH
@@ -9,7 +9,8 @@ namespace MatEnv {
   SimpleFileFinder::SimpleFileFinder(std::string const& project, std::string const& dir) :
     elemlist_("ElementsList.data"),
     isolist_("IsotopesList.data"),
-    matlist_("MaterialsList.data")
+    matlist_("MaterialsList.data"),
+    catalog_("MaterialsCatalog.bin")
   {
     const char* src = getenv(project.c_str());
     if(!src) {
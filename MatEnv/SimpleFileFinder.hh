@@ -14,6 +14,7 @@ namespace MatEnv {
       virtual std::string matElmDictionaryFileName() const override { return findFile(elemlist_); }
       virtual std::string matIsoDictionaryFileName() const override { return findFile(isolist_); }
       virtual std::string matMtrDictionaryFileName() const override { return findFile(matlist_); }
+      virtual std::string matCatalogFileName() const override { return findFile(catalog_); }
       auto const& project() const { return project_; }
 
       // Find the specified file in the standard search path.
@@ -21,7 +22,7 @@ namespace MatEnv {
       // default implementation
     private:
       std::string project_;
-      std::string elemlist_, isolist_, matlist_;
+      std::string elemlist_, isolist_, matlist_, catalog_;
   };
 }
 #endif
@@ -0,0 +1,143 @@
+//
+// test that binary field map images reproduce the text maps, and time loading both
+//
+#include "KinKal/General/BFieldMapImage.hh"
+#include "KinKal/General/CylBFieldMap.hh"
+#include "KinKal/General/AxialBFieldMap.hh"
+
+#include <iostream>
+#include <fstream>
+#include <stdio.h>
+#include <getopt.h>
+#include <chrono>
+#include <iterator>
+#include <cmath>
+#include <unistd.h>
+
+#include "TRandom3.h"
+
+using namespace KinKal;
+using namespace std;
+
+void print_usage() {
+  printf("Usage: BFieldMapImage --nr i --nz i --npoints i\n");
+}
+
+int main(int argc, char **argv) {
+  using Clock = std::chrono::high_resolution_clock;
+  int nr(101), nz(601);
+  unsigned npoints(10000);
+  static struct option long_options[] = {
+    {"nr",     required_argument, 0, 'r'  },
+    {"nz",     required_argument, 0, 'z'  },
+    {"npoints",     required_argument, 0, 'n'  },
+    {NULL, 0,0,0}
+  };
+  int long_index =0;
+  int opt;
+  while ((opt = getopt_long_only(argc, argv,"",
+          long_options, &long_index )) != -1) {
+    switch (opt) {
+      case 'r' : nr = atoi(optarg);
+                 break;
+      case 'z' : nz = atoi(optarg);
+                 break;
+      case 'n' : npoints = atoi(optarg);
+                 break;
+      default: print_usage();
+               exit(EXIT_FAILURE);
+    }
+  }
+  int retval(EXIT_SUCCESS);
+  string tag = to_string(getpid());
+  string cyltext = string("BFieldMapImage_cyl_") + tag + string(".txt");
+  string cylimage = string("BFieldMapImage_cyl_") + tag + string(".bin");
+  string axtext = string("BFieldMapImage_ax_") + tag + string(".txt");
+  string aximage = string("BFieldMapImage_ax_") + tag + string(".bin");
+  // write a solenoid-like cylindrical map in the CylBMap text format
+  double r0(0.0), z0(-1500.0), dr(10.0), dz(5.0);
+  {
+    std::ofstream ofs(cyltext);
+    ofs << "grid R0=" << r0 << " Z0=" << z0 << " nR=" << nr << " nZ=" << nz << " dR=" << dr << " dZ=" << dz << " " << endl;
+    ofs << "data" << endl;
+    for(int ir=0; ir < nr; ir++){
+      for(int iz=0; iz < nz; iz++){
+        double rval = r0 + ir*dr, zval = z0 + iz*dz;
+        ofs << rval << " " << zval << " " << 0.5*1.2e-5*rval*cos(zval/1000.0) << " " << 1.0 - 1.2e-5*zval + 1e-8*rval*rval << endl;
+      }
+    }
+  }
+  // and an axial map
+  {
+    std::ofstream ofs(axtext);
+    for(int iz=0; iz < nz; iz++){
+      double zval = z0 + iz*dz;
+      ofs << zval << " " << 1.0 - 1.2e-5*zval << endl;
+    }
+  }
+  // load the text maps and convert them
+  auto start = Clock::now();
+  CylBFieldMap cyltextmap(cyltext);
+  auto stop = Clock::now();
+  double ttext = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+  BFieldMapImage::write(cylimage,cyltextmap.grid());
+  AxialBFieldMap axtextmap(axtext);
+  BFieldMapImage::write(aximage,axtextmap.zMin(),axtextmap.zMax(),axtextmap.field());
+  // load the images
+  start = Clock::now();
+  CylBFieldMap cylimagemap(cylimage);
+  stop = Clock::now();
+  double timage = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+  cout << "Cylindrical map load time (us) text " << ttext << " image " << timage << endl;
+  AxialBFieldMap aximagemap(aximage);
+  if(!BFieldMapImage::isImage(cylimage) || BFieldMapImage::isImage(cyltext)){
+    cout << "Image detection failed" << endl;
+    retval = -1;
+  }
+  // compare the fields: these must be identical
+  if(cyltextmap.zMin() != cylimagemap.zMin() || cyltextmap.zMax() != cylimagemap.zMax()
+      || cyltextmap.rMin() != cylimagemap.rMin() || cyltextmap.rMax() != cylimagemap.rMax()
+      || axtextmap.zMin() != aximagemap.zMin() || axtextmap.field() != aximagemap.field()){
+    cout << "Map extents don't match" << endl;
+    retval = -2;
+  }
+  TRandom3 tr(34567);
+  unsigned ndiff(0);
+  for(unsigned ipt=0; ipt < npoints; ipt++){
+    VEC3 pos(tr.Uniform(-800.0,800.0),tr.Uniform(-800.0,800.0),tr.Uniform(-1600.0,1600.0));
+    VEC3 vel(tr.Gaus(),tr.Gaus(),tr.Gaus());
+    if(cyltextmap.fieldVect(pos) != cylimagemap.fieldVect(pos) || cyltextmap.fieldGrad(pos) != cylimagemap.fieldGrad(pos)
+        || cyltextmap.fieldDeriv(pos,vel) != cylimagemap.fieldDeriv(pos,vel)
+        || axtextmap.fieldVect(pos) != aximagemap.fieldVect(pos)) ndiff++;
+  }
+  if(ndiff > 0){
+    cout << ndiff << " points with different fields" << endl;
+    retval = -3;
+  }
+  // a truncated image must be rejected
+  {
+    std::ifstream in(cylimage,std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+    std::string truncated = cylimage + string(".trunc");
+    std::ofstream out(truncated,std::ios::binary);
+    out.write(bytes.data(),bytes.size()/2);
+    out.close();
+    bool rejected(false);
+    try {
+      CylBFieldMap tmap(truncated);
+    } catch (std::invalid_argument const& error) {
+      rejected = true;
+    }
+    if(!rejected){
+      cout << "Invalid image not rejected" << endl;
+      retval = -4;
+    }
+    remove(truncated.c_str());
+  }
+  remove(cyltext.c_str());
+  remove(cylimage.c_str());
+  remove(axtext.c_str());
+  remove(aximage.c_str());
+  if(retval == EXIT_SUCCESS) cylimagemap.print(cout);
+  return retval;
+}
@@ -5,6 +5,7 @@
 #include "KinKal/Trajectory/ClosestApproach.hh"
 #include "KinKal/Trajectory/PointClosestApproach.hh"
 #include "KinKal/Trajectory/PiecewiseClosestApproach.hh"
+#include "KinKal/Trajectory/BatchClosestApproach.hh"
 #include "KinKal/Trajectory/ParticleTrajectory.hh"
 #include "KinKal/General/BFieldMap.hh"
 #include "KinKal/General/PhysicalConstants.h"
@@ -58,6 +59,7 @@ int ClosestApproachTest(int argc, char **argv) {
   double vprop(0.7);
   double eta(0.0);
   unsigned nstep(50),ntstep(10);
+  int retval(0);
 
   static struct option long_options[] = {
     {"charge",     required_argument, 0, 'q'  },
@@ -117,6 +119,9 @@ int ClosestApproachTest(int argc, char **argv) {
     ts = KTRAJ::paramTitle(parindex)+string(" TOCA Change;#Delta TOCA (exact);#Delta TOCA (derivative)");
     ttpoca.back()->SetTitle(ts.c_str());
   }
+  // save the lines and hints to test the batch calculation
+  std::vector<Line> tlines;
+  std::vector<double> hints;
   for(unsigned itime=0;itime < ntstep;itime++){
     double time = tmin + itime*(tmax-tmin)/(ntstep-1);
     // create tline perp to trajectory at the specified time, separated by the specified gap
@@ -138,6 +143,8 @@ int ClosestApproachTest(int argc, char **argv) {
     // create ClosestApproach from these
     CAHint tphint(time,time);
     TCA tp(ktraj,tline,tphint,1e-8);
+    tlines.push_back(tline);
+    hints.push_back(time);
     // test: delta vector should be perpendicular to both trajs
     VEC3 del = tp.delta().Vect();
     auto pd = tp.particleDirection();
@@ -188,6 +195,57 @@ int ClosestApproachTest(int argc, char **argv) {
       }
     }
   }
+  // TCA methods to test
+  CAConfig hintconfig;
+  hintconfig.analyticHint_ = true;
+  CAConfig curvconfig(hintconfig);
+  curvconfig.curvatureStep_ = true;
+  std::vector<std::pair<std::string,CAConfig>> methods = {{"Newton",CAConfig()},{"AnalyticHint",hintconfig},{"AnalyticHintCurvature",curvconfig}};
+  // test the batch calculation against the individual calculations, for each method
+  for(auto const& method : methods) {
+    BatchClosestApproach<KTRAJ> bca(1e-8,method.second);
+    bca.findTCA(ktraj,LineArray(tlines),hints.data(),hints.data());
+    for(size_t iline=0;iline < tlines.size(); iline++){
+      TCA tca(ktraj,tlines[iline],CAHint(hints[iline],hints[iline]),1e-8,method.second);
+      double maxdiff = std::max(fabs(bca.doca(iline)-tca.doca()),
+          std::max(fabs(bca.particleToca(iline)-tca.particleToca()),fabs(bca.sensorToca(iline)-tca.sensorToca())));
+      for(size_t ipar=0;ipar<NParams();ipar++)
+        maxdiff = std::max(maxdiff,std::max(fabs(bca.dDdP(iline)[ipar]-tca.dDdP()[ipar]),fabs(bca.dTdP(iline)[ipar]-tca.dTdP()[ipar])));
+      if(bca.status(iline) != tca.status() || maxdiff > 1e-10){
+        cout << method.first << " BatchClosestApproach status " << ClosestApproachData::statusName(bca.status(iline)) << " doca " << bca.doca(iline)
+          << " disagrees with ClosestApproach status " << tca.statusName() << " doca " << tca.doca() << endl;
+        retval = -1;
+      }
+    }
+  }
+  // distribution of iteration counts starting from poor hints, for the default and improved TCA methods
+  double hintrange(1.5); // maximum hint error (ns)
+  unsigned nhint(100);
+  TRandom3 tr(98734);
+  std::vector<CAHint> badhints;
+  for(size_t iline=0;iline < tlines.size(); iline++)
+    for(unsigned ihint=0;ihint < nhint; ihint++)
+      badhints.emplace_back(hints[iline]+tr.Uniform(-hintrange,hintrange),hints[iline]+tr.Uniform(-hintrange,hintrange));
+  // the improved methods must converge to the true DOCA at least as often as the default
+  unsigned newtonconv(0);
+  for(auto const& method : methods) {
+    unsigned maxiter = method.second.maxiter_;
+    TH1F* niterh = new TH1F(("niter"+method.first).c_str(),(method.first+" TCA iterations;N iterations").c_str(),maxiter+1,-0.5,maxiter+0.5);
+    unsigned nconv(0);
+    for(size_t ihint=0;ihint < badhints.size(); ihint++){
+      TCA tca(ktraj,tlines[ihint/nhint],badhints[ihint],1e-8,method.second);
+      niterh->Fill(tca.nIterations());
+      if(tca.status() == ClosestApproachData::converged && fabs(fabs(tca.doca())-gap) < 1e-6) nconv++;
+    }
+    cout << method.first << " TCA iterations mean " << niterh->GetMean() << " RMS " << niterh->GetRMS() << " max " << niterh->FindLastBinAbove(0.0)-1
+      << " converged to the true DOCA " << nconv << "/" << badhints.size() << endl;
+    if(method.first == "Newton")
+      newtonconv = nconv;
+    else if(nconv < newtonconv){
+      cout << method.first << " TCA converged to the true DOCA less often than Newton" << endl;
+      retval = -1;
+    }
+  }
   for(size_t ipar=0;ipar<NParams();ipar++){
     dtpcan->cd(ipar+1);
     dtpoca[ipar]->Draw("A*");
@@ -200,7 +258,7 @@ int ClosestApproachTest(int argc, char **argv) {
   ttpcan->Write();
   tpfile.Write();
   tpfile.Close();
-  return 0;
+  return retval;
 }
 
 
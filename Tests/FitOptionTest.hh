@@ -0,0 +1,202 @@
+//
+// ToyMC test comparing fits made with an optional fit algorithm (Config flag) against fits of the same tracks made with the default algorithm.
+// The chisquared and the parameters and covariance at both ends of the fit must agree within a tolerance, relative to the chisquared
+// and to the parameter errors.  A tolerance of 0 requires bit-identical results, including the fit status; otherwise just the usability must agree.
+// Optionally both fits are then extended several times, each time with a slightly smaller seed deweighting, to test how the seed changes
+// accumulate in incremental fits.  Where the fits cache their states, the unbiased hit pulls computed from those states must agree with
+// the hits' own unbiased pulls, within the same tolerance (or 1e-3 for exact comparisons, as the cached states count the seed twice)
+//
+#include "KinKal/Tests/FitTest.hh"
+
+template <class KTRAJ>
+int FitOptionTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
+  using PTRAJ = ParticleTrajectory<KTRAJ>;
+  using KKTRK = KinKal::Track<KTRAJ>;
+  using KKTRKPTR = std::unique_ptr<KKTRK>;
+  using RESIDHIT = ResidualHit<KTRAJ>;
+  using Clock = std::chrono::high_resolution_clock;
+  int opt;
+  double mom(105.0);
+  int icharge(-1);
+  double mass(0.511);
+  unsigned ntrks(200), nhits(40);
+  double Bgrad(-0.036), Bz(1.0);
+  double zrange(3000);
+  double seedsmear(10.0);
+  double ambigdoca(0.25);
+  int iseed(123421);
+  string sfile("driftfit.txt"), option;
+  double tolerance(0.0);
+  unsigned seedsteps(0);
+  int retval(EXIT_SUCCESS);
+
+  static struct option long_options[] = {
+    {"momentum",     required_argument, 0, 'm' },
+    {"ntracks",     required_argument, 0, 'N'  },
+    {"nhits",     required_argument, 0, 'n'  },
+    {"Bgrad",     required_argument, 0, 'g'  },
+    {"seed",     required_argument, 0, 's'  },
+    {"Schedule",     required_argument, 0, 'u'  },
+    {"Option",     required_argument, 0, 'o'  },
+    {"tolerance",     required_argument, 0, 't'  },
+    {"seedsteps",     required_argument, 0, 'd'  },
+    {NULL, 0,0,0}
+  };
+  int long_index =0;
+  while ((opt = getopt_long(argc, argv,"",
+          long_options, &long_index )) != -1) {
+    switch (opt) {
+      case 'm' : mom = atof(optarg);
+                 break;
+      case 'N' : ntrks = atoi(optarg);
+                 break;
+      case 'n' : nhits = atoi(optarg);
+                 break;
+      case 'g' : Bgrad = atof(optarg);
+                 break;
+      case 's' : iseed = atoi(optarg);
+                 break;
+      case 'u' : sfile = optarg;
+                 break;
+      case 'o' : option = optarg;
+                 break;
+      case 't' : tolerance = atof(optarg);
+                 break;
+      case 'd' : seedsteps = atoi(optarg);
+                 break;
+      default: printf("Usage: FitOptionTest --Option s --tolerance f --seedsteps i --momentum f --ntracks i --nhits i --Bgrad f --seed i --Schedule a\n");
+               exit(EXIT_FAILURE);
+    }
+  }
+  std::unique_ptr<BFieldMap> BF;
+  if(Bgrad != 0)
+    BF = std::make_unique<GradientBFieldMap>(Bz-0.5*Bgrad,Bz+0.5*Bgrad,-0.5*zrange,0.5*zrange);
+  else
+    BF = std::make_unique<UniformBFieldMap>(VEC3(0.0,0.0,Bz));
+  Config config;
+  if(makeConfig(sfile,config) != 0) return -1;
+  Config optconfig(config);
+  if(option == "Incremental")
+    optconfig.incremental_ = true;
+  else if(option == "MinParallel")
+    optconfig.minparallel_ = 1; // always run the forward and backward passes concurrently
+  else if(option == "ParamUpdate")
+    optconfig.paramupdate_ = true;
+  else if(option == "WeightNoise")
+    optconfig.wnoise_ = true;
+  else {
+    cout << "Unknown fit option " << option << endl;
+    return -1;
+  }
+  cout << "Comparing fits with option " << option << " to the default fit, tolerance " << tolerance << ", seed steps " << seedsteps << endl;
+  // fit the same tracks with both configurations.  The inputs are regenerated for each, as fitting modifies the hit and xing state
+  std::array<std::vector<KKTRKPTR>,2> fits;
+  for(size_t iconfig=0; iconfig < fits.size(); iconfig++){
+    KKTest::ToyMC<KTRAJ> toy(*BF, mom, icharge, zrange, iseed, nhits, true, false, ambigdoca, mass );
+    double duration(0.0);
+    for(unsigned itrk=0; itrk < ntrks; itrk++){
+      PTRAJ tptraj;
+      typename KKTRK::HITCOL thits;
+      typename KKTRK::EXINGCOL dxings;
+      toy.simulateParticle(tptraj,thits,dxings);
+      double tmid = tptraj.range().mid();
+      auto const& midhel = tptraj.nearestPiece(tmid);
+      auto seedpos = midhel.position4(tmid);
+      KTRAJ seedtraj(seedpos,midhel.momentum4(tmid),midhel.charge(),BF->fieldVect(seedpos.Vect()),tptraj.range());
+      toy.createSeed(seedtraj,sigmas,seedsmear);
+      auto start = Clock::now();
+      fits[iconfig].push_back(std::make_unique<KKTRK>(iconfig == 0 ? config : optconfig,*BF,PTRAJ(seedtraj),thits,dxings));
+      auto stop = Clock::now();
+      duration += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+      // refit with the final meta-iteration, changing only the seed.  The first step makes the seed significant (10% of the fit information);
+      // each following step changes it by about 6e-4 chisquared, below Config::inctol_, but the steps together exceed it
+      auto& fit = *fits[iconfig].back();
+      Config seedconfig(iconfig == 0 ? config : optconfig);
+      seedconfig.schedule_ = Config::Schedule(1,seedconfig.schedule().back());
+      for(unsigned istep=0; istep < seedsteps && fit.fitStatus().usable(); istep++){
+        seedconfig.dwt_ = 1.0/(0.1 + 1.0e-4*istep);
+        typename KKTRK::HITCOL nohits;
+        typename KKTRK::EXINGCOL noxings;
+        fit.extend(seedconfig,nohits,noxings);
+      }
+    }
+    cout << (iconfig == 0 ? "Default" : option) << " fit time/track = " << duration/double(ntrks) << " Nanoseconds " << endl;
+  }
+  // largest difference of parameters and covariance, relative to the reference errors
+  auto pardiff = [](Parameters const& ref, Parameters const& alt) {
+    double retval(0.0);
+    for(size_t ipar=0; ipar < NParams(); ipar++){
+      double perr = sqrt(ref.covariance()(ipar,ipar));
+      retval = std::max(retval,fabs(alt.parameters()[ipar]-ref.parameters()[ipar])/perr);
+      for(size_t jpar=0; jpar < NParams(); jpar++)
+        retval = std::max(retval,fabs(alt.covariance()(ipar,jpar)-ref.covariance()(ipar,jpar))/(perr*sqrt(ref.covariance()(jpar,jpar))));
+    }
+    return retval;
+  };
+  // largest difference between the unbiased pulls computed from the cached states and those computed by the hits.
+  // Hits dominating their reference have no unbiased pulls, and are skipped
+  auto pulldiff = [](KKTRK const& fit) {
+    double retval(0.0);
+    for(size_t ieff=0; ieff < fit.effects().size(); ieff++) {
+      auto const* kkmeas = fit.measurement(ieff);
+      if(kkmeas == 0 || !fit.hasStates(ieff))continue;
+      auto const* rhit = dynamic_cast<RESIDHIT const*>(kkmeas->hit().get());
+      if(rhit == 0)continue;
+      for(unsigned ires=0; ires < rhit->nResid(); ires++){
+        if(!rhit->refResidual(ires).active())continue;
+        double hpull;
+        try {
+          hpull = rhit->pull(ires);
+        } catch (std::runtime_error const&) {
+          continue;
+        }
+        try {
+          retval = std::max(retval,fabs(fit.unbiasedPull(ieff,ires)-hpull));
+        } catch (std::runtime_error const& error) {
+          cout << "Cached-state unbiased pull failure at effect " << ieff << " : " << error.what() << endl;
+          retval = std::numeric_limits<double>::max();
+        }
+      }
+    }
+    return retval;
+  };
+  double pulltol = std::max(tolerance,1.0e-3);
+  unsigned nbad(0);
+  double maxchisq(0.0), maxpar(0.0), maxdpull(0.0);
+  for(unsigned itrk=0; itrk < ntrks; itrk++){
+    auto const& ref = *fits[0][itrk];
+    auto const& alt = *fits[1][itrk];
+    auto const& refstat = ref.fitStatus();
+    auto const& altstat = alt.fitStatus();
+    bool differs = tolerance > 0.0 ? refstat.usable() != altstat.usable() : refstat.status_ != altstat.status_;
+    if(!differs && refstat.usable() && altstat.usable()){
+      double dchisq = fabs(altstat.chisq_.chisq()-refstat.chisq_.chisq())/std::max(1.0,refstat.chisq_.chisq());
+      double dpar = std::max(pardiff(ref.fitTraj().front().params(),alt.fitTraj().front().params()),
+          pardiff(ref.fitTraj().back().params(),alt.fitTraj().back().params()));
+      maxchisq = std::max(maxchisq,dchisq);
+      maxpar = std::max(maxpar,dpar);
+      differs = altstat.chisq_.nDOF() != refstat.chisq_.nDOF() || dchisq > tolerance || dpar > tolerance;
+    }
+    for(auto const* fit : {&ref, &alt}){
+      if(fit->fitStatus().usable()){
+        double dpull = pulldiff(*fit);
+        maxdpull = std::max(maxdpull,dpull);
+        if(dpull > pulltol){
+          cout << "Track " << itrk << " cached-state unbiased pulls differ by " << dpull << " in the " << (fit == &ref ? string("default") : option) << " fit" << endl;
+          differs = true;
+        }
+      }
+    }
+    if(differs){
+      cout << "Track " << itrk << " result differs with option " << option << ": default " << refstat << " option " << altstat << endl;
+      nbad++;
+    }
+  }
+  cout << "Maximum relative chisq difference " << maxchisq << " maximum relative parameter difference " << maxpar << endl;
+  cout << "Maximum unbiased pull difference using cached fit states " << maxdpull << endl;
+  if(nbad > 0){
+    cout << nbad << " of " << ntrks << " fits out of tolerance" << endl;
+    retval = -2;
+  }
+  return retval;
+}
@@ -16,7 +16,9 @@
 #include "KinKal/Fit/Material.hh"
 #include "KinKal/Fit/BField.hh"
 #include "KinKal/Fit/Track.hh"
+#include "KinKal/General/WorkStealingPool.hh"
 #include "KinKal/Tests/ToyMC.hh"
+#include "KinKal/Tests/MakeConfig.hh"
 #include "KinKal/Examples/HitInfo.hh"
 #include "KinKal/Examples/MaterialInfo.hh"
 #include "KinKal/Examples/BFieldInfo.hh"
@@ -35,6 +37,7 @@
 #include <chrono>
 #include <cfenv>
 #include <memory>
+#include <optional>
 #include <cstdlib>
 #include <cstring>
 
@@ -68,8 +71,9 @@ using namespace KinKal;
 using namespace std;
 // avoid confusion with root
 using KinKal::Line;
+using KKTest::makeConfig;
 void print_usage() {
-  printf("Usage: FitTest  --momentum f --simparticle i --fitparticle i--charge i --nhits i --hres f --seed i -ambigdoca f --nevents i --simmat i--fitmat i --ttree i --Bz f --dBx f --dBy f --dBz f--Bgrad f --tolerance f --TFilesuffix c --PrintBad i --PrintDetail i --ScintHit i --invert i --Schedule a --ssmear i --constrainpar i --inefficiency f --extend s --lighthit i --TimeBuffer f --matvarscale i\n");
+  printf("Usage: FitTest  --momentum f --simparticle i --fitparticle i--charge i --nhits i --hres f --seed i -ambigdoca f --nevents i --simmat i--fitmat i --ttree i --Bz f --dBx f --dBy f --dBz f--Bgrad f --tolerance f --TFilesuffix c --PrintBad i --PrintDetail i --ScintHit i --invert i --Schedule a --ssmear i --constrainpar i --inefficiency f --extend s --lighthit i --TimeBuffer f --matvarscale i --CacheStates i --Incremental i --MinParallel i --ParamUpdate i --WeightNoise i --nthreads i --TCAPrecision f --TCAMaxIter i\n");
 }
 
 // utility function to compute transverse distance between 2 similar trajectories.  Also
@@ -96,61 +100,6 @@ double dTraj(KTRAJ const& kt1, KTRAJ const& kt2, double t1, double& t2) {
   return ((pos2-pos1).Cross(dir1)).R();
 }
 
-int makeConfig(string const& cfile, KinKal::Config& config,bool mvarscale=true) {
-  string fullfile;
-  if(strncmp(cfile.c_str(),"/",1) == 0) {
-    fullfile = string(cfile);
-  } else {
-    if(const char* source = std::getenv("KINKAL_SOURCE_DIR")){
-      fullfile = string(source) + string("/Tests/") + string(cfile);
-    } else {
-      cout << "KINKAL_SOURCE_DIR not defined" << endl;
-      return -1;
-    }
-  }
-  std::ifstream ifs (fullfile, std::ifstream::in);
-  if ( (ifs.rdstate() & std::ifstream::failbit ) != 0 ){
-    std::cerr << "Error opening " << fullfile << std::endl;
-    return -1;
-  }
-  string line;
-  int plevel(-1);
-   unsigned nmiter(0);
-  while (getline(ifs,line)){
-    if(strncmp(line.c_str(),"#",1)!=0){
-      istringstream ss(line);
-      if(plevel < 0) {
-        ss >> config.maxniter_ >> config.dwt_ >> config.convdchisq_ >> config.divdchisq_ >>
-        config.pdchisq_ >> config.tol_ >> config.minndof_ >> config.bfcorr_ >>
-        config.ends_ >> plevel;
-        config.plevel_ = Config::printLevel(plevel);
-      } else {
-        int utype(-1);
-        double temp, mindoca(-1.0),maxdoca(-1.0);
-        ss >> temp >> utype;
-        MetaIterConfig miconfig(temp);
-        miconfig.addUpdater(StrawXingConfig(0.3,5.0,10.0,mvarscale)); // hardcoded values, should come from outside, FIXME
-        if(utype == 0 ){
-          cout << "NullWireHitUpdater for iteration " << nmiter << endl;
-          miconfig.addUpdater(std::any(NullWireHitUpdater()));
-        } else if(utype == 1) {
-          ss >>  mindoca >> maxdoca;
-          cout << "DOCAWireHitUpdater for iteration " << nmiter << " with mindoca " << mindoca << " maxdoca " << maxdoca  << endl;
-          DOCAWireHitUpdater updater(mindoca,maxdoca);
-          miconfig.addUpdater(std::any(updater));
-        } else if(utype > 0){
-          cout << "Unknown updater " << utype << endl;
-          return -20;
-        }
-        config.schedule_.push_back(miconfig);
-        ++nmiter;
-      }
-    }
-  }
-  return 0;
-}
-
-
 template <class KTRAJ>
 int FitTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
   struct KTRAJPars{
@@ -204,6 +153,13 @@ int FitTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
   bool fitmat(true);
   bool extend(false);
   bool mvarscale(true);
+  bool cachestates(false);
+  bool incremental(false);
+  unsigned minparallel(0);
+  bool paramupdate(false), wnoise(false);
+  unsigned nthreads(0); // event loop threads.  0 is the legacy serial mode with a single random number stream, which simulates different events than any N > 0
+  double tcaprec(0.0); // if positive, overrides the schedule's TCA precision for the annealing meta-iterations
+  unsigned tcamaxiter(0); // if positive, overrides the schedule's maximum TCA iterations for the annealing meta-iterations
   string exfile;
   BFieldMap *BF(0);
   double Bgrad(0.0), dBx(0.0), dBy(0.0), dBz(0.0), Bz(1.0);
@@ -252,6 +208,14 @@ int FitTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
     {"lighthit",     required_argument, 0, 'L'  },
     {"TimeBuffer",     required_argument, 0, 'W'  },
     {"MatVarScale",     required_argument, 0, 'v'  },
+    {"CacheStates",     required_argument, 0, 'C'  },
+    {"Incremental",     required_argument, 0, 'i'  },
+    {"MinParallel",     required_argument, 0, 'a'  },
+    {"ParamUpdate",     required_argument, 0, 'k'  },
+    {"WeightNoise",     required_argument, 0, 'o'  },
+    {"nthreads",     required_argument, 0, 'j'  },
+    {"TCAPrecision",     required_argument, 0, 'e'  },
+    {"TCAMaxIter",     required_argument, 0, 'l'  },
     {NULL, 0,0,0}
   };
 
@@ -315,6 +279,22 @@ int FitTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
                  break;
       case 'v' : mvarscale = atoi(optarg);
                  break;
+      case 'C' : cachestates = atoi(optarg);
+                 break;
+      case 'i' : incremental = atoi(optarg);
+                 break;
+      case 'a' : minparallel = atoi(optarg);
+                 break;
+      case 'k' : paramupdate = atoi(optarg);
+                 break;
+      case 'o' : wnoise = atoi(optarg);
+                 break;
+      case 'j' : nthreads = atoi(optarg);
+                 break;
+      case 'e' : tcaprec = atof(optarg);
+                 break;
+      case 'l' : tcamaxiter = atoi(optarg);
+                 break;
       case 'X' : exfile = optarg;
                  extend = true;
                  break;
@@ -342,12 +322,22 @@ int FitTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
   toy.setTolerance(tol/10.0); // finer precision on sim
   // setup fit configuration
   Config config;
-  makeConfig(sfile,config,mvarscale);
+  makeConfig(sfile,config,mvarscale,tcaprec,tcamaxiter);
+  config.cachestates_ = cachestates;
+  config.incremental_ = incremental;
+  config.minparallel_ = minparallel;
+  config.paramupdate_ = paramupdate;
+  config.wnoise_ = wnoise;
   cout << "Main fit " << config << endl;
   // read the schedule from the file
   Config exconfig;
   if(extend){
-    makeConfig(exfile,exconfig,mvarscale);
+    makeConfig(exfile,exconfig,mvarscale,tcaprec,tcamaxiter);
+    exconfig.cachestates_ = cachestates;
+    exconfig.incremental_ = incremental;
+    exconfig.minparallel_ = minparallel;
+    exconfig.paramupdate_ = paramupdate;
+    exconfig.wnoise_ = wnoise;
     cout << "Extension " << exconfig << endl;
   }
   // generate hits
@@ -417,6 +407,7 @@ int FitTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
   KKTRK kktrk(config,*BF,seedtraj,thits,dxings);
   if(extend && kktrk.fitStatus().usable())kktrk.extend(exconfig,exthits, exdxings);
   if(!printbad)kktrk.print(cout,detail);
+  if(FitProfile::enabled())kktrk.profile().print(cout,detail);
   TFile fitfile((KTRAJ::trajName() + string("FitTest") + tfname + string(".root")).c_str(),"RECREATE");
   // tree variables
   KTRAJPars ftpars_, mtpars_, btpars_, spars_, ffitpars_, ffiterrs_, mfitpars_, mfiterrs_, bfitpars_, bfiterrs_;
@@ -645,17 +636,26 @@ int FitTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
     TH1F* mmompull = new TH1F("mmompull","Mid Momentum Pull;#Delta P/#sigma _{p}",100,-nsig,nsig);
     TH1F* bmompull = new TH1F("bmompull","Back Momentum Pull;#Delta P/#sigma _{p}",100,-nsig,nsig);
     double duration (0.0);
+    unsigned long ntotiter(0);
+    double maxdpull(0.0); // maximum difference between unbiased pulls computed from the hit and from the cached fit states
+    double maxdpulltol(1.0e-3); // tolerance on that.  The cached states count the (deweighted) seed twice, so they don't agree exactly
     unsigned nfail(0), ndiv(0), ndgap(0), npdiv(0), nlow(0), nconv(0), nuconv(0);
 
-    for(unsigned ievent=0;ievent<nevents;ievent++){
-      if( (ievent % iprint) == 0) cout << "event " << ievent << endl;
-      // create a random true initial helix with hits and material interactions from this.  This also handles BFieldMap inhomogeneity truth tracking
+    // events are simulated and fit in batches, in parallel if requested, and then analyzed in event order.  When using threads each
+    // event has its own random number streams, seeded from the event number, so the results of any N threads are bitwise identical to --nthreads 1.
+    // They are not comparable event-by-event with the legacy serial mode (--nthreads 0), whose single random number streams run across events
+    struct EventData {
       PTRAJ tptraj;
-      thits.clear();
-      dxings.clear();
-      exthits.clear();
-      exdxings.clear();
-      toy.simulateParticle(tptraj,thits,dxings,fitmat);
+      std::optional<KTRAJ> seedtraj;
+      MEASCOL thits, exthits;
+      EXINGCOL dxings, exdxings;
+      std::unique_ptr<KKTRK> kktrk;
+      double duration = 0.0;
+    };
+    auto simulate = [&](KKTest::ToyMC<KTRAJ>& toy, TRandom3& rng, EventData& evt) {
+      // create a random true initial helix with hits and material interactions from this.  This also handles BFieldMap inhomogeneity truth tracking
+      auto& tptraj = evt.tptraj;
+      toy.simulateParticle(tptraj,evt.thits,evt.dxings,fitmat);
       double tmid = tptraj.range().mid();
       auto const& midhel = tptraj.nearestPiece(tmid);
       auto seedmom = midhel.momentum4(tmid);
@@ -663,7 +663,8 @@ int FitTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
       TimeRange seedrange(tptraj.range().begin(),tptraj.range().end());
       auto seedpos = midhel.position4(tmid);
       auto bmid = BF->fieldVect(seedpos.Vect());
-      KTRAJ seedtraj(seedpos,seedmom,midhel.charge(),bmid,seedrange);
+      evt.seedtraj.emplace(seedpos,seedmom,midhel.charge(),bmid,seedrange);
+      auto& seedtraj = *evt.seedtraj;
       if(invert)seedtraj.invertCT();
       toy.createSeed(seedtraj,sigmas,seedsmear);
       // if requested, constrain a parameter
@@ -674,310 +675,388 @@ int FitTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
         for(size_t ipar=0; ipar < NParams(); ipar++){
           double perr = sigmas[ipar];
           cparams.covariance()[ipar][ipar] = perr*perr;
-          cparams.parameters()[ipar] += tr_.Gaus(0.0,perr);
+          cparams.parameters()[ipar] += rng.Gaus(0.0,perr);
         }
-        thits.push_back(std::make_shared<PARHIT>(front.range().mid(),seedtraj,cparams,mask));
+        evt.thits.push_back(std::make_shared<PARHIT>(front.range().mid(),seedtraj,cparams,mask));
       }
       if(extend){
-        for(auto ihit = thits.begin(); ihit != thits.end();){
-          if(tr_.Uniform(0.0,1.0) < ineff){
-            exthits.push_back(*ihit);
-            ihit = thits.erase(ihit);
+        for(auto ihit = evt.thits.begin(); ihit != evt.thits.end();){
+          if(rng.Uniform(0.0,1.0) < ineff){
+            evt.exthits.push_back(*ihit);
+            ihit = evt.thits.erase(ihit);
           } else
             ++ihit;
         }
-        for(auto ixing = dxings.begin(); ixing != dxings.end();){
-          if(tr_.Uniform(0.0,1.0) < ineff){
-            exdxings.push_back(*ixing);
-            ixing = dxings.erase(ixing);
+        for(auto ixing = evt.dxings.begin(); ixing != evt.dxings.end();){
+          if(rng.Uniform(0.0,1.0) < ineff){
+            evt.exdxings.push_back(*ixing);
+            ixing = evt.dxings.erase(ixing);
           } else
             ++ixing;
         }
       }
       auto start = Clock::now();
-      KKTRK kktrk(config,*BF,seedtraj,thits,dxings);
-      if(extend && kktrk.fitStatus().usable()&& (exthits.size() > 0 || exdxings.size()> 0))kktrk.extend(exconfig,exthits, exdxings);
+      evt.kktrk = std::make_unique<KKTRK>(config,*BF,seedtraj,evt.thits,evt.dxings);
+      auto& kktrk = *evt.kktrk;
+      if(extend && kktrk.fitStatus().usable()&& (evt.exthits.size() > 0 || evt.exdxings.size()> 0))kktrk.extend(exconfig,evt.exthits, evt.exdxings);
       auto stop = Clock::now();
-      duration += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
-      auto const& fstat = kktrk.fitStatus();
-      if(fstat.status_ == Status::failed)nfail++;
-      if(fstat.status_ == Status::converged)nconv++;
-      if(fstat.status_ == Status::unconverged)nuconv++;
-      if(fstat.status_ == Status::lowNDOF)nlow++;
-      if(fstat.status_ == Status::chisqdiverged)ndiv++;
-      if(fstat.status_ == Status::paramsdiverged)npdiv++;
-      if(fstat.status_ == Status::gapdiverged)ndgap++;
-      niter_ = 0;
-      for(auto const& fstat: kktrk.history()){
-        if(fstat.status_ != Status::unfit)niter_++;
+      evt.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+    };
+    // each thread has its own ToyMC and random number generator
+    WorkStealingPool pool(std::max(1u,nthreads));
+    std::vector<std::unique_ptr<KKTest::ToyMC<KTRAJ>>> wtoys;
+    std::vector<TRandom3> wrngs(pool.nThreads());
+    if(nthreads > 0){
+      cout << "Processing events with " << pool.nThreads() << " threads" << endl;
+      for(unsigned iworker=0; iworker < pool.nThreads(); iworker++){
+        wtoys.push_back(std::make_unique<KKTest::ToyMC<KTRAJ>>(*BF, mom, icharge, zrange, iseed, nhits, simmat, lighthit, ambigdoca, simmass));
+        wtoys.back()->setInefficiency(ineff);
+        wtoys.back()->setTolerance(tol/10.0);
       }
-      // reset some fit parameters, to signal failed filts
-      chiprob_ = -1.0;
-      maxgap_ = avgap_ = -1;
-      igap_ = -1;
-      // fill effect information
-      nkkbf_ = 0; nkkhit_ = 0; nkkmat_ = 0;
-      // accumulate chisquared info
-      chisq_ = fstat.chisq_.chisq();
-      ndof_ = fstat.chisq_.nDOF();
-      nmeta_ = fstat.miter_;
-      status_ = fstat.status_;
-      chiprob_ = fstat.chisq_.probability();
-      hinfovec.clear();
-      bfinfovec.clear();
-      minfovec.clear();
-      tinfovec.clear();
-      statush->Fill(fstat.status_);
-      // truth parameters, front and back
-      double ttlow = thits.front()->time();
-      double ttmid = tptraj.range().mid();
-      double tthigh = thits.back()->time();
-      KTRAJ const& fttraj = tptraj.nearestPiece(ttlow);
-      KTRAJ const& mttraj = tptraj.nearestPiece(ttmid);
-      KTRAJ const& bttraj = tptraj.nearestPiece(tthigh);
-      Parameters ftpars, mtpars, btpars;
-      ftpars = fttraj.params();
-      mtpars = mttraj.params();
-      btpars = bttraj.params();
-      ftmom_ = tptraj.momentum(ttlow);
-      mtmom_ = tptraj.momentum(ttmid);
-      btmom_ = tptraj.momentum(tthigh);
-      // seed
-      sbeg_ = seedtraj.range().begin();
-      send_ = seedtraj.range().end();
-      for(size_t ipar=0;ipar<6;ipar++){
-        spars_.pars_[ipar] = seedtraj.params().parameters()[ipar];
-        ftpars_.pars_[ipar] = ftpars.parameters()[ipar];
-        mtpars_.pars_[ipar] = mtpars.parameters()[ipar];
-        btpars_.pars_[ipar] = btpars.parameters()[ipar];
+    }
+    unsigned nbatch = nthreads > 0 ? 16*pool.nThreads() : 1;
+    std::vector<EventData> events;
+    auto wallstart = Clock::now();
+    for(unsigned ibatch=0; ibatch < nevents; ibatch += nbatch){
+      unsigned nbevt = std::min(nbatch,nevents-ibatch);
+      events.clear();
+      events.resize(nbevt);
+      if(nthreads > 0){
+        pool.process(nbevt,[&](size_t ievt, unsigned iworker){
+            unsigned ievent = ibatch + ievt;
+            wtoys[iworker]->setSeed(KKTest::ToyMC<KTRAJ>::eventSeed(iseed,ievent,0));
+            wrngs[iworker].SetSeed(KKTest::ToyMC<KTRAJ>::eventSeed(iseed,ievent,1));
+            simulate(*wtoys[iworker],wrngs[iworker],events[ievt]);
+            });
+      } else {
+        // legacy serial mode: single random number streams for all events
+        simulate(toy,tr_,events[0]);
       }
-      // fit: initialize to 0
-      ffmom_ = -1.0;
-      mfmom_ = -1.0;
-      bfmom_ = -1.0;
-      ffmomerr_ = -1.0;
-      mfmomerr_ = -1.0;
-      bfmomerr_ = -1.0;
+      for(unsigned ievt=0;ievt<nbevt;ievt++){
+        unsigned ievent = ibatch + ievt;
+        if( (ievent % iprint) == 0) cout << "event " << ievent << endl;
+        auto& evt = events[ievt];
+        auto const& tptraj = evt.tptraj;
+        auto const& thits = evt.thits;
+        auto const& seedtraj = *evt.seedtraj;
+        auto& kktrk = *evt.kktrk;
+        duration += evt.duration;
+        auto const& fstat = kktrk.fitStatus();
+        if(fstat.status_ == Status::failed)nfail++;
+        if(fstat.status_ == Status::converged)nconv++;
+        if(fstat.status_ == Status::unconverged)nuconv++;
+        if(fstat.status_ == Status::lowNDOF)nlow++;
+        if(fstat.status_ == Status::chisqdiverged)ndiv++;
+        if(fstat.status_ == Status::paramsdiverged)npdiv++;
+        if(fstat.status_ == Status::gapdiverged)ndgap++;
+        niter_ = 0;
+        for(auto const& fstat: kktrk.history()){
+          if(fstat.status_ != Status::unfit)niter_++;
+        }
+        ntotiter += kktrk.history().size();
+        // reset some fit parameters, to signal failed filts
+        chiprob_ = -1.0;
+        maxgap_ = avgap_ = -1;
+        igap_ = -1;
+        // fill effect information
+        nkkbf_ = 0; nkkhit_ = 0; nkkmat_ = 0;
+        // accumulate chisquared info
+        chisq_ = fstat.chisq_.chisq();
+        ndof_ = fstat.chisq_.nDOF();
+        nmeta_ = fstat.miter_;
+        status_ = fstat.status_;
+        chiprob_ = fstat.chisq_.probability();
+        hinfovec.clear();
+        bfinfovec.clear();
+        minfovec.clear();
+        tinfovec.clear();
+        statush->Fill(fstat.status_);
+        // truth parameters, front and back
+        double ttlow = thits.front()->time();
+        double ttmid = tptraj.range().mid();
+        double tthigh = thits.back()->time();
+        KTRAJ const& fttraj = tptraj.nearestPiece(ttlow);
+        KTRAJ const& mttraj = tptraj.nearestPiece(ttmid);
+        KTRAJ const& bttraj = tptraj.nearestPiece(tthigh);
+        Parameters ftpars, mtpars, btpars;
+        ftpars = fttraj.params();
+        mtpars = mttraj.params();
+        btpars = bttraj.params();
+        ftmom_ = tptraj.momentum(ttlow);
+        mtmom_ = tptraj.momentum(ttmid);
+        btmom_ = tptraj.momentum(tthigh);
+        // seed
+        sbeg_ = seedtraj.range().begin();
+        send_ = seedtraj.range().end();
+        for(size_t ipar=0;ipar<6;ipar++){
+          spars_.pars_[ipar] = seedtraj.params().parameters()[ipar];
+          ftpars_.pars_[ipar] = ftpars.parameters()[ipar];
+          mtpars_.pars_[ipar] = mtpars.parameters()[ipar];
+          btpars_.pars_[ipar] = btpars.parameters()[ipar];
+        }
+        // fit: initialize to 0
+        ffmom_ = -1.0;
+        mfmom_ = -1.0;
+        bfmom_ = -1.0;
+        ffmomerr_ = -1.0;
+        mfmomerr_ = -1.0;
+        bfmomerr_ = -1.0;
 
-      if(fstat.usable()){
-        // basic info
-        auto const& fptraj = kktrk.fitTraj();
-        // compare parameters at the first traj of both true and fit
-        // correct the true parameters in case the BFieldMap isn't nominal
-        // correct the sampling time for the t0 difference
-        double ftlow,ftmid,fthigh;
-        dTraj(tptraj,fptraj,ttlow,ftlow);
-        dTraj(tptraj,fptraj,ttmid,ftmid);
-        dTraj(tptraj,fptraj,tthigh,fthigh);
-        KTRAJ fftraj(fptraj.stateEstimate(ftlow),tptraj.bnom(ttlow),fptraj.nearestPiece(ftlow).range());
-        KTRAJ mftraj(fptraj.stateEstimate(ftmid),tptraj.bnom(ttmid),fptraj.nearestPiece(ftmid).range());
-        KTRAJ bftraj(fptraj.stateEstimate(fthigh),tptraj.bnom(tthigh),fptraj.nearestPiece(fthigh).range());
-        // fit parameters
-        auto const& ffpars = fftraj.params();
-        auto const& mfpars = mftraj.params();
-        auto const& bfpars = bftraj.params();
+        if(fstat.usable()){
+          // basic info
+          auto const& fptraj = kktrk.fitTraj();
+          // compare parameters at the first traj of both true and fit
+          // correct the true parameters in case the BFieldMap isn't nominal
+          // correct the sampling time for the t0 difference
+          double ftlow,ftmid,fthigh;
+          dTraj(tptraj,fptraj,ttlow,ftlow);
+          dTraj(tptraj,fptraj,ttmid,ftmid);
+          dTraj(tptraj,fptraj,tthigh,fthigh);
+          KTRAJ fftraj(fptraj.stateEstimate(ftlow),tptraj.bnom(ttlow),fptraj.nearestPiece(ftlow).range());
+          KTRAJ mftraj(fptraj.stateEstimate(ftmid),tptraj.bnom(ttmid),fptraj.nearestPiece(ftmid).range());
+          KTRAJ bftraj(fptraj.stateEstimate(fthigh),tptraj.bnom(tthigh),fptraj.nearestPiece(fthigh).range());
+          // fit parameters
+          auto const& ffpars = fftraj.params();
+          auto const& mfpars = mftraj.params();
+          auto const& bfpars = bftraj.params();
 
-        ndof->Fill(ndof_);
-        chisq->Fill(chisq_);
-        chisqndof->Fill(fstat.chisq_.chisqPerNDOF());
-        chisqprob->Fill(chiprob_);
-        if(chiprob_ > 0.0) logchisqprob->Fill(log10(chiprob_));
-        hniter->Fill(niter_);
-        hnmeta->Fill(nmeta_);
-        // accumulate parameter difference and pull
-        vector<double> fcerr(6,0.0), mcerr(6,0.0), bcerr(6,0.0);
+          ndof->Fill(ndof_);
+          chisq->Fill(chisq_);
+          chisqndof->Fill(fstat.chisq_.chisqPerNDOF());
+          chisqprob->Fill(chiprob_);
+          if(chiprob_ > 0.0) logchisqprob->Fill(log10(chiprob_));
+          hniter->Fill(niter_);
+          hnmeta->Fill(nmeta_);
+          // accumulate parameter difference and pull
+          vector<double> fcerr(6,0.0), mcerr(6,0.0), bcerr(6,0.0);
 
-        for(size_t ipar=0;ipar< NParams(); ipar++){
-          fcerr[ipar] = sqrt(ffpars.covariance()[ipar][ipar]);
-          mcerr[ipar] = sqrt(mfpars.covariance()[ipar][ipar]);
-          bcerr[ipar] = sqrt(bfpars.covariance()[ipar][ipar]);
-          fdp[ipar]->Fill(ffpars.parameters()[ipar]-ftpars.parameters()[ipar]);
-          mdp[ipar]->Fill(mfpars.parameters()[ipar]-mtpars.parameters()[ipar]);
-          bdp[ipar]->Fill(bfpars.parameters()[ipar]-btpars.parameters()[ipar]);
-          fpull[ipar]->Fill((ffpars.parameters()[ipar]-ftpars.parameters()[ipar])/fcerr[ipar]);
-          mpull[ipar]->Fill((mfpars.parameters()[ipar]-mtpars.parameters()[ipar])/mcerr[ipar]);
-          bpull[ipar]->Fill((bfpars.parameters()[ipar]-btpars.parameters()[ipar])/bcerr[ipar]);
-          fiterrh[ipar]->Fill(fcerr[ipar]);
-        }
-        // accumulate average correlation matrix
-        auto const& cov = ffpars.covariance();
-        //    auto cormat = cov;
-        for(size_t ipar=0; ipar <NParams();ipar++){
-          for(size_t jpar=ipar;jpar < NParams(); jpar++){
-            double corr = cov[ipar][jpar]/(fcerr[ipar]*fcerr[jpar]);
-            //  cormat[ipar][jpar] = corr;
-            corravg->Fill(ipar,jpar,fabs(corr));
+          for(size_t ipar=0;ipar< NParams(); ipar++){
+            fcerr[ipar] = sqrt(ffpars.covariance()[ipar][ipar]);
+            mcerr[ipar] = sqrt(mfpars.covariance()[ipar][ipar]);
+            bcerr[ipar] = sqrt(bfpars.covariance()[ipar][ipar]);
+            fdp[ipar]->Fill(ffpars.parameters()[ipar]-ftpars.parameters()[ipar]);
+            mdp[ipar]->Fill(mfpars.parameters()[ipar]-mtpars.parameters()[ipar]);
+            bdp[ipar]->Fill(bfpars.parameters()[ipar]-btpars.parameters()[ipar]);
+            fpull[ipar]->Fill((ffpars.parameters()[ipar]-ftpars.parameters()[ipar])/fcerr[ipar]);
+            mpull[ipar]->Fill((mfpars.parameters()[ipar]-mtpars.parameters()[ipar])/mcerr[ipar]);
+            bpull[ipar]->Fill((bfpars.parameters()[ipar]-btpars.parameters()[ipar])/bcerr[ipar]);
+            fiterrh[ipar]->Fill(fcerr[ipar]);
           }
-        }
-        ffmom_ = fptraj.momentum(ftlow);
-        mfmom_ = fptraj.momentum(ftmid);
-        bfmom_ = fptraj.momentum(fthigh);
-        ffmomerr_ = sqrt(fptraj.momentumVariance(ftlow));
-        mfmomerr_ = sqrt(fptraj.momentumVariance(ftmid));
-        bfmomerr_ = sqrt(fptraj.momentumVariance(fthigh));
-        fmomres->Fill((ffmom_-ftmom_));
-        mmomres->Fill((mfmom_-mtmom_));
-        bmomres->Fill((bfmom_-btmom_));
-        fmompull->Fill((ffmom_-ftmom_)/ffmomerr_);
-        mmompull->Fill((mfmom_-mtmom_)/mfmomerr_);
-        bmompull->Fill((bfmom_-btmom_)/bfmomerr_);
-        // state space parameter difference and errors
-        //      ParticleStateEstimate tslow = tptraj.state(tlow);
-        //      ParticleStateEstimate tshigh = tptraj.state(thigh);
-        //      ParticleStateEstimate slow = fptraj.stateEstimate(tlow);
-        //      ParticleStateEstimate shigh = fptraj.stateEstimate(thigh);
-        if(ttree && fstat.usable()){
-          fbeg_ = fptraj.range().begin();
-          fend_ = fptraj.range().end();
-
-          nactivehit_ = nstrawhit_ = nnull_ = nscinthit_ = 0;
-          for(auto const& eff: kktrk.effects()) {
-            const KKMEAS* kkhit = dynamic_cast<const KKMEAS*>(eff.get());
-            const KKBFIELD* kkbf = dynamic_cast<const KKBFIELD*>(eff.get());
-            const KKMAT* kkmat = dynamic_cast<const KKMAT*>(eff.get());
-            if(kkhit != 0){
-              nkkhit_++;
+          // accumulate average correlation matrix
+          auto const& cov = ffpars.covariance();
+          //    auto cormat = cov;
+          for(size_t ipar=0; ipar <NParams();ipar++){
+            for(size_t jpar=ipar;jpar < NParams(); jpar++){
+              double corr = cov[ipar][jpar]/(fcerr[ipar]*fcerr[jpar]);
+              //  cormat[ipar][jpar] = corr;
+              corravg->Fill(ipar,jpar,fabs(corr));
+            }
+          }
+          ffmom_ = fptraj.momentum(ftlow);
+          mfmom_ = fptraj.momentum(ftmid);
+          bfmom_ = fptraj.momentum(fthigh);
+          ffmomerr_ = sqrt(fptraj.momentumVariance(ftlow));
+          mfmomerr_ = sqrt(fptraj.momentumVariance(ftmid));
+          bfmomerr_ = sqrt(fptraj.momentumVariance(fthigh));
+          fmomres->Fill((ffmom_-ftmom_));
+          mmomres->Fill((mfmom_-mtmom_));
+          bmomres->Fill((bfmom_-btmom_));
+          fmompull->Fill((ffmom_-ftmom_)/ffmomerr_);
+          mmompull->Fill((mfmom_-mtmom_)/mfmomerr_);
+          bmompull->Fill((bfmom_-btmom_)/bfmomerr_);
+          // compare the unbiased residual pulls computed from the cached fit states with those computed by the hits
+          if(cachestates){
+            for(size_t ieff=0; ieff < kktrk.effects().size(); ieff++) {
+              const KKMEAS* kkhit = kktrk.measurement(ieff);
+              if(kkhit == 0 || !kktrk.hasStates(ieff))continue;
               const STRAWHIT* strawhit = dynamic_cast<const STRAWHIT*>(kkhit->hit().get());
-              const SCINTHIT* scinthit = dynamic_cast<const SCINTHIT*>(kkhit->hit().get());
-              const PARHIT* parhit = dynamic_cast<const PARHIT*>(kkhit->hit().get());
-              if(kkhit->active())nactivehit_++;
-              HitInfo hinfo;
-              hinfo.active_ = kkhit->active();
-              hinfo.time_ = kkhit->time();
-              auto chisq = kkhit->hit()->chisquared();
-              hinfo.chisq_ = chisq.chisq();
-              hinfo.prob_ = chisq.probability();
-              hinfo.ndof_ = chisq.nDOF();
-              hinfo.state_ = -10;
-              hinfo.pos_ = fptraj.position3(kkhit->hit()->time());
-              hinfo.t0_ = 0.0;
-              hinfo.dresid_ = -1000.0;
-              hinfo.dresidvar_ =  -1.0;
-              hinfo.dresidpull_ =  -1000.0;
-              hinfo.tresid_ = -1000.0;
-              hinfo.tresidvar_ =  -1.0;
-              hinfo.tresidpull_ =  -1000.0;
-              if(strawhit != 0){
-                if(strawhit->active()){
-                  nstrawhit_++;
-                  if(!strawhit->hitState().useDrift())nnull_++;
+              if(strawhit == 0)continue;
+              for(auto ires : {STRAWHIT::tresid, STRAWHIT::dresid}){
+                if(strawhit->refResidual(ires).active()){
+                  Residual resid;
+                  try {
+                    resid = strawhit->residual(ires);
+                  } catch (std::runtime_error const&) {
+                    continue; // the hit dominates the reference, so there's no unbiased residual to compare
+                  }
+                  try {
+                    maxdpull = std::max(maxdpull,fabs(kktrk.unbiasedPull(ieff,ires)-resid.pull()));
+                  } catch (std::runtime_error const& error) {
+                    cout << "Cached-state unbiased parameter failure at effect " << ieff << " : " << error.what() << endl;
+                    maxdpull = std::numeric_limits<double>::max();
+                  }
                 }
-                hinfo.type_ = HitInfo::straw;
-                hinfo.state_ = strawhit->hitState().state_;
-                hinfo.t0_ = strawhit->closestApproach().particleToca();
-                hinfo.id_ = strawhit->id();
-                hinfo.doca_ = strawhit->closestApproach().doca();
-                hinfo.deltat_ = strawhit->closestApproach().deltaT();
-                hinfo.docavar_ = strawhit->closestApproach().docaVar();
-                hinfo.tocavar_ = strawhit->closestApproach().tocaVar();
-                hinfo.dirdot_ = strawhit->closestApproach().dirDot();
-               // straw hits can have multiple residuals
-                if(strawhit->refResidual(STRAWHIT::tresid).active()){
-                  auto resid = strawhit->residual(STRAWHIT::tresid);
+              }
+            }
+          }
+          // state space parameter difference and errors
+          //      ParticleStateEstimate tslow = tptraj.state(tlow);
+          //      ParticleStateEstimate tshigh = tptraj.state(thigh);
+          //      ParticleStateEstimate slow = fptraj.stateEstimate(tlow);
+          //      ParticleStateEstimate shigh = fptraj.stateEstimate(thigh);
+          if(ttree && fstat.usable()){
+            fbeg_ = fptraj.range().begin();
+            fend_ = fptraj.range().end();
+
+            nactivehit_ = nstrawhit_ = nnull_ = nscinthit_ = 0;
+            for(size_t ieff=0; ieff < kktrk.effects().size(); ieff++) {
+              auto const& eff = kktrk.effects()[ieff];
+              const KKMEAS* kkhit = dynamic_cast<const KKMEAS*>(eff.get());
+              const KKBFIELD* kkbf = dynamic_cast<const KKBFIELD*>(eff.get());
+              const KKMAT* kkmat = dynamic_cast<const KKMAT*>(eff.get());
+              if(kkhit != 0){
+                nkkhit_++;
+                const STRAWHIT* strawhit = dynamic_cast<const STRAWHIT*>(kkhit->hit().get());
+                const SCINTHIT* scinthit = dynamic_cast<const SCINTHIT*>(kkhit->hit().get());
+                const PARHIT* parhit = dynamic_cast<const PARHIT*>(kkhit->hit().get());
+                if(kkhit->active())nactivehit_++;
+                // hits dominating the reference information have no unbiased residuals or chisquared; skip them
+                try {
+                  kkhit->hit()->unbiasedParameters();
+                } catch (std::runtime_error const&) {
+                  continue;
+                }
+                HitInfo hinfo;
+                hinfo.active_ = kkhit->active();
+                hinfo.time_ = kkhit->time();
+                auto chisq = kkhit->hit()->chisquared();
+                hinfo.chisq_ = chisq.chisq();
+                hinfo.prob_ = chisq.probability();
+                hinfo.ndof_ = chisq.nDOF();
+                hinfo.state_ = -10;
+                hinfo.pos_ = fptraj.position3(kkhit->hit()->time());
+                hinfo.t0_ = 0.0;
+                hinfo.dresid_ = -1000.0;
+                hinfo.dresidvar_ =  -1.0;
+                hinfo.dresidpull_ =  -1000.0;
+                hinfo.tresid_ = -1000.0;
+                hinfo.tresidvar_ =  -1.0;
+                hinfo.tresidpull_ =  -1000.0;
+                if(strawhit != 0){
+                  if(strawhit->active()){
+                    nstrawhit_++;
+                    if(!strawhit->hitState().useDrift())nnull_++;
+                  }
+                  hinfo.type_ = HitInfo::straw;
+                  hinfo.state_ = strawhit->hitState().state_;
+                  hinfo.t0_ = strawhit->closestApproach().particleToca();
+                  hinfo.id_ = strawhit->id();
+                  hinfo.doca_ = strawhit->closestApproach().doca();
+                  hinfo.deltat_ = strawhit->closestApproach().deltaT();
+                  hinfo.docavar_ = strawhit->closestApproach().docaVar();
+                  hinfo.tocavar_ = strawhit->closestApproach().tocaVar();
+                  hinfo.dirdot_ = strawhit->closestApproach().dirDot();
+                 // straw hits can have multiple residuals
+                  if(strawhit->refResidual(STRAWHIT::tresid).active()){
+                    auto resid = strawhit->residual(STRAWHIT::tresid);
+                    hinfo.tresid_ = resid.value();
+                    hinfo.tresidvar_ = resid.variance();
+                    hinfo.tresidpull_ = resid.pull();
+                  }
+                  //
+                  if(strawhit->refResidual(STRAWHIT::dresid).active()){
+                    auto resid = strawhit->residual(STRAWHIT::dresid);
+                    hinfo.dresid_ = resid.value();
+                    hinfo.dresidvar_ = resid.variance();
+                    hinfo.dresidpull_ = resid.pull();
+                  }
+                  hinfovec.push_back(hinfo);
+                } else if(scinthit != 0){
+                  if(scinthit->active())nscinthit_++;
+                  hinfo.type_ = HitInfo::scint;
+                  auto resid = scinthit->residual(0);
                   hinfo.tresid_ = resid.value();
                   hinfo.tresidvar_ = resid.variance();
                   hinfo.tresidpull_ = resid.pull();
+                  hinfo.t0_ = scinthit->closestApproach().particleToca();
+                  hinfo.doca_ = scinthit->closestApproach().doca();
+                  hinfo.deltat_ = scinthit->closestApproach().deltaT();
+                  hinfo.docavar_ = scinthit->closestApproach().docaVar();
+                  hinfo.tocavar_ = scinthit->closestApproach().tocaVar();
+                  hinfo.dirdot_ = scinthit->closestApproach().dirDot();
+                  hinfovec.push_back(hinfo);
+                } else if(parhit != 0){
+                  hinfo.type_ = HitInfo::parcon;
+                  hinfo.dresid_ = sqrt(parhit->chisquared().chisq());
+                  hinfo.dresidvar_ = 1.0;
+                  hinfovec.push_back(hinfo);
+                } else {
+                  hinfo.type_ = HitInfo::unknown;
                 }
-                //
-                if(strawhit->refResidual(STRAWHIT::dresid).active()){
-                  auto resid = strawhit->residual(STRAWHIT::dresid);
-                  hinfo.dresid_ = resid.value();
-                  hinfo.dresidvar_ = resid.variance();
-                  hinfo.dresidpull_ = resid.pull();
+              }
+              if(kkmat != 0){
+                nkkmat_++;
+                KinKal::MaterialInfo minfo;
+                minfo.time_ = kkmat->time();
+                minfo.active_ = kkmat->active();
+                minfo.nxing_ = kkmat->elementXing().matXings().size();
+                std::array<double,3> dmom = {0.0,0.0,0.0}, momvar = {0.0,0.0,0.0};
+                kkmat->elementXing().materialEffects(TimeDir::forwards, dmom, momvar);
+                minfo.dmomf_ = dmom[MomBasis::momdir_];
+                minfo.momvar_ = momvar[MomBasis::momdir_];
+                minfo.perpvar_ = momvar[MomBasis::perpdir_];
+                STRAWXING* sxing = dynamic_cast<STRAWXING*>(kkmat->elementXingPtr().get());
+                if(sxing != 0){
+                  minfo.doca_ = sxing->closestApproach().doca();
+                  minfo.docavar_ = sxing->closestApproach().docaVar();
+                  minfo.dirdot_ = sxing->closestApproach().dirDot();
                 }
-                hinfovec.push_back(hinfo);
-              } else if(scinthit != 0){
-                if(scinthit->active())nscinthit_++;
-                hinfo.type_ = HitInfo::scint;
-                auto resid = scinthit->residual(0);
-                hinfo.tresid_ = resid.value();
-                hinfo.tresidvar_ = resid.variance();
-                hinfo.tresidpull_ = resid.pull();
-                hinfo.t0_ = scinthit->closestApproach().particleToca();
-                hinfo.doca_ = scinthit->closestApproach().doca();
-                hinfo.deltat_ = scinthit->closestApproach().deltaT();
-                hinfo.docavar_ = scinthit->closestApproach().docaVar();
-                hinfo.tocavar_ = scinthit->closestApproach().tocaVar();
-                hinfo.dirdot_ = scinthit->closestApproach().dirDot();
-                hinfovec.push_back(hinfo);
-              } else if(parhit != 0){
-                hinfo.type_ = HitInfo::parcon;
-                hinfo.dresid_ = sqrt(parhit->chisquared().chisq());
-                hinfo.dresidvar_ = 1.0;
-                hinfovec.push_back(hinfo);
-              } else {
-                hinfo.type_ = HitInfo::unknown;
+                minfovec.push_back(minfo);
               }
-            }
-            if(kkmat != 0){
-              nkkmat_++;
-              KinKal::MaterialInfo minfo;
-              minfo.time_ = kkmat->time();
-              minfo.active_ = kkmat->active();
-              minfo.nxing_ = kkmat->elementXing().matXings().size();
-              std::array<double,3> dmom = {0.0,0.0,0.0}, momvar = {0.0,0.0,0.0};
-              kkmat->elementXing().materialEffects(TimeDir::forwards, dmom, momvar);
-              minfo.dmomf_ = dmom[MomBasis::momdir_];
-              minfo.momvar_ = momvar[MomBasis::momdir_];
-              minfo.perpvar_ = momvar[MomBasis::perpdir_];
-              STRAWXING* sxing = dynamic_cast<STRAWXING*>(kkmat->elementXingPtr().get());
-              if(sxing != 0){
-                minfo.doca_ = sxing->closestApproach().doca();
-                minfo.docavar_ = sxing->closestApproach().docaVar();
-                minfo.dirdot_ = sxing->closestApproach().dirDot();
+              if(kkbf != 0){
+                nkkbf_++;
+                BFieldInfo bfinfo;
+                bfinfo.active_ = kkbf->active();
+                bfinfo.time_ = kkbf->time();
+                bfinfo.range_ = kkbf->range().range();
+                bfinfovec.push_back(bfinfo);
               }
-              minfovec.push_back(minfo);
             }
-            if(kkbf != 0){
-              nkkbf_++;
-              BFieldInfo bfinfo;
-              bfinfo.active_ = kkbf->active();
-              bfinfo.time_ = kkbf->time();
-              bfinfo.range_ = kkbf->range().range();
-              bfinfovec.push_back(bfinfo);
+            fft_ = fptraj.range().begin();
+            mft_ = fptraj.range().mid();
+            bft_ = fptraj.range().end();
+            // extract fit parameters and errors
+            for(size_t ipar=0;ipar<6;ipar++){
+              ffitpars_.pars_[ipar] = fftraj.params().parameters()[ipar];
+              mfitpars_.pars_[ipar] = mftraj.params().parameters()[ipar];
+              bfitpars_.pars_[ipar] = bftraj.params().parameters()[ipar];
+              ffiterrs_.pars_[ipar] = sqrt(fftraj.params().covariance()(ipar,ipar));
+              mfiterrs_.pars_[ipar] = sqrt(mftraj.params().covariance()(ipar,ipar));
+              bfiterrs_.pars_[ipar] = sqrt(bftraj.params().covariance()(ipar,ipar));
             }
-          }
-          fft_ = fptraj.range().begin();
-          mft_ = fptraj.range().mid();
-          bft_ = fptraj.range().end();
-          // extract fit parameters and errors
-          for(size_t ipar=0;ipar<6;ipar++){
-            ffitpars_.pars_[ipar] = fftraj.params().parameters()[ipar];
-            mfitpars_.pars_[ipar] = mftraj.params().parameters()[ipar];
-            bfitpars_.pars_[ipar] = bftraj.params().parameters()[ipar];
-            ffiterrs_.pars_[ipar] = sqrt(fftraj.params().covariance()(ipar,ipar));
-            mfiterrs_.pars_[ipar] = sqrt(mftraj.params().covariance()(ipar,ipar));
-            bfiterrs_.pars_[ipar] = sqrt(bftraj.params().covariance()(ipar,ipar));
-          }
 
-          // step through the fit traj and compare to the truth
-          auto const& fptraj = kktrk.fitTraj();
-          double dt = fptraj.range().range()/nsteps;
-          for(unsigned istep=0;istep < nsteps;istep++){
-            double tstep = fptraj.range().begin()+dt*istep;
-            double ttrue;
-            double dperp = dTraj(fptraj,tptraj,tstep,ttrue);
-            ParticleTrajectoryInfo ktinfo;
-            ktinfo.time_ = tstep;
-            ktinfo.dperp_ = dperp;
-            ktinfo.dt_= tstep-ttrue;
-            tinfovec.push_back(ktinfo);
+            // step through the fit traj and compare to the truth
+            auto const& fptraj = kktrk.fitTraj();
+            double dt = fptraj.range().range()/nsteps;
+            for(unsigned istep=0;istep < nsteps;istep++){
+              double tstep = fptraj.range().begin()+dt*istep;
+              double ttrue;
+              double dperp = dTraj(fptraj,tptraj,tstep,ttrue);
+              ParticleTrajectoryInfo ktinfo;
+              ktinfo.time_ = tstep;
+              ktinfo.dperp_ = dperp;
+              ktinfo.dt_= tstep-ttrue;
+              tinfovec.push_back(ktinfo);
+            }
+            double maxgap, avgap;
+            size_t igap;
+            fptraj.gaps(maxgap, igap, avgap);
+            maxgap_ = maxgap;
+            avgap_ = avgap;
+            igap_ = igap;
           }
-          double maxgap, avgap;
-          size_t igap;
-          fptraj.gaps(maxgap, igap, avgap);
-          maxgap_ = maxgap;
-          avgap_ = avgap;
-          igap_ = igap;
+        } else if(printbad){
+          cout << "Bad Fit event " << ievent << " status " << kktrk.fitStatus() << endl;
+          cout << "True Traj " << tptraj << endl;
+          cout << "Seed Traj " << seedtraj << endl;
+          kktrk.print(cout,detail);
         }
-      } else if(printbad){
-        cout << "Bad Fit event " << ievent << " status " << kktrk.fitStatus() << endl;
-        cout << "True Traj " << tptraj << endl;
-        cout << "Seed Traj " << seedtraj << endl;
-        kktrk.print(cout,detail);
+        if(ttree)ftree->Fill();
       }
-      if(ttree)ftree->Fill();
     }
+    auto wallstop = Clock::now();
+    cout <<"Wall time/event = " << std::chrono::duration_cast<std::chrono::nanoseconds>(wallstop - wallstart).count()/double(std::max(1u,nevents))
+      << " Nanoseconds " << endl;
     // Test fit success
     cout
       << nconv << " Converged fits "
@@ -993,6 +1072,14 @@ int FitTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
       retval = -2;
     }
     cout <<"Time/fit = " << duration/double(nevents) << " Nanoseconds " << endl;
+    if(ntotiter > 0)cout <<"Time/iteration = " << duration/double(ntotiter) << " Nanoseconds " << endl;
+    if(cachestates){
+      cout << "Maximum unbiased pull difference using cached fit states " << maxdpull << endl;
+      if(maxdpull > maxdpulltol){
+        cout << "Unbiased pull difference using cached fit states out of tolerance " << maxdpulltol << endl;
+        retval = -4;
+      }
+    }
     // fill canvases
     TCanvas* fdpcan = new TCanvas("fdpcan","fdpcan",800,600);
     fdpcan->Divide(3,3);
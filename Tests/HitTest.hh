@@ -294,6 +294,83 @@ int HitTest(int argc, char **argv, const vector<double>& delpars) {
       }
     }
   }
+  // test the rank-1 (Sherman-Morrison) parameter-space update of each hit against adding its weight and re-inverting
+  double maxpdiff(0.0);
+  for(auto& thit : thits) {
+    PTRAJ reftraj(tptraj.nearestPiece(thit->time()));
+    thit->updateReference(reftraj.backPtr());
+    thit->updateState(miconfig,false);
+    if(!thit->active())continue;
+    // state offset from the reference, with uncorrelated errors the size of the derivative test steps
+    Parameters refpars(thit->referenceParameters());
+    refpars.covariance() = DMAT();
+    for(size_t ipar=0;ipar < NParams();ipar++){
+      refpars.parameters()[ipar] += 0.3*delpars[ipar];
+      refpars.covariance()(ipar,ipar) = delpars[ipar]*delpars[ipar];
+    }
+    Parameters kpars(refpars);
+    if(!thit->kalmanUpdate(kpars)){
+      cout << "Kalman update failure for hit " << *thit << endl;
+      status = 4;
+      continue;
+    }
+    Weights wsum(refpars);
+    wsum += thit->weight();
+    Parameters wpars(wsum);
+    // compare relative to the parameter errors
+    for(size_t ipar=0;ipar < NParams();ipar++){
+      double perr = sqrt(wpars.covariance()(ipar,ipar));
+      maxpdiff = std::max(maxpdiff,fabs(kpars.parameters()[ipar]-wpars.parameters()[ipar])/perr);
+      for(size_t jpar=0;jpar < NParams();jpar++)
+        maxpdiff = std::max(maxpdiff,fabs(kpars.covariance()(ipar,jpar)-wpars.covariance()(ipar,jpar))/(perr*sqrt(wpars.covariance()(jpar,jpar))));
+    }
+  }
+  cout << "Maximum relative difference of the parameter-space hit update " << maxpdiff << endl;
+  if(maxpdiff > 1.0e-8){
+    cout << "Parameter-space hit update out of tolerance" << endl;
+    status = 4;
+  }
+  // test adding the straw material noise in weight space (Woodbury) against adding it in parameter space and re-inverting
+  StrawXingConfig xsxconfig(0.3,5.0,10.0,false);
+  MetaIterConfig xmiconfig;
+  xmiconfig.addUpdater(std::any(xsxconfig));
+  double maxwdiff(0.0);
+  for(auto& dxing : dxings) {
+    STRAWXING* sxing = dynamic_cast<STRAWXING*>(dxing.get());
+    if(sxing == 0)continue;
+    sxing->updateState(xmiconfig,true);
+    if(sxing->matXings().size() == 0)continue;
+    // reference state with uncorrelated errors the size of the derivative test steps
+    Parameters refpars(sxing->referenceTrajectory().params());
+    refpars.covariance() = DMAT();
+    for(size_t ipar=0;ipar < NParams();ipar++) refpars.covariance()(ipar,ipar) = delpars[ipar]*delpars[ipar];
+    for(TimeDir tdir=TimeDir::forwards; tdir < TimeDir::end; ++tdir){
+      DVEC dpvec;
+      typename STRAWXING::NOISEFACTOR gmat;
+      Weights wnoise(refpars);
+      if(!(sxing->lowRankParameters(tdir,dpvec,gmat) && wnoise.addNoise(dpvec,gmat))){
+        cout << "Low-rank noise failure at time " << sxing->time() << endl;
+        status = 3;
+        continue;
+      }
+      Parameters ppars(refpars);
+      ppars.parameters() += sxing->parameters(tdir).parameters();
+      ppars.covariance() += sxing->parameters(tdir).covariance();
+      Parameters wpars(wnoise);
+      // compare relative to the parameter errors
+      for(size_t ipar=0;ipar < NParams();ipar++){
+        double perr = sqrt(ppars.covariance()(ipar,ipar));
+        maxwdiff = std::max(maxwdiff,fabs(wpars.parameters()[ipar]-ppars.parameters()[ipar])/perr);
+        for(size_t jpar=0;jpar < NParams();jpar++)
+          maxwdiff = std::max(maxwdiff,fabs(wpars.covariance()(ipar,jpar)-ppars.covariance()(ipar,jpar))/(perr*sqrt(ppars.covariance()(jpar,jpar))));
+      }
+    }
+  }
+  cout << "Maximum relative difference of weight-space material noise " << maxwdiff << endl;
+  if(maxwdiff > 1.0e-8){
+    cout << "Weight-space material noise out of tolerance" << endl;
+    status = 3;
+  }
   // test
   TF1* pline = new TF1("pline","[0]+[1]*x");
 
@@ -0,0 +1,26 @@
+#include "KinKal/Trajectory/LoopHelix.hh"
+#include "KinKal/Tests/FitTest.hh"
+int main(int argc, char **argv) {
+  KinKal::DVEC sigmas(0.5, 0.5, 0.5, 0.5, 0.02, 0.5); // expected parameter sigmas
+  if(argc == 1){
+    cout << "Testing gradient field, correction 2, caching the fit states" << endl;
+    std::vector<std::string> arguments;
+    arguments.push_back(argv[0]);
+    arguments.push_back("--Bgrad");
+    arguments.push_back("-0.036"); // mu2e-like field gradient
+    arguments.push_back("--Schedule");
+    arguments.push_back("driftfit.txt");
+    arguments.push_back("--ttree");
+    arguments.push_back("1");
+    arguments.push_back("--CacheStates");
+    arguments.push_back("1");
+    arguments.push_back("--TFilesuffix");
+    arguments.push_back("CacheStates");
+    std::vector<char*> myargv;
+    for (const auto& arg : arguments)
+      myargv.push_back((char*)arg.data());
+    myargv.push_back(nullptr);
+    return FitTest<LoopHelix>(myargv.size()-1,myargv.data(),sigmas);
+  } else
+  return FitTest<LoopHelix>(argc,argv,sigmas);
+}
@@ -0,0 +1,24 @@
+#include "KinKal/Trajectory/LoopHelix.hh"
+#include "KinKal/Tests/FitOptionTest.hh"
+int main(int argc, char **argv) {
+  KinKal::DVEC sigmas(0.5, 0.5, 0.5, 0.5, 0.02, 0.5); // expected parameter sigmas
+  if(argc == 1){
+    // refit incrementally after a series of seed changes, each below Config::inctol_ but together above it.  The cached states must
+    // be rebuilt once the seed has drifted by more than the tolerance from the one they include, so the result still agrees with the
+    // full refit to 5% of the chisquared and parameter errors, as in LoopHelixIncremental
+    std::vector<std::string> arguments;
+    arguments.push_back(argv[0]);
+    arguments.push_back("--Option");
+    arguments.push_back("Incremental");
+    arguments.push_back("--tolerance");
+    arguments.push_back("0.05");
+    arguments.push_back("--seedsteps");
+    arguments.push_back("10");
+    std::vector<char*> myargv;
+    for (const auto& arg : arguments)
+      myargv.push_back((char*)arg.data());
+    myargv.push_back(nullptr);
+    return FitOptionTest<LoopHelix>(myargv.size()-1,myargv.data(),sigmas);
+  } else
+  return FitOptionTest<LoopHelix>(argc,argv,sigmas);
+}
@@ -0,0 +1,22 @@
+#include "KinKal/Trajectory/LoopHelix.hh"
+#include "KinKal/Tests/FitOptionTest.hh"
+int main(int argc, char **argv) {
+  KinKal::DVEC sigmas(0.5, 0.5, 0.5, 0.5, 0.02, 0.5); // expected parameter sigmas
+  if(argc == 1){
+    // incremental fits reuse states around effects (and seeds) which changed by less than Config::inctol_ (1e-3 chisquared),
+    // so they approximate the full refit.  A reused contribution can shift the parameters by up to sqrt(inctol) ~ 3% of their errors:
+    // require agreement to 5% of the chisquared and parameter errors
+    std::vector<std::string> arguments;
+    arguments.push_back(argv[0]);
+    arguments.push_back("--Option");
+    arguments.push_back("Incremental");
+    arguments.push_back("--tolerance");
+    arguments.push_back("0.05");
+    std::vector<char*> myargv;
+    for (const auto& arg : arguments)
+      myargv.push_back((char*)arg.data());
+    myargv.push_back(nullptr);
+    return FitOptionTest<LoopHelix>(myargv.size()-1,myargv.data(),sigmas);
+  } else
+  return FitOptionTest<LoopHelix>(argc,argv,sigmas);
+}
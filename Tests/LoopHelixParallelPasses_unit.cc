@@ -0,0 +1,20 @@
+#include "KinKal/Trajectory/LoopHelix.hh"
+#include "KinKal/Tests/FitOptionTest.hh"
+int main(int argc, char **argv) {
+  KinKal::DVEC sigmas(0.5, 0.5, 0.5, 0.5, 0.02, 0.5); // expected parameter sigmas
+  if(argc == 1){
+    // the passes only touch their own direction's data, so running them concurrently must give bit-identical results
+    std::vector<std::string> arguments;
+    arguments.push_back(argv[0]);
+    arguments.push_back("--Option");
+    arguments.push_back("MinParallel");
+    arguments.push_back("--tolerance");
+    arguments.push_back("0.0");
+    std::vector<char*> myargv;
+    for (const auto& arg : arguments)
+      myargv.push_back((char*)arg.data());
+    myargv.push_back(nullptr);
+    return FitOptionTest<LoopHelix>(myargv.size()-1,myargv.data(),sigmas);
+  } else
+  return FitOptionTest<LoopHelix>(argc,argv,sigmas);
+}
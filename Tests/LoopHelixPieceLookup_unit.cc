@@ -0,0 +1,5 @@
+#include "KinKal/Trajectory/LoopHelix.hh"
+#include "KinKal/Tests/PieceLookupTest.hh"
+int main(int argc, char **argv) {
+  return PieceLookupTest<LoopHelix>(argc,argv);
+}
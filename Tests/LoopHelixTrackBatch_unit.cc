@@ -0,0 +1,6 @@
+#include "KinKal/Trajectory/LoopHelix.hh"
+#include "KinKal/Tests/TrackBatchTest.hh"
+int main(int argc, char **argv) {
+  KinKal::DVEC sigmas(0.5, 0.5, 0.5, 0.5, 0.02, 0.5); // expected parameter sigmas
+  return TrackBatchTest<LoopHelix>(argc,argv,sigmas);
+}
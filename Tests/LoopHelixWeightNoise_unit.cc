@@ -0,0 +1,22 @@
+#include "KinKal/Trajectory/LoopHelix.hh"
+#include "KinKal/Tests/FitOptionTest.hh"
+int main(int argc, char **argv) {
+  KinKal::DVEC sigmas(0.5, 0.5, 0.5, 0.5, 0.02, 0.5); // expected parameter sigmas
+  if(argc == 1){
+    // adding the material noise to the weights (Woodbury) is algebraically identical to adding it to the parameters and re-inverting,
+    // so the fits differ only by rounding.  Require agreement to 1e-6 of the chisquared and parameter errors, far below the
+    // convergence tolerance but well above the ~1e-12 rounding of the inversions
+    std::vector<std::string> arguments;
+    arguments.push_back(argv[0]);
+    arguments.push_back("--Option");
+    arguments.push_back("WeightNoise");
+    arguments.push_back("--tolerance");
+    arguments.push_back("1.0e-6");
+    std::vector<char*> myargv;
+    for (const auto& arg : arguments)
+      myargv.push_back((char*)arg.data());
+    myargv.push_back(nullptr);
+    return FitOptionTest<LoopHelix>(myargv.size()-1,myargv.data(),sigmas);
+  } else
+  return FitOptionTest<LoopHelix>(argc,argv,sigmas);
+}
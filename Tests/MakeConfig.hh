@@ -0,0 +1,90 @@
+#ifndef KinKal_MakeConfig_hh
+#define KinKal_MakeConfig_hh
+//
+//  Read a fit configuration (global parameters and meta-iteration schedule) from a text file, as used by the tests and benchmarks.
+//  Relative file names are found in $KINKAL_SOURCE_DIR/Tests
+//
+#include "KinKal/Fit/Config.hh"
+#include "KinKal/Detector/StrawXingConfig.hh"
+#include "KinKal/Examples/SimpleWireHit.hh"
+#include "KinKal/Examples/DOCAWireHitUpdater.hh"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <any>
+#include <cstdlib>
+#include <cstring>
+
+namespace KKTest {
+  // Each meta-iteration line is 'temperature updater [updater parameters] [tcaprec [tcamaxiter]]'.  The optional fields set the TCA
+  // precision (ns, 0 = the nominal precision of each hit and xing) and iteration limit of that meta-iteration (see MetaIterConfig::setTCAPolicy).
+  // Positive tcaprec and tcamaxiter arguments override the file for the annealing (temp > 0) meta-iterations
+  inline int makeConfig(std::string const& cfile, KinKal::Config& config,bool mvarscale=true, double tcaprec=0.0, unsigned tcamaxiter=0, bool verbose=true) {
+    using namespace KinKal;
+    std::string fullfile;
+    if(strncmp(cfile.c_str(),"/",1) == 0) {
+      fullfile = std::string(cfile);
+    } else {
+      if(const char* source = std::getenv("KINKAL_SOURCE_DIR")){
+        fullfile = std::string(source) + std::string("/Tests/") + std::string(cfile);
+      } else {
+        std::cout << "KINKAL_SOURCE_DIR not defined" << std::endl;
+        return -1;
+      }
+    }
+    std::ifstream ifs (fullfile, std::ifstream::in);
+    if ( (ifs.rdstate() & std::ifstream::failbit ) != 0 ){
+      std::cerr << "Error opening " << fullfile << std::endl;
+      return -1;
+    }
+    std::string line;
+    int plevel(-1);
+    unsigned nmiter(0);
+    while (getline(ifs,line)){
+      if(strncmp(line.c_str(),"#",1)!=0){
+        std::istringstream ss(line);
+        if(plevel < 0) {
+          ss >> config.maxniter_ >> config.dwt_ >> config.convdchisq_ >> config.divdchisq_ >>
+            config.pdchisq_ >> config.tol_ >> config.minndof_ >> config.bfcorr_ >>
+            config.ends_ >> plevel;
+          config.plevel_ = Config::printLevel(plevel);
+        } else {
+          int utype(-1);
+          double temp, mindoca(-1.0),maxdoca(-1.0);
+          ss >> temp >> utype;
+          MetaIterConfig miconfig(temp);
+          miconfig.addUpdater(StrawXingConfig(0.3,5.0,10.0,mvarscale)); // hardcoded values, should come from outside, FIXME
+          if(utype == 0 ){
+            if(verbose) std::cout << "NullWireHitUpdater for iteration " << nmiter << std::endl;
+            miconfig.addUpdater(std::any(NullWireHitUpdater()));
+          } else if(utype == 1) {
+            ss >>  mindoca >> maxdoca;
+            if(verbose) std::cout << "DOCAWireHitUpdater for iteration " << nmiter << " with mindoca " << mindoca << " maxdoca " << maxdoca  << std::endl;
+            DOCAWireHitUpdater updater(mindoca,maxdoca);
+            miconfig.addUpdater(std::any(updater));
+          } else if(utype > 0){
+            std::cout << "Unknown updater " << utype << std::endl;
+            return -20;
+          }
+          // optional TCA policy, and the overrides
+          double lprec(miconfig.tcaPrecision()), fprec;
+          unsigned lmaxiter(miconfig.tcaMaxIterations()), fmaxiter;
+          if(ss >> fprec){
+            lprec = fprec;
+            if(ss >> fmaxiter) lmaxiter = fmaxiter;
+          }
+          if(temp > 0.0 && tcaprec > 0.0) lprec = tcaprec;
+          if(temp > 0.0 && tcamaxiter > 0) lmaxiter = tcamaxiter;
+          miconfig.setTCAPolicy(lprec,lmaxiter);
+          if(verbose && (lprec > 0.0 || lmaxiter != MetaIterConfig().tcaMaxIterations()))
+            std::cout << "TCA precision " << lprec << " max iterations " << lmaxiter << " for iteration " << nmiter << std::endl;
+          config.schedule_.push_back(miconfig);
+          ++nmiter;
+        }
+      }
+    }
+    return 0;
+  }
+}
+#endif
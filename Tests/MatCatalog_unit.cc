@@ -0,0 +1,197 @@
+//
+// test that the binary material catalog image reproduces the text lists, and time loading both
+//
+#include "KinKal/MatEnv/MatCatalog.hh"
+#include "KinKal/MatEnv/SimpleFileFinder.hh"
+
+#include <iostream>
+#include <fstream>
+#include <stdio.h>
+#include <getopt.h>
+#include <chrono>
+#include <iterator>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace MatEnv;
+using namespace std;
+
+void print_usage() {
+  printf("Usage: MatCatalog --image s\n");
+}
+
+// find the lists in the standard place, and the image in the test file
+class ImageFileFinder : public SimpleFileFinder {
+  public:
+    ImageFileFinder(string const& image) : image_(image) {}
+    string matCatalogFileName() const override { return image_; }
+  private:
+    string image_;
+};
+
+bool sameMaterial(MatMaterialObj const& m1, MatMaterialObj const& m2) {
+  if(m1.getName() != m2.getName() || m1.getDensity() != m2.getDensity() || m1.getZeff() != m2.getZeff()
+      || m1.getAeff() != m2.getAeff() || m1.getNbrComp() != m2.getNbrComp() || m1.getRadLength() != m2.getRadLength()
+      || m1.getIntLength() != m2.getIntLength() || m1.getRefIndex() != m2.getRefIndex()
+      || m1.getTemperature() != m2.getTemperature() || m1.getPressure() != m2.getPressure()
+      || m1.getState() != m2.getState() || m1.getTcut() != m2.getTcut())return false;
+  for(int icomp=0; icomp < abs(m1.getNbrComp()); ++icomp)
+    if(m1.getIflg(icomp) != m2.getIflg(icomp) || m1.getWeight(icomp) != m2.getWeight(icomp)
+        || m1.getCompName(icomp) != m2.getCompName(icomp))return false;
+  return true;
+}
+
+bool sameElement(MatElementObj const& e1, MatElementObj const& e2) {
+  if(e1.getName() != e2.getName() || e1.getSymbol() != e2.getSymbol() || e1.getZeff() != e2.getZeff()
+      || e1.getAeff() != e2.getAeff() || e1.getNbrIsotope() != e2.getNbrIsotope())return false;
+  for(int iiso=0; iiso < e1.getNbrIsotope(); ++iiso)
+    if(e1.getWeight(iiso) != e2.getWeight(iiso) || e1.getIsotopeName(iiso) != e2.getIsotopeName(iiso))return false;
+  return true;
+}
+
+int main(int argc, char **argv) {
+  using Clock = std::chrono::high_resolution_clock;
+  string image = string("MatCatalog_") + to_string(getpid()) + string(".bin");
+  static struct option long_options[] = {
+    {"image",     required_argument, 0, 'i'  },
+    {NULL, 0,0,0}
+  };
+  int long_index =0;
+  int opt;
+  while ((opt = getopt_long_only(argc, argv,"",
+          long_options, &long_index )) != -1) {
+    switch (opt) {
+      case 'i' : image = string(optarg);
+                 break;
+      default: print_usage();
+               exit(EXIT_FAILURE);
+    }
+  }
+  int retval(EXIT_SUCCESS);
+  SimpleFileFinder sfinder;
+  // parse the text lists
+  auto start = Clock::now();
+  MatIsotopeList isolist(sfinder.matIsoDictionaryFileName());
+  MatElementList elmlist(sfinder.matElmDictionaryFileName());
+  MatMaterialList mtrlist(sfinder.matMtrDictionaryFileName());
+  auto stop = Clock::now();
+  double ttext = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+  auto srcs = MatCatalog::sources(sfinder);
+  uint64_t srchash = srcs.hash;
+  if(srchash == 0){
+    cout << "Can't read the material lists" << endl;
+    return -1;
+  }
+  MatCatalog::write(image,*isolist.getIsotopeVector(),*elmlist.getElementVector(),*mtrlist.getMaterialVector(),srcs);
+  // load the image
+  start = Clock::now();
+  MatCatalog catalog(image,srchash);
+  if(!catalog.valid()){
+    cout << "Failed to load " << image << endl;
+    return -1;
+  }
+  auto cisolist = catalog.isotopeList();
+  auto celmlist = catalog.elementList();
+  auto cmtrlist = catalog.materialList();
+  stop = Clock::now();
+  double timage = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+  cout << "Load time (us) text " << ttext << " image " << timage << endl;
+  // compare
+  auto const& isos = *isolist.getIsotopeVector();
+  auto const& cisos = *cisolist->getIsotopeVector();
+  auto const& elms = *elmlist.getElementVector();
+  auto const& celms = *celmlist->getElementVector();
+  auto const& mtrs = *mtrlist.getMaterialVector();
+  auto const& cmtrs = *cmtrlist->getMaterialVector();
+  if(isos.size() != cisos.size() || elms.size() != celms.size() || mtrs.size() != cmtrs.size()){
+    cout << "Catalog sizes don't match" << endl;
+    retval = -2;
+  } else {
+    for(size_t iiso=0; iiso < isos.size(); ++iiso){
+      if(!(*isos[iiso] == *cisos[iiso])){
+        cout << "Isotope " << isos[iiso]->getName() << " doesn't match" << endl;
+        retval = -3;
+      }
+    }
+    for(size_t ielm=0; ielm < elms.size(); ++ielm){
+      if(!sameElement(*elms[ielm],*celms[ielm])){
+        cout << "Element " << elms[ielm]->getName() << " doesn't match" << endl;
+        retval = -3;
+      }
+    }
+    for(size_t imtr=0; imtr < mtrs.size(); ++imtr){
+      if(!sameMaterial(*mtrs[imtr],*cmtrs[imtr])){
+        cout << "Material " << mtrs[imtr]->getName() << " doesn't match" << endl;
+        retval = -3;
+      }
+    }
+  }
+  // an image compiled from different lists must be rejected as stale
+  {
+    MatCatalog scatalog(image,srchash+1);
+    if(scatalog.valid() || catalog.sourceHash() != srchash){
+      cout << "Stale image not rejected" << endl;
+      retval = -5;
+    }
+  }
+  // the file finder checks the image against the list stamps, falling back to the hash when only the times differ
+  {
+    ImageFileFinder ifinder(image);
+    start = Clock::now();
+    MatCatalog fcatalog(ifinder);
+    stop = Clock::now();
+    double tstamp = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+    start = Clock::now();
+    MatCatalog hcatalog(ifinder,true);
+    stop = Clock::now();
+    double thash = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+    cout << "Image check time (us) stamps " << tstamp << " hash " << thash << endl;
+    if(!fcatalog.valid() || !hcatalog.valid()){
+      cout << "Current image rejected" << endl;
+      retval = -5;
+    }
+    string simage = image + string(".stamps");
+    ImageFileFinder stfinder(simage);
+    auto tsrcs = srcs;
+    tsrcs.mtimes[2] += 1;
+    MatCatalog::write(simage,*isolist.getIsotopeVector(),*elmlist.getElementVector(),*mtrlist.getMaterialVector(),tsrcs);
+    if(!MatCatalog(stfinder).valid()){
+      cout << "Image with matching contents but different times rejected" << endl;
+      retval = -5;
+    }
+    tsrcs.hash += 1;
+    MatCatalog::write(simage,*isolist.getIsotopeVector(),*elmlist.getElementVector(),*mtrlist.getMaterialVector(),tsrcs);
+    if(MatCatalog(stfinder).valid()){
+      cout << "Stale image with different times not rejected" << endl;
+      retval = -5;
+    }
+    tsrcs = srcs;
+    tsrcs.sizes[0] += 1;
+    MatCatalog::write(simage,*isolist.getIsotopeVector(),*elmlist.getElementVector(),*mtrlist.getMaterialVector(),tsrcs);
+    if(MatCatalog(stfinder).valid()){
+      cout << "Stale image with different sizes not rejected" << endl;
+      retval = -5;
+    }
+    remove(simage.c_str());
+  }
+  // a truncated image must be rejected, as must a missing file
+  {
+    std::ifstream in(image,std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+    std::string truncated = image + string(".trunc");
+    std::ofstream out(truncated,std::ios::binary);
+    out.write(bytes.data(),bytes.size()/2);
+    out.close();
+    MatCatalog tcatalog(truncated);
+    MatCatalog mcatalog(image + string(".missing"));
+    if(tcatalog.valid() || mcatalog.valid()){
+      cout << "Invalid image not rejected" << endl;
+      retval = -4;
+    }
+    remove(truncated.c_str());
+  }
+  remove(image.c_str());
+  if(retval == EXIT_SUCCESS) cout << "Catalog image matches the text lists: " << catalog.nIsotopes() << " isotopes, "
+    << catalog.nElements() << " elements, " << catalog.nMaterials() << " materials" << endl;
+  return retval;
+}
@@ -0,0 +1,170 @@
+//
+// test the interpolated material energy loss and dEdx against the analytic calculations, and the batch functions
+// against the scalar functions, and time them
+//
+#include "KinKal/MatEnv/MatDBInfo.hh"
+#include "KinKal/MatEnv/DetMaterial.hh"
+#include "KinKal/MatEnv/SimpleFileFinder.hh"
+
+#include <iostream>
+#include <stdio.h>
+#include <getopt.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <functional>
+#include <tuple>
+
+#include "TRandom3.h"
+
+using namespace MatEnv;
+using namespace std;
+
+void print_usage() {
+  printf("Usage: MatTable --ntest i --tolerance f --pmin f --pmax f\n");
+}
+
+int main(int argc, char **argv) {
+  using Clock = std::chrono::high_resolution_clock;
+  unsigned ntest(100000);
+  MatDBInfo::TableConfig tconfig;
+  tconfig.masses = {0.511, 105.66, 139.57, 938.27}; // e, mu, pi, p
+  static struct option long_options[] = {
+    {"ntest",     required_argument, 0, 'n'  },
+    {"tolerance",     required_argument, 0, 't'  },
+    {"pmin",     required_argument, 0, 'l'  },
+    {"pmax",     required_argument, 0, 'h'  },
+    {NULL, 0,0,0}
+  };
+  int long_index =0;
+  int opt;
+  while ((opt = getopt_long_only(argc, argv,"",
+          long_options, &long_index )) != -1) {
+    switch (opt) {
+      case 'n' : ntest = atoi(optarg);
+                 break;
+      case 't' : tconfig.tolerance = atof(optarg);
+                 break;
+      case 'l' : tconfig.pmin = atof(optarg);
+                 break;
+      case 'h' : tconfig.pmax = atof(optarg);
+                 break;
+      default: print_usage();
+               exit(EXIT_FAILURE);
+    }
+  }
+  int retval(EXIT_SUCCESS);
+  std::vector<std::string> matnames = {"straw-wall", "straw-gas", "straw-wire", "Mylar", "HeCF4", "CsI", "Target"};
+  MatEnv::SimpleFileFinder sfinder;
+  MatDBInfo analytic(sfinder,MatEnv::DetMaterial::moyalmean,matnames);
+  auto start = Clock::now();
+  MatDBInfo tabulated(sfinder,MatEnv::DetMaterial::moyalmean,tconfig,matnames);
+  auto stop = Clock::now();
+  cout << "Tabulated " << matnames.size() << " materials for " << tconfig.masses.size() << " masses in "
+    << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms" << endl;
+  // sample momenta uniformly in log within the table range, and path lengths typical of tracker materials (mm).  The accuracy is also
+  // tested for thin layers, where the log term of the MPV energy loss cancels most of the tabulated factor
+  TRandom3 tr(34567);
+  std::vector<double> moms(ntest), plens(ntest), thinplens(ntest), masses(ntest);
+  for(unsigned itest=0; itest < ntest; itest++){
+    moms[itest] = tconfig.pmin*exp(tr.Uniform(0.0,log(tconfig.pmax/tconfig.pmin)));
+    plens[itest] = exp(tr.Uniform(log(1.0e-3),log(10.0)));
+    thinplens[itest] = exp(tr.Uniform(log(1.0e-9),log(1.0e-3)));
+    masses[itest] = tconfig.masses[tr.Integer(tconfig.masses.size())];
+  }
+  // functions to compare.  The tolerance bounds the relative error of each of these, including the energy loss in thin layers
+  using MATFUNC = std::function<double(DetMaterial const&, double, double, double)>;
+  struct TestFunc {
+    std::string name;
+    MATFUNC func;
+  };
+  std::vector<TestFunc> funcs = {
+    {"energyLoss", [](DetMaterial const& dmat, double mom, double plen, double mass) { return dmat.energyLoss(mom,plen,mass); } },
+    {"energyLossMPV", [](DetMaterial const& dmat, double mom, double plen, double mass) { return dmat.energyLossMPV(mom,plen,mass); } },
+    {"dEdx", [](DetMaterial const& dmat, double mom, double, double mass) { return dmat.dEdx(mom,DetMaterial::loss,mass); } },
+    {"dEdx deposit", [](DetMaterial const& dmat, double mom, double, double mass) { return dmat.dEdx(mom,DetMaterial::deposit,mass); } }
+  };
+  for(auto const& matname : matnames){
+    auto const* amat = analytic.findDetMaterial(matname);
+    auto const* tmat = tabulated.findDetMaterial(matname);
+    if(amat == 0 || tmat == 0 || !tmat->tabulated(tconfig.masses.front()) || amat->tabulated(tconfig.masses.front())){
+      cout << "Material " << matname << " not found or not configured" << endl;
+      retval = -1;
+      continue;
+    }
+    // masses which differ by rounding must find the table, other masses must not
+    double tmass = tconfig.masses.front();
+    if(!tmat->tabulated(tmass*(1.0+1.0e-12)) || tmat->tabulated(tmass*(1.0+1.0e-6))){
+      cout << "Material " << matname << " mass matching error" << endl;
+      retval = -1;
+    }
+    for(auto const& func : funcs){
+      // accuracy
+      double maxdiff(0.0);
+      for(auto const* paths : {&plens,&thinplens}){
+        for(unsigned itest=0; itest < ntest; itest++){
+          double aval = func.func(*amat,moms[itest],(*paths)[itest],masses[itest]);
+          double tval = func.func(*tmat,moms[itest],(*paths)[itest],masses[itest]);
+          if(tval != aval) maxdiff = std::max(maxdiff,fabs(tval-aval)/fabs(aval));
+        }
+      }
+      // timing
+      double sum(0.0);
+      start = Clock::now();
+      for(unsigned itest=0; itest < ntest; itest++) sum += func.func(*amat,moms[itest],plens[itest],masses[itest]);
+      stop = Clock::now();
+      double tanalytic = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()/double(ntest);
+      start = Clock::now();
+      for(unsigned itest=0; itest < ntest; itest++) sum += func.func(*tmat,moms[itest],plens[itest],masses[itest]);
+      stop = Clock::now();
+      double ttable = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()/double(ntest);
+      cout << matname << " " << func.name << " max relative difference " << maxdiff << " ns/call analytic " << tanalytic
+        << " tabulated " << ttable << " (checksum " << sum << ")" << endl;
+      if(!(maxdiff < tconfig.tolerance)){
+        cout << "Tolerance exceeded" << endl;
+        retval = -2;
+      }
+    }
+    // batch functions, for each catalog and mass hypothesis
+    std::vector<double> scalar(ntest), batch(ntest);
+    using BATCHFUNC = std::function<void(DetMaterial const&, double, double*)>;
+    std::vector<std::tuple<std::string,MATFUNC,BATCHFUNC>> bfuncs = {
+      {"energyLoss", [](DetMaterial const& dmat, double mom, double plen, double mass) { return dmat.energyLoss(mom,plen,mass); },
+        [&](DetMaterial const& dmat, double mass, double* out) { dmat.energyLoss(moms.data(),plens.data(),ntest,mass,out); } },
+      {"energyLossVar", [](DetMaterial const& dmat, double mom, double plen, double mass) { return dmat.energyLossVar(mom,plen,mass); },
+        [&](DetMaterial const& dmat, double mass, double* out) { dmat.energyLossVar(moms.data(),plens.data(),ntest,mass,out); } },
+      {"scatterAngleVar", [](DetMaterial const& dmat, double mom, double plen, double mass) { return dmat.scatterAngleVar(mom,plen,mass); },
+        [&](DetMaterial const& dmat, double mass, double* out) { dmat.scatterAngleVar(moms.data(),plens.data(),ntest,mass,out); } }
+    };
+    for(auto const* dmat : {amat,tmat}){
+      for(double mass : tconfig.masses){
+        for(auto const& bfunc : bfuncs){
+          auto const& sfunc = std::get<1>(bfunc);
+          start = Clock::now();
+          for(unsigned itest=0; itest < ntest; itest++) scalar[itest] = sfunc(*dmat,moms[itest],plens[itest],mass);
+          stop = Clock::now();
+          double tscalar = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()/double(ntest);
+          start = Clock::now();
+          std::get<2>(bfunc)(*dmat,mass,batch.data());
+          stop = Clock::now();
+          double tbatch = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()/double(ntest);
+          double maxdiff(0.0);
+          for(unsigned itest=0; itest < ntest; itest++){
+            double scale = fabs(scalar[itest]);
+            if(std::get<0>(bfunc) == "energyLoss")
+              scale = std::max(scale,dmat->eloss_xi(DetMaterial::particleBeta(moms[itest],mass),plens[itest])*fabs(dmat->mpvFactor(moms[itest],mass)));
+            maxdiff = std::max(maxdiff,fabs(batch[itest]-scalar[itest])/scale);
+          }
+          cout << matname << (dmat->tabulated(mass) ? " tabulated " : " analytic ") << std::get<0>(bfunc) << " mass " << mass
+            << " batch max relative difference " << maxdiff << " ns/call scalar " << tscalar << " batch " << tbatch << endl;
+          if(!(maxdiff < 1.0e-10)){
+            cout << "Batch result doesn't match scalar" << endl;
+            retval = -3;
+          }
+        }
+      }
+    }
+  }
+  return retval;
+}
@@ -161,6 +161,60 @@ int ParticleTrajectoryTest(int argc, char **argv) {
   cout << "Final piece traj with " << ptraj.pieces().size() << " pieces and largest gap = "
     << largest << " average gap = " << average << endl;
 
+  // test buffered storage: repeatedly rebuild a copy of the trajectory, swapping like the fit iteration does
+  auto buffer = std::make_shared<typename PTRAJ::BUFFER>(8);
+  auto btraj = std::make_unique<PTRAJ>(buffer);
+  auto sparetraj = std::make_unique<PTRAJ>(buffer);
+  auto handle = ptraj.nearestTraj(ptraj.range().mid()); // unbuffered handle held outside
+  size_t nblocks(0);
+  for(int ibuild=0; ibuild < 20; ibuild++){
+    sparetraj->clear();
+    for(auto const& piece : ptraj.pieces()) sparetraj->append(*piece);
+    btraj.swap(sparetraj);
+    if(btraj->pieces().size() != ptraj.pieces().size() || btraj->range().begin() != ptraj.range().begin() || btraj->range().end() != ptraj.range().end()){
+      cout << "Buffered trajectory differs from original" << endl;
+      return -1;
+    }
+    // after a few builds the number of blocks must stabilize
+    if(ibuild == 10) nblocks = buffer->nBlocks();
+    if(ibuild > 10 && buffer->nBlocks() != nblocks){
+      cout << "Buffer grew in steady state: " << buffer->nBlocks() << " blocks" << endl;
+      return -1;
+    }
+  }
+  // a handle held outside the trajectory must survive rebuilding
+  auto bhandle = btraj->nearestTraj(ptraj.range().mid());
+  VEC3 bpos = bhandle->position3(ptraj.range().mid());
+  for(int ibuild=0; ibuild < 10; ibuild++){
+    sparetraj->clear();
+    for(auto const& piece : ptraj.pieces()) sparetraj->append(*piece);
+    btraj.swap(sparetraj);
+  }
+  if((bhandle->position3(ptraj.range().mid()) - bpos).R() > 1e-10 || (handle->position3(ptraj.range().mid())-bpos).R() > 1e-10){
+    cout << "Buffered piece handle changed" << endl;
+    return -1;
+  }
+  cout << "Buffered trajectory uses " << buffer->nBlocks() << " blocks of " << buffer->blockSize() << " pieces" << endl;
+  // a copy must get its own buffer, as a buffer can only be used from 1 thread
+  PTRAJ bcopy(*btraj);
+  if(!bcopy.buffer() || bcopy.buffer() == btraj->buffer() || bcopy.pieces().size() != btraj->pieces().size()){
+    cout << "Copied trajectory shares the piece buffer" << endl;
+    return -1;
+  }
+  // trimming removes the pieces outside the range, and keeps the piece boundaries consistent
+  size_t npieces = ptraj.pieces().size();
+  if(npieces > 3){
+    PTRAJ ttraj;
+    for(auto const& piece : ptraj.pieces()) ttraj.append(*piece);
+    TimeRange trange(ptraj.piece(1).range().mid(),ptraj.piece(npieces-2).range().mid());
+    ttraj.setRange(trange,true);
+    if(ttraj.pieces().size() != npieces-2 || ttraj.range().begin() != trange.begin() || ttraj.range().end() != trange.end()
+        || ttraj.nearestIndex(ptraj.piece(2).range().mid()) != 1){
+      cout << "Trimmed trajectory inconsistent" << endl;
+      return -1;
+    }
+  }
+
   // draw each piece of the piecetraj
   char fname[100];
   snprintf(fname,100,"ParticleTrajectory_%s_%2.2f.root",MomBasis::directionName(tdir).c_str(),delta);
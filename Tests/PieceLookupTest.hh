@@ -0,0 +1,140 @@
+//
+// test and time the piece lookup of PiecewiseTrajectory as a function of the number of pieces.  Both the binary search
+// and the cursor (hint) lookup are checked against a linear scan
+//
+#include "KinKal/Trajectory/ParticleTrajectory.hh"
+#include "KinKal/General/PhysicalConstants.h"
+
+#include <iostream>
+#include <stdio.h>
+#include <getopt.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "TRandom3.h"
+
+using namespace KinKal;
+using namespace std;
+
+template <class KTRAJ>
+int PieceLookupTest(int argc, char **argv) {
+  using PTRAJ = ParticleTrajectory<KTRAJ>;
+  using Clock = std::chrono::high_resolution_clock;
+  double mom(105.0), cost(0.7), phi(0.5);
+  int icharge(-1);
+  double pmass(0.511);
+  unsigned nlookup(100000);
+  unsigned maxpieces(2000);
+  int retval(0);
+
+  static struct option long_options[] = {
+    {"nlookup",     required_argument, 0, 'n'  },
+    {"maxpieces",     required_argument, 0, 'p'  },
+    {NULL, 0,0,0}
+  };
+  int long_index =0;
+  int opt;
+  while ((opt = getopt_long_only(argc, argv,"",
+          long_options, &long_index )) != -1) {
+    switch (opt) {
+      case 'n' :
+        nlookup = atoi(optarg);
+        break;
+      case 'p' :
+        maxpieces = atoi(optarg);
+        break;
+      default: printf("Usage: PieceLookupTest --nlookup i --maxpieces i\n");
+               exit(EXIT_FAILURE);
+    }
+  }
+  // construct the base trajectory
+  double sint = sqrt(1.0-cost*cost);
+  MOM4 momv(mom*sint*cos(phi),mom*sint*sin(phi),mom*cost,pmass);
+  VEC4 origin(0.0,0.0,0.0,0.0);
+  VEC3 bnom(0.0,0.0,1.0);
+  double tmax(100.0);
+  KTRAJ ktraj(origin,momv,icharge,bnom,TimeRange(0.0,tmax));
+  TRandom3 tr(12345);
+  std::vector<double> times(nlookup);
+  for(auto& time : times) time = tr.Uniform(-1.0,tmax+1.0);
+  std::vector<double> sweep(times);
+  std::sort(sweep.begin(),sweep.end());
+  // reference linear scan
+  auto linear = [](PTRAJ const& ptraj, double time) {
+    auto const& pieces = ptraj.pieces();
+    if(time <= ptraj.range().begin()) return size_t(0);
+    if(time >= ptraj.range().end()) return pieces.size()-1;
+    size_t index(0);
+    while(index < pieces.size() && time > pieces[index]->range().end()) index++;
+    return index;
+  };
+  for(unsigned npieces = 1; npieces <= maxpieces; npieces *= 2){
+    PTRAJ ptraj(ktraj);
+    double dt = tmax/npieces;
+    for(unsigned ipiece=1;ipiece < npieces; ipiece++){
+      KTRAJ piece(ktraj);
+      piece.range() = TimeRange(ipiece*dt,tmax);
+      ptraj.append(piece);
+    }
+    size_t nbad(0), isum(0);
+    for(auto time : times)
+      if(ptraj.nearestIndex(time) != linear(ptraj,time))nbad++;
+    size_t hint(0);
+    for(auto time : sweep)
+      if(ptraj.nearestIndex(time,hint) != linear(ptraj,time))nbad++;
+    hint = npieces/3;
+    for(auto time : times)
+      if(ptraj.nearestIndex(time,hint) != linear(ptraj,time))nbad++;
+    if(nbad > 0){
+      cout << "Lookup errors " << nbad << " for " << npieces << " pieces" << endl;
+      retval = -1;
+    }
+    // timing
+    auto start = Clock::now();
+    for(auto time : times) isum += linear(ptraj,time);
+    auto stop = Clock::now();
+    double tlinear = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()/double(nlookup);
+    start = Clock::now();
+    for(auto time : times) isum += ptraj.nearestIndex(time);
+    stop = Clock::now();
+    double tbinary = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()/double(nlookup);
+    hint = 0;
+    start = Clock::now();
+    for(auto time : sweep) isum += ptraj.nearestIndex(time,hint);
+    stop = Clock::now();
+    double tcursor = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()/double(nlookup);
+    cout << "Pieces " << npieces << " ns/lookup linear " << tlinear << " binary " << tbinary << " cursor sweep " << tcursor
+      << " (checksum " << isum << ")" << endl;
+  }
+  // prepend with removal, with the new piece ending inside the first piece and inside an interior piece
+  unsigned npieces(10);
+  double dt = tmax/npieces;
+  for(unsigned iend : {0u, 4u}){
+    PTRAJ ptraj(ktraj);
+    for(unsigned ipiece=1;ipiece < npieces; ipiece++){
+      KTRAJ piece(ktraj);
+      piece.range() = TimeRange(ipiece*dt,tmax);
+      ptraj.append(piece);
+    }
+    double tend = (iend+0.5)*dt;
+    KTRAJ newpiece(ktraj);
+    newpiece.range() = TimeRange(-10.0,tend);
+    try {
+      ptraj.prepend(newpiece,true);
+      size_t nbad(0);
+      for(auto time : times)
+        if(ptraj.nearestIndex(time) != linear(ptraj,time))nbad++;
+      if(ptraj.pieces().size() != npieces-iend+1 || ptraj.range().begin() != -10.0 || ptraj.front().range().end() != tend
+          || ptraj.piece(1).range().begin() != tend || nbad > 0){
+        cout << "Prepend with removal error ending in piece " << iend << ": " << ptraj.pieces().size() << " pieces, "
+          << nbad << " lookup errors" << endl;
+        retval = -1;
+      }
+    } catch (std::exception const& error) {
+      cout << "Prepend with removal exception ending in piece " << iend << ": " << error.what() << endl;
+      retval = -1;
+    }
+  }
+  return retval;
+}
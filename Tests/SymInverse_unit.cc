@@ -0,0 +1,115 @@
+//
+// test the symmetric positive-definite inversion kernel against the ROOT SMatrix inversion, and time both
+//
+#include "KinKal/General/Vectors.hh"
+#include "KinKal/General/SymInverse.hh"
+
+#include <iostream>
+#include <stdio.h>
+#include <getopt.h>
+#include <chrono>
+#include <vector>
+#include <cmath>
+
+#include "TRandom3.h"
+
+using namespace KinKal;
+using namespace std;
+
+void print_usage() {
+  printf("Usage: SymInverse --nmatrix i --tolerance f\n");
+}
+
+int main(int argc, char **argv) {
+  using Clock = std::chrono::high_resolution_clock;
+  unsigned nmatrix(100000);
+  double tol(1.0e-8);
+  int retval(EXIT_SUCCESS);
+  static struct option long_options[] = {
+    {"nmatrix",     required_argument, 0, 'n'  },
+    {"tolerance",     required_argument, 0, 't'  },
+    {NULL, 0,0,0}
+  };
+  int long_index =0;
+  int opt;
+  while ((opt = getopt_long_only(argc, argv,"",
+          long_options, &long_index )) != -1) {
+    switch (opt) {
+      case 'n' : nmatrix = atoi(optarg);
+                 break;
+      case 't' : tol = atof(optarg);
+                 break;
+      default: print_usage();
+               exit(EXIT_FAILURE);
+    }
+  }
+  // generate random covariance matrices, with parameter scales and correlations similar to a track fit
+  TRandom3 tr(23456);
+  std::vector<DMAT> mats(nmatrix);
+  std::vector<DVEC> vecs(nmatrix);
+  for(unsigned imat=0; imat < nmatrix; imat++){
+    ROOT::Math::SMatrix<double,NParams(),NParams()> jac;
+    DVEC scale;
+    for(unsigned ipar=0; ipar < NParams(); ipar++) scale[ipar] = pow(10.0,tr.Uniform(-4.0,3.0));
+    for(unsigned ipar=0; ipar < NParams(); ipar++){
+      for(unsigned jpar=0; jpar < NParams(); jpar++) jac(ipar,jpar) = tr.Gaus()*scale[ipar];
+      vecs[imat][ipar] = tr.Gaus()*scale[ipar];
+    }
+    DMAT ident = ROOT::Math::SMatrixIdentity();
+    mats[imat] = ROOT::Math::Similarity(jac,ident);
+    for(unsigned ipar=0; ipar < NParams(); ipar++) mats[imat](ipar,ipar) += 1.0e-2*scale[ipar]*scale[ipar];
+  }
+  // compare the results
+  double maxdiff(0.0);
+  unsigned nfail(0);
+  for(unsigned imat=0; imat < nmatrix; imat++){
+    DMAT rmat = mats[imat];
+    DMAT kmat = mats[imat];
+    DVEC kvec = vecs[imat];
+    if(!rmat.Invert()) continue; // only compare matrices ROOT can invert
+    DVEC rvec = rmat*vecs[imat];
+    if(!invertSPD(kmat,kvec)){
+      nfail++;
+      continue;
+    }
+    // compare relative to the diagonal scale
+    for(unsigned ipar=0; ipar < NParams(); ipar++){
+      for(unsigned jpar=0; jpar <= ipar; jpar++)
+        maxdiff = std::max(maxdiff,fabs(kmat(ipar,jpar)-rmat(ipar,jpar))/sqrt(rmat(ipar,ipar)*rmat(jpar,jpar)));
+      maxdiff = std::max(maxdiff,fabs(kvec[ipar]-rvec[ipar])/(fabs(rvec[ipar])+sqrt(rmat(ipar,ipar))));
+    }
+  }
+  cout << "Maximum relative difference " << maxdiff << " failures " << nfail << endl;
+  if(maxdiff > tol || nfail > 0) retval = -1;
+  // non positive-definite matrices must fail
+  DMAT indef = ROOT::Math::SMatrixIdentity();
+  indef(3,3) = -1.0;
+  DMAT sing = ROOT::Math::SMatrixIdentity();
+  sing(2,2) = 0.0;
+  if(invertSPD(indef) || invertSPD(sing)){
+    cout << "Failed to detect a non positive-definite matrix" << endl;
+    retval = -2;
+  }
+  // timing: include the vector solution as in FitData::invert
+  double sum(0.0);
+  auto start = Clock::now();
+  for(unsigned imat=0; imat < nmatrix; imat++){
+    DMAT mat = mats[imat];
+    if(mat.Invert()){
+      DVEC vec = mat*vecs[imat];
+      sum += vec[0];
+    }
+  }
+  auto stop = Clock::now();
+  double troot = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()/double(nmatrix);
+  start = Clock::now();
+  for(unsigned imat=0; imat < nmatrix; imat++){
+    DMAT mat = mats[imat];
+    DVEC vec = vecs[imat];
+    if(invertSPD(mat,vec)) sum += vec[0];
+  }
+  stop = Clock::now();
+  double tkernel = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()/double(nmatrix);
+  cout << "ns/inversion ROOT " << troot << " SymInverse " << tkernel << " (checksum " << sum << ")" << endl;
+  return retval;
+}
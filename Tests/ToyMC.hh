@@ -17,6 +17,7 @@
 #include "KinKal/General/BFieldMap.hh"
 #include "KinKal/General/Vectors.hh"
 #include "KinKal/General/PhysicalConstants.h"
+#include <cstdint>
 
 namespace KKTest {
   using namespace KinKal;
@@ -61,6 +62,9 @@ namespace KKTest {
       // set functions, for special purposes
       void setInefficiency(double ineff) { ineff_ = ineff; }
       void setTolerance(double tol) { tol_ = tol; }
+      void setSeed(unsigned seed) { tr_.SetSeed(seed); }
+      // deterministic seed for a random number stream of a given event, so events can be simulated in any order
+      static unsigned eventSeed(int seed, unsigned ievent, unsigned stream);
       // accessors
       double shVar() const {return sigt_*sigt_;}
       double chVar() const {return scitsig_*scitsig_;}
@@ -96,6 +100,17 @@ namespace KKTest {
 
   };
 
+  template <class KTRAJ> unsigned ToyMC<KTRAJ>::eventSeed(int seed, unsigned ievent, unsigned stream) {
+    // splitmix64 hash of the inputs
+    uint64_t val = (uint64_t(uint32_t(seed)) << 32) ^ (uint64_t(ievent) << 2) ^ stream;
+    val += 0x9E3779B97F4A7C15ULL;
+    val = (val ^ (val >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    val = (val ^ (val >> 27)) * 0x94D049BB133111EBULL;
+    val ^= (val >> 31);
+    unsigned retval = unsigned(val);
+    return retval == 0 ? 1 : retval; // TRandom3 uses a time-based seed for 0
+  }
+
   template <class KTRAJ> Line ToyMC<KTRAJ>::generateStraw(PTRAJ const& traj, double htime) {
     // start with the true helix position at this time
     auto hpos = traj.position4(htime);
@@ -0,0 +1,108 @@
+//
+// ToyMC test of fitting batches of KTRAJ-based Tracks concurrently.  This measures the fit throughput (tracks/second)
+// as a function of the number of threads, and checks that the results are independent of the number of threads
+//
+#include "KinKal/Fit/TrackBatch.hh"
+#include "KinKal/Tests/FitTest.hh"
+
+#include <thread>
+
+template <class KTRAJ>
+int TrackBatchTest(int argc, char *argv[],KinKal::DVEC const& sigmas) {
+  using KKBATCH = TrackBatch<KTRAJ>;
+  using PTRAJ = ParticleTrajectory<KTRAJ>;
+  using Clock = std::chrono::high_resolution_clock;
+  int opt;
+  double mom(105.0);
+  int icharge(-1);
+  double mass(0.511);
+  unsigned ntrks(200), nhits(40);
+  unsigned maxthreads(std::min(8u,std::max(1u,std::thread::hardware_concurrency())));
+  double Bgrad(-0.036), Bz(1.0);
+  double zrange(3000);
+  double seedsmear(10.0);
+  double ambigdoca(0.25);
+  int iseed(123421);
+  string sfile("driftfit.txt");
+  int retval(EXIT_SUCCESS);
+
+  static struct option long_options[] = {
+    {"momentum",     required_argument, 0, 'm' },
+    {"ntracks",     required_argument, 0, 'N'  },
+    {"nhits",     required_argument, 0, 'n'  },
+    {"maxthreads",     required_argument, 0, 't'  },
+    {"Bgrad",     required_argument, 0, 'g'  },
+    {"seed",     required_argument, 0, 's'  },
+    {"Schedule",     required_argument, 0, 'u'  },
+    {NULL, 0,0,0}
+  };
+  int long_index =0;
+  while ((opt = getopt_long(argc, argv,"",
+          long_options, &long_index )) != -1) {
+    switch (opt) {
+      case 'm' : mom = atof(optarg);
+                 break;
+      case 'N' : ntrks = atoi(optarg);
+                 break;
+      case 'n' : nhits = atoi(optarg);
+                 break;
+      case 't' : maxthreads = atoi(optarg);
+                 break;
+      case 'g' : Bgrad = atof(optarg);
+                 break;
+      case 's' : iseed = atoi(optarg);
+                 break;
+      case 'u' : sfile = optarg;
+                 break;
+      default: printf("Usage: TrackBatchTest --momentum f --ntracks i --nhits i --maxthreads i --Bgrad f --seed i --Schedule a\n");
+               exit(EXIT_FAILURE);
+    }
+  }
+  std::unique_ptr<BFieldMap> BF;
+  if(Bgrad != 0)
+    BF = std::make_unique<GradientBFieldMap>(Bz-0.5*Bgrad,Bz+0.5*Bgrad,-0.5*zrange,0.5*zrange);
+  else
+    BF = std::make_unique<UniformBFieldMap>(VEC3(0.0,0.0,Bz));
+  Config config;
+  if(makeConfig(sfile,config) != 0) return -1;
+  // reference results from the single-thread fit
+  std::vector<Chisq> refchisq;
+  std::vector<Status::status> refstatus;
+  for(unsigned nthreads=1; nthreads <= maxthreads; nthreads++){
+    // regenerate the same inputs for each pass, as fitting modifies the hit and xing state
+    KKTest::ToyMC<KTRAJ> toy(*BF, mom, icharge, zrange, iseed, nhits, true, false, ambigdoca, mass );
+    typename KKBATCH::INPUTCOL inputs;
+    inputs.reserve(ntrks);
+    for(unsigned itrk=0; itrk < ntrks; itrk++){
+      PTRAJ tptraj;
+      typename KKBATCH::HITCOL thits;
+      typename KKBATCH::EXINGCOL dxings;
+      toy.simulateParticle(tptraj,thits,dxings);
+      double tmid = tptraj.range().mid();
+      auto const& midhel = tptraj.nearestPiece(tmid);
+      auto seedpos = midhel.position4(tmid);
+      KTRAJ seedtraj(seedpos,midhel.momentum4(tmid),midhel.charge(),BF->fieldVect(seedpos.Vect()),tptraj.range());
+      toy.createSeed(seedtraj,sigmas,seedsmear);
+      inputs.emplace_back(PTRAJ(seedtraj),thits,dxings);
+    }
+    KKBATCH batch(config,*BF,nthreads);
+    auto start = Clock::now();
+    auto tracks = batch.fit(inputs);
+    auto stop = Clock::now();
+    double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+    cout << "Threads " << nthreads << " fit " << tracks.size() << " tracks in " << duration*1.0e-6 << " ms, "
+      << 1.0e9*tracks.size()/duration << " tracks/second" << endl;
+    // compare with the single thread result
+    for(size_t itrk=0; itrk < tracks.size(); itrk++){
+      auto const& fstat = tracks[itrk]->fitStatus();
+      if(nthreads == 1){
+        refchisq.push_back(fstat.chisq_);
+        refstatus.push_back(fstat.status_);
+      } else if(fstat.status_ != refstatus[itrk] || fstat.chisq_.chisq() != refchisq[itrk].chisq() || fstat.chisq_.nDOF() != refchisq[itrk].nDOF()){
+        cout << "Track " << itrk << " result differs with " << nthreads << " threads: " << fstat << endl;
+        retval = -2;
+      }
+    }
+  }
+  return retval;
+}
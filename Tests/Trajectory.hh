@@ -300,6 +300,32 @@ int test(int argc, char **argv) {
       return -2;
     }
   }
+  // test the fused evaluation against the separate functions
+  TrajEvaluation eval;
+  lhel.evaluate(ltime,TrajEvaluation::basis|TrajEvaluation::dXdPar|TrajEvaluation::dPardM|TrajEvaluation::acceleration,eval);
+  double evaldiff = (eval.pos_.Vect()-lhel.position3(ltime)).R() + fabs(eval.pos_.T()-ltime) + (eval.vel_-lhel.velocity(ltime)).R();
+  for(int idir=0;idir<MomBasis::ndir; idir++) {
+    auto mdir = static_cast<MomBasis::Direction>(idir);
+    evaldiff += (eval.direction(mdir)-lhel.direction(ltime,mdir)).R();
+  }
+  DVDP dxdp = eval.dXdP_ - lhel.dXdPar(ltime);
+  DPDV dpdm = eval.dPdM_ - lhel.dPardM(ltime);
+  for(size_t idim=0;idim < NDim();idim++){
+    for(size_t ipar=0;ipar < NParams();ipar++){
+      evaldiff += fabs(dxdp(idim,ipar)) + fabs(dpdm(ipar,idim));
+    }
+  }
+  if(evaldiff > 1e-9){
+    cout << "Fused evaluation check failed, difference " << evaldiff << endl;
+    return -3;
+  }
+  // test the acceleration against the numerical derivative of the velocity
+  double dtacc(1.0e-3);
+  VEC3 numacc = (lhel.velocity(ltime+dtacc)-lhel.velocity(ltime-dtacc))/(2.0*dtacc);
+  if((numacc-eval.acc_).R() > 1.0e-5*(1.0+numacc.R())){
+    cout << "Acceleration check failed, evaluated " << eval.acc_ << " numerical " << numacc << endl;
+    return -4;
+  }
 
   std::string tfname = KTRAJ::trajName() + ".root";
   cout << "Saving canvas to " << title << endl;
@@ -0,0 +1,163 @@
+#ifndef KinKal_BatchClosestApproach_hh
+#define KinKal_BatchClosestApproach_hh
+//
+//  Find the points of closest approach between 1 particle trajectory and many Line sensors, as for pattern recognition
+//  scoring of many straws against a candidate track.  The results for each line are the same as ClosestApproach<KTRAJ,Line>,
+//  but the Newton iteration runs for all the lines together: each pass evaluates the particle at the current TOCA estimates
+//  of the unconverged lines, then updates the estimates in a branch-free loop over blocks of local arrays, which the compiler vectorizes.
+//  Converged lines are dropped from the following passes.  The object holds the results and scratch space, so reusing it avoids allocation.
+//  The iteration is configured by CAConfig as for ClosestApproach: the analytic hint is applied to each line before iterating, and the
+//  curvature-corrected step is included in the vectorized update.
+//
+#include "KinKal/Trajectory/ClosestApproach.hh"
+#include "KinKal/Trajectory/LineArray.hh"
+#include "KinKal/Trajectory/ClosestApproachData.hh"
+#include "KinKal/General/TrajEvaluation.hh"
+#include "KinKal/General/ProfileCounters.hh"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace KinKal {
+  template<class KTRAJ> class BatchClosestApproach {
+    public:
+      explicit BatchClosestApproach(double precision, CAConfig const& caconfig=CAConfig()) : precision_(precision), config_(caconfig) {}
+      BatchClosestApproach(double precision, unsigned maxiter) : precision_(precision) { config_.maxiter_ = maxiter; }
+      // find TCA between ktraj and each line, starting from the particle and sensor TOCA hints (one per line)
+      void findTCA(KTRAJ const& ktraj, LineArray const& lines, double const* particleHints, double const* sensorHints);
+      // results, indexed by line
+      size_t size() const { return status_.size(); }
+      ClosestApproachData::TPStat status(size_t iline) const { return status_[iline]; }
+      bool usable(size_t iline) const { return status_[iline] < ClosestApproachData::diverged; }
+      double doca(size_t iline) const { return doca_[iline]; } // DOCA signed by angular momentum
+      double particleToca(size_t iline) const { return ptoca_[iline]; }
+      double sensorToca(size_t iline) const { return stoca_[iline]; }
+      DVEC const& dDdP(size_t iline) const { return dDdP_[iline]; } // derivative of DOCA WRT particle parameters
+      DVEC const& dTdP(size_t iline) const { return dTdP_[iline]; } // derivative of TOCA WRT particle parameters
+      std::vector<ClosestApproachData::TPStat> const& statuses() const { return status_; }
+      std::vector<double> const& docas() const { return doca_; }
+      std::vector<double> const& particleTocas() const { return ptoca_; }
+      std::vector<double> const& sensorTocas() const { return stoca_; }
+      std::vector<DVEC> const& dDdPs() const { return dDdP_; }
+      std::vector<DVEC> const& dTdPs() const { return dTdP_; }
+      double precision() const { return precision_; }
+      unsigned maxIterations() const { return config_.maxiter_; }
+      CAConfig const& config() const { return config_; }
+    private:
+      double precision_; // precision used to define convergence
+      CAConfig config_; // iteration configuration
+      std::vector<ClosestApproachData::TPStat> status_;
+      std::vector<double> doca_, ptoca_, stoca_;
+      std::vector<DVEC> dDdP_, dTdP_;
+      // scratch space for the unconverged lines, stored contiguously
+      std::vector<size_t> active_; // line index
+      std::vector<double> pspeed_, sspeed_; // particle and sensor speeds, which don't change
+      static constexpr size_t blocksize_ = 32; // number of lines processed together in each pass
+  };
+
+  template<class KTRAJ> void BatchClosestApproach<KTRAJ>::findTCA(KTRAJ const& ktraj, LineArray const& lines,
+      double const* particleHints, double const* sensorHints) {
+    size_t nlines = lines.size();
+    status_.assign(nlines,ClosestApproachData::unconverged);
+    doca_.assign(nlines,-1.0);
+    ptoca_.assign(particleHints,particleHints+nlines);
+    stoca_.assign(sensorHints,sensorHints+nlines);
+    dDdP_.assign(nlines,DVEC());
+    dTdP_.assign(nlines,DVEC());
+    active_.resize(nlines);
+    pspeed_.resize(nlines);
+    sspeed_.resize(nlines);
+    size_t nactive(nlines);
+    for(size_t iline=0; iline < nlines; ++iline){
+      if(config_.analyticHint_){
+        auto hint = analyticCAHint(ktraj,CAHint(ptoca_[iline],stoca_[iline]),
+            lines.position3(iline,stoca_[iline]),lines.direction(iline),lines.speed(iline));
+        ptoca_[iline] = hint.particleToca_;
+        stoca_[iline] = hint.sensorToca_;
+      }
+      active_[iline] = iline;
+      pspeed_[iline] = ktraj.speed(ptoca_[iline]);
+      sspeed_[iline] = lines.speed(iline);
+    }
+    TrajEvaluation peval; // particle position and direction are evaluated together
+    unsigned content = config_.curvatureStep_ ? TrajEvaluation::acceleration : TrajEvaluation::basic;
+    unsigned maxiter = config_.maxiter_;
+    unsigned niter(0);
+    while(nactive > 0 && niter++ < maxiter) {
+      KINKAL_PROFILE_COUNT(ntcaiters_,nactive);
+      size_t nkeep(0);
+      // process the active lines in blocks.  The block arrays are local, so the compiler knows they don't alias
+      for(size_t i0=0; i0 < nactive; i0 += blocksize_){
+        size_t nb = std::min(blocksize_,nactive-i0);
+        double delx[blocksize_], dely[blocksize_], delz[blocksize_]; // sensor - particle position
+        double pdirx[blocksize_], pdiry[blocksize_], pdirz[blocksize_], sdirx[blocksize_], sdiry[blocksize_], sdirz[blocksize_]; // directions
+        double pspeed[blocksize_], sspeed[blocksize_], curv[blocksize_];
+        double denom[blocksize_], dptoca[blocksize_], dstoca[blocksize_]; // iteration results
+        // find positions and directions at the current TOCA estimates
+        for(size_t ib=0; ib < nb; ++ib){
+          size_t iline = active_[i0+ib];
+          ktraj.evaluate(ptoca_[iline],content,peval);
+          VEC3 dpos = lines.position3(iline,stoca_[iline]) - peval.pos_.Vect();
+          VEC3 const& pdir = peval.direction();
+          delx[ib] = dpos.X(); dely[ib] = dpos.Y(); delz[ib] = dpos.Z();
+          pdirx[ib] = pdir.X(); pdiry[ib] = pdir.Y(); pdirz[ib] = pdir.Z();
+          sdirx[ib] = lines.dx_[iline]; sdiry[ib] = lines.dy_[iline]; sdirz[ib] = lines.dz_[iline];
+          pspeed[ib] = pspeed_[i0+ib];
+          sspeed[ib] = sspeed_[i0+ib];
+          // include the particle curvature (exact Newton step) when that leaves the Hessian positive-definite, as in ClosestApproach.
+          // The choice is made here so the loop below has no branches
+          curv[ib] = 0.0;
+          if(config_.curvatureStep_){
+            double c = dpos.Dot(peval.acc_)/(pspeed[ib]*pspeed[ib]);
+            double ddot = sdirx[ib]*pdirx[ib] + sdiry[ib]*pdiry[ib] + sdirz[ib]*pdirz[ib];
+            if(c != 0.0 && 1.0 - ddot*ddot - c > 1.0e-5) curv[ib] = c;
+          }
+        }
+        // compute the change in times.  This loop has no dependencies between lines, so it can be vectorized
+        for(size_t ib=0; ib < nb; ++ib){
+          double ddot = sdirx[ib]*pdirx[ib] + sdiry[ib]*pdiry[ib] + sdirz[ib]*pdirz[ib];
+          double hdd = delx[ib]*pdirx[ib] + dely[ib]*pdiry[ib] + delz[ib]*pdirz[ib];
+          double ldd = delx[ib]*sdirx[ib] + dely[ib]*sdiry[ib] + delz[ib]*sdirz[ib];
+          denom[ib] = 1.0 - ddot*ddot;
+          double cdenom = denom[ib] - curv[ib];
+          dptoca[ib] = (hdd - ldd*ddot)/(cdenom*pspeed[ib]);
+          dstoca[ib] = (hdd*ddot - ldd + curv[ib]*ldd)/(cdenom*sspeed[ib]);
+        }
+        // update the TOCA estimates, and remove the finished lines from the active list.  This only overwrites entries already processed
+        for(size_t ib=0; ib < nb; ++ib){
+          size_t iline = active_[i0+ib];
+          // check for parallel
+          if(denom[ib] < 1.0e-5){
+            status_[iline] = ClosestApproachData::pocafailed;
+            continue;
+          }
+          ptoca_[iline] += dptoca[ib];
+          stoca_[iline] += dstoca[ib];
+          if(!(fabs(dptoca[ib]) > precision_ || fabs(dstoca[ib]) > precision_)){
+            if(niter < maxiter) status_[iline] = ClosestApproachData::converged;
+            continue;
+          }
+          active_[nkeep] = iline;
+          pspeed_[nkeep] = pspeed[ib];
+          sspeed_[nkeep] = sspeed[ib];
+          ++nkeep;
+        }
+      }
+      nactive = nkeep;
+    }
+    // final update of the usable results, including the derivatives
+    for(size_t iline=0; iline < nlines; ++iline){
+      if(!usable(iline))continue;
+      ktraj.evaluate(ptoca_[iline],TrajEvaluation::dXdPar,peval);
+      VEC3 dvec = lines.position3(iline,stoca_[iline]) - peval.pos_.Vect();
+      // sign doca by angular momentum projected onto difference vector
+      double lsign = copysign(1.0,lines.direction(iline).Cross(peval.direction()).Dot(dvec));
+      doca_[iline] = dvec.R()*lsign;
+      VEC3 dvechat = dvec.Unit();
+      SVEC3 dv(dvechat.X(),dvechat.Y(),dvechat.Z());
+      dDdP_[iline] = -dv*peval.dXdP_;
+      dTdP_[iline][KTRAJ::t0Index()] = -1.0;  // TOCA is 100% anti-correlated with the (mandatory) t0 component.
+    }
+  }
+}
+#endif
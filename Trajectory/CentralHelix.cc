@@ -34,12 +34,10 @@ namespace KinKal {
     // Transform into the system where Z is along the Bfield.  This is a pure rotation about the origin
     VEC4 pos(pos0);
     MOM4 mom(mom0);
-    g2l_ = Rotation3D(AxisAngle(VEC3(sin(bnom_.Phi()),-cos(bnom_.Phi()),0.0),bnom_.Theta()));
+    setRotations();
     if(fabs(g2l_(bnom_).Theta()) > 1.0e-6)throw invalid_argument("Rotation Error");
     pos = g2l_(pos);
     mom = g2l_(mom);
-    // create inverse rotation; this moves back into the original coordinate system
-    l2g_ = g2l_.Inverse();
     // kinematic to geometric conversion
     double radToMom = BFieldMap::cbar()*charge_*bnom_.R();
     double momToRad = 1.0/radToMom;
@@ -102,16 +100,36 @@ namespace KinKal {
     pars_.parameters() += dPardB(time,bnom);
     bnom_ = bnom;
     // adjust rotations to global space
+    setRotations();
+  }
+
+  void CentralHelix::setRotations() {
     g2l_ = Rotation3D(AxisAngle(VEC3(sin(bnom_.Phi()),-cos(bnom_.Phi()),0.0),bnom_.Theta()));
     l2g_ = g2l_.Inverse();
+    // When bnom is along +z the rotation angle is 0 and the matrices are exactly the identity.  Rotating by them
+    // then can't change any value, so skipping them gives the same results.
+    axial_ = g2l_ == Rotation3D() && l2g_ == Rotation3D();
+  }
+
+  DVDP CentralHelix::toGlobal(DVDP const& ldxdp) const {
+    if(axial_) return ldxdp;
+    RMAT l2gmat;
+    l2g_.GetRotationMatrix(l2gmat);
+    return l2gmat*ldxdp;
+  }
+
+  DPDV CentralHelix::toGlobal(DPDV const& ldpdx) const {
+    if(axial_) return ldpdx;
+    RMAT g2lmat;
+    g2l_.GetRotationMatrix(g2lmat);
+    return ldpdx*g2lmat;
   }
 
   CentralHelix::CentralHelix(CentralHelix const& other, VEC3 const& bnom, double trot) : CentralHelix(other) {
     mbar_ *= bnom_.R()/bnom.R();
     bnom_ = bnom;
     pars_.parameters() += other.dPardB(trot,bnom);
-    g2l_ = Rotation3D(AxisAngle(VEC3(sin(bnom_.Phi()),-cos(bnom_.Phi()),0.0),bnom_.Theta()));
-    l2g_ = g2l_.Inverse();
+    setRotations();
   }
 
   CentralHelix::CentralHelix(Parameters const &pdata, double mass, int charge, double bnom, TimeRange const& range) : trange_(range),  pars_(pdata), mass_(mass), charge_(charge), bnom_(VEC3(0.0,0.0,bnom)){
@@ -148,7 +166,7 @@ namespace KinKal {
   }
 
   VEC3 CentralHelix::position3(double time) const {
-    return l2g_(localPosition(time));
+    return toGlobal(localPosition(time));
   }
 
   VEC3 CentralHelix::localPosition(double time) const
@@ -185,7 +203,7 @@ namespace KinKal {
   }
 
   VEC3 CentralHelix::direction(double time, MomBasis::Direction mdir) const {
-    return l2g_(localDirection(time,mdir));
+    return toGlobal(localDirection(time,mdir));
   }
 
   VEC3 CentralHelix::localDirection(double time,MomBasis::Direction mdir) const
@@ -209,14 +227,15 @@ namespace KinKal {
   }
 
   DPDV CentralHelix::dPardMLoc(double time) const {
-    auto locmom = localMomentum(time);
+    return dPardMLoc(time,localMomentum(time),sin(phi0()),cos(phi0()));
+  }
+
+  DPDV CentralHelix::dPardMLoc(double time, VEC3 const& locmom, double sphi0, double cphi0) const {
     double pt2 = locmom.perp2();
     double pt = sqrt(pt2);
     double fx = locmom.X()/pt2;
     double fy = locmom.Y()/pt2;
     double invqval = 1.0/Q();
-    double cphi0 = cos(phi0());
-    double sphi0 = sin(phi0());
     double invrc = 1.0/sqrt(center().perp2());
     double omval = Omega();
     double inve = 1.0/energy();
@@ -247,9 +266,7 @@ namespace KinKal {
 
   DPDV CentralHelix::dPardM(double time) const {
     // now rotate these into local space
-    RMAT g2lmat;
-    g2l_.GetRotationMatrix(g2lmat);
-    return dPardMLoc(time)*g2lmat;
+    return toGlobal(dPardMLoc(time));
   }
 
   DVDP CentralHelix::dMdPar(double time) const {
@@ -279,9 +296,7 @@ namespace KinKal {
     dMdP.Place_in_col(dM_dz0,0,z0_);
     dMdP.Place_in_col(dM_dt0,0,t0_);
     // now rotate these into global space
-    RMAT l2gmat;
-    l2g_.GetRotationMatrix(l2gmat);
-    return l2gmat*dMdP;
+    return toGlobal(dMdP);
   }
 
   DPDV CentralHelix::dPardXLoc(double time) const {
@@ -307,15 +322,16 @@ namespace KinKal {
   }
 
   DVDP CentralHelix::dXdPar(double time) const {
-    // first find the derivatives wrt local cartesian coordinates
-    // euclidean space is row, parameter space is column
     double dp = dphi(time);
     double phit = dp+phi0();
+    // rotate the local derivatives into global space
+    return toGlobal(dXdParLoc(dp,sin(phit),cos(phit),sin(phi0()),cos(phi0())));
+  }
+
+  DVDP CentralHelix::dXdParLoc(double dp, double sphi, double cphi, double sphi0, double cphi0) const {
+    // find the derivatives wrt local cartesian coordinates
+    // euclidean space is row, parameter space is column
     double cDip = cosDip();
-    double sphi = sin(phit);
-    double cphi = cos(phit);
-    double sphi0 = sin(phi0());
-    double cphi0 = cos(phi0());
     double bta = beta();
     double invom = 1.0/omega();
 
@@ -332,17 +348,42 @@ namespace KinKal {
     dXdP.Place_in_col(dX_dz0,0,z0_);
     dXdP.Place_in_col(dX_dtanDip,0,tanDip_);
     dXdP.Place_in_col(dX_dt0,0,t0_);
-    // now rotate these into global space
-    RMAT l2gmat;
-    l2g_.GetRotationMatrix(l2gmat);
-    return l2gmat*dXdP;
+    return dXdP;
+  }
+
+  void CentralHelix::evaluate(double time, unsigned content, TrajEvaluation& eval) const {
+    // compute the phase and the trig functions once for all the content
+    double dp = dphi(time);
+    double phit = dp + phi0();
+    double cphit = cos(phit);
+    double sphit = sin(phit);
+    double sphi0 = sin(phi0());
+    double cphi0 = cos(phi0());
+    double cosdip = cosDip();
+    double sindip = sinDip();
+    double rho = 1.0/omega();
+    VEC3 pos = toGlobal(rho*VEC3((sphit - sphi0),  -(cphit - cphi0), tanDip()*(phit-phi0())) +
+      VEC3(- d0()*sphi0, d0()*cphi0, z0()));
+    eval.pos_ = VEC4(pos.X(),pos.Y(),pos.Z(),time);
+    VEC3 ldir(cosdip * cphit, cosdip* sphit, sindip);
+    eval.dir_[MomBasis::momdir_] = toGlobal(ldir);
+    eval.vel_ = CLHEP::c_light * beta()*eval.dir_[MomBasis::momdir_];
+    if(content & TrajEvaluation::basis){
+      eval.dir_[MomBasis::perpdir_] = toGlobal(VEC3(-sindip * cphit, -sindip * sphit, cosdip));
+      eval.dir_[MomBasis::phidir_] = toGlobal(VEC3(-sphit, cphit, 0.0));
+    }
+    if(content & TrajEvaluation::acceleration) eval.acc_ = toGlobal(VEC3(-sphit, cphit, 0.0)*(rho*Omega()*Omega()));
+    if(content & TrajEvaluation::dXdPar){
+      eval.dXdP_ = toGlobal(dXdParLoc(dp,sphit,cphit,sphi0,cphi0));
+    }
+    if(content & TrajEvaluation::dPardM){
+      eval.dPdM_ = toGlobal(dPardMLoc(time,betaGamma()*mass()*ldir,sphi0,cphi0));
+    }
   }
 
   DPDV CentralHelix::dPardX(double time) const {
     // rotate into local space
-    RMAT g2lmat;
-    g2l_.GetRotationMatrix(g2lmat);
-    return dPardXLoc(time)*g2lmat;
+    return toGlobal(dPardXLoc(time));
   }
 
   DVEC CentralHelix::momDeriv(double time, MomBasis::Direction mdir) const
@@ -409,7 +450,7 @@ namespace KinKal {
 
   DVEC CentralHelix::dPardB(double time, VEC3 const& BPrime) const {
     // rotate Bfield difference into local coordinate system
-    VEC3 dB = g2l_(BPrime-bnom_);
+    VEC3 dB = toLocal(BPrime-bnom_);
     // find the parameter change due to BField magnitude change using component parallel to the local nominal Bfield (always along z)
     DVEC retval = dPardB(time)*dB.Z();
     // find the change in (local) position and momentum due to the rotation implied by the B direction change
@@ -12,6 +12,7 @@
 #include "KinKal/General/Parameters.hh"
 #include "KinKal/General/ParticleStateEstimate.hh"
 #include "KinKal/General/MomBasis.hh"
+#include "KinKal/General/TrajEvaluation.hh"
 #include "KinKal/General/BFieldMap.hh"
 #include "KinKal/General/PhysicalConstants.h"
 #include "Math/Rotation3D.h"
@@ -59,6 +60,8 @@ namespace KinKal {
       VEC3 momentum3(double time) const;
       VEC3 velocity(double time) const;
       VEC3 direction(double time, MomBasis::Direction mdir= MomBasis::momdir_) const;
+      // fused evaluation of the state and the content selected by the TrajEvaluation flags
+      void evaluate(double time, unsigned content, TrajEvaluation& eval) const;
       // scalar momentum and energy in MeV/c units
       double momentum(double time=0) const  { return fabs(mass_ * pbar() / mbar_); }
       double momentumVariance(double time=0) const;
@@ -142,8 +145,18 @@ namespace KinKal {
       VEC3 localMomentum(double time) const;
       VEC3 localPosition(double time) const;
       DPDV dPardMLoc(double time) const; // return the derivative of the parameters WRT the local (unrotated) momentum vector
+      // same, and the local position derivative, given the local momentum or phase, and the phi0 trig functions
+      DPDV dPardMLoc(double time, VEC3 const& locmom, double sphi0, double cphi0) const;
+      DVDP dXdParLoc(double dp, double sphi, double cphi, double sphi0, double cphi0) const;
       DPDV dPardXLoc(double time) const;
       PSMAT dPardStateLoc(double time) const; // derivative of parameters WRT local state
+      // set the rotations between local and global coordinates from bnom
+      void setRotations();
+      // rotate between local and global coordinates.  When bnom is along z the rotations are the identity, and are skipped
+      VEC3 toGlobal(VEC3 const& lvec) const { return axial_ ? lvec : l2g_(lvec); }
+      VEC3 toLocal(VEC3 const& gvec) const { return axial_ ? gvec : g2l_(gvec); }
+      DVDP toGlobal(DVDP const& ldxdp) const; // derivatives of a local vector WRT the parameters
+      DPDV toGlobal(DPDV const& ldpdx) const; // derivatives of the parameters WRT a local vector
       TimeRange trange_;
       Parameters pars_; // parameters
       double mass_;  // in units of MeV/c^2
@@ -151,6 +164,7 @@ namespace KinKal {
       double mbar_;  // reduced mass in units of mm, computed from the mass and nominal field
       VEC3 bnom_;    // nominal BField vector, from the map
       ROOT::Math::Rotation3D l2g_, g2l_; // rotations between local and global coordinates
+      bool axial_ = true; // the rotations are the identity
       const static std::vector<std::string> paramTitles_;
       const static std::vector<std::string> paramNames_;
       const static std::vector<std::string> paramUnits_;
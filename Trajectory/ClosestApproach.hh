@@ -7,9 +7,15 @@
 //  Used as part of the kinematic Kalman fit
 //
 #include "KinKal/Trajectory/ClosestApproachData.hh"
+#include "KinKal/General/TrajEvaluation.hh"
+#include "KinKal/General/ProfileCounters.hh"
 #include <memory>
 #include <iostream>
 #include <ostream>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 
 namespace KinKal {
   // Hint class for TCA calculation. TCA search will start at these TOCA values.  This allows to
@@ -19,6 +25,18 @@ namespace KinKal {
     double particleToca_, sensorToca_; // approximate values, used as starting points for cacluations
     CAHint(double ptoca,double stoca) :  particleToca_(ptoca), sensorToca_(stoca) {}
   };
+  // Configuration of the TCA iteration.  The default is the linearized Newton step (treating the particle trajectory as locally straight)
+  // starting from the hint.  The analytic hint replaces the hint with the intersection of the particle's transverse circle and the
+  // projected sensor line when that is closer; it helps when the hint is poor on curved trajectories.  The curvature step includes
+  // the particle acceleration in the Newton step, so the iteration converges quadratically even at large DOCA.
+  struct CAConfig {
+    unsigned maxiter_ = 100; // maximum number of iterations
+    bool analyticHint_ = false; // refine the hint analytically before iterating
+    bool curvatureStep_ = false; // use the curvature-corrected Newton step
+  };
+  // estimate TCA from the particle's transverse circle and a sensor line, given by its position, direction and speed at the hint.
+  // This implements CAConfig::analyticHint_
+  template<class KTRAJ> CAHint analyticCAHint(KTRAJ const& ktraj, CAHint const& hint, VEC3 const& spos, VEC3 const& sdir, double sspeed);
   // Class to calculate DOCA and TOCA using time parameterized trajectories.
   // Templated on the types of trajectories. The actual implementations must be specializations for particular trajectory classes.
   template<class KTRAJ, class STRAJ> class ClosestApproach {
@@ -26,15 +44,15 @@ namespace KinKal {
       using KTRAJPTR = std::shared_ptr<KTRAJ>;
       // construct from the particle and sensor trajectories; TCA is computed on construction, given a hint as to where
       // to start looking, which disambiguates functions with multiple solutions
-      ClosestApproach(KTRAJ const& ktraj, STRAJ const& straj, CAHint const& hint, double precision);
+      ClosestApproach(KTRAJ const& ktraj, STRAJ const& straj, CAHint const& hint, double precision, CAConfig const& caconfig=CAConfig());
       // same, using Ptrs
-      ClosestApproach(KTRAJPTR const& ktrajptr, STRAJ const& straj, CAHint const& hint, double precision);
+      ClosestApproach(KTRAJPTR const& ktrajptr, STRAJ const& straj, CAHint const& hint, double precision, CAConfig const& caconfig=CAConfig());
       // construct without a hint: TCA isn't calculated, state is invalid
-      ClosestApproach(KTRAJ const& ktraj, STRAJ const& straj, double precision);
-      ClosestApproach(KTRAJPTR const& ktrajptr, STRAJ const& straj, double precision);
+      ClosestApproach(KTRAJ const& ktraj, STRAJ const& straj, double precision, CAConfig const& caconfig=CAConfig());
+      ClosestApproach(KTRAJPTR const& ktrajptr, STRAJ const& straj, double precision, CAConfig const& caconfig=CAConfig());
       // explicitly construct from all content (no calculation)
       ClosestApproach(KTRAJPTR const& ktrajptr, STRAJ const& straj, double precision,
-          ClosestApproachData const& tpdata, DVEC const& dDdP, DVEC const& dTdP);
+          ClosestApproachData const& tpdata, DVEC const& dDdP, DVEC const& dTdP, CAConfig const& caconfig=CAConfig());
       // accessors
       ClosestApproachData const& tpData() const { return tpdata_; }
       KTRAJ const& particleTraj() const { return *ktrajptr_; }
@@ -45,6 +63,7 @@ namespace KinKal {
       DVEC const& dTdP() const { return dTdP_; }
       bool inRange() const { return particleTraj().inRange(particleToca()) && sensorTraj().inRange(sensorToca()); }
       double precision() const { return precision_; }
+      CAConfig const& config() const { return config_; }
       void print(std::ostream& ost=std::cout,int detail=0) const;
       // forward the data payload interface.
       ClosestApproachData::TPStat status() const { return tpdata_.status_; }
@@ -58,6 +77,7 @@ namespace KinKal {
       double particleToca() const { return tpdata_.particleToca(); }
       double sensorToca() const { return tpdata_.sensorToca(); }
       double lSign() const { return tpdata_.lsign_; } // sign of angular momentum
+      unsigned nIterations() const { return tpdata_.nIterations(); }
       VEC4 const& particlePoca() const { return tpdata_.particlePoca(); }
       VEC4 const& sensorPoca() const { return tpdata_.sensorPoca(); }
       VEC4 delta() const { return tpdata_.delta(); }
@@ -69,38 +89,43 @@ namespace KinKal {
       ClosestApproach& operator = (ClosestApproach const& other);
     private:
       double precision_; // precision used to define convergence
+      CAConfig config_; // iteration configuration
       KTRAJPTR ktrajptr_; // kinematic particle trajectory
       STRAJ const& straj_; // sensor trajectory
     protected:
       // calculate CA given the hint, and fill the state
       void findTCA(CAHint const& hint);
+      // estimate TCA from the particle's transverse circle and the sensor line at the hint
+      CAHint analyticHint(CAHint const& hint) const;
       ClosestApproachData tpdata_; // data payload of CA calculation
       DVEC dDdP_; // derivative of DOCA WRT Parameters
       DVEC dTdP_; // derivative of TOCA WRT Parameters
   };
 
-  template<class KTRAJ, class STRAJ> ClosestApproach<KTRAJ,STRAJ>::ClosestApproach(KTRAJ const& ktraj, STRAJ const& straj, double prec) :
-    precision_(prec),ktrajptr_(new KTRAJ(ktraj)), straj_(straj) {}
+  template<class KTRAJ, class STRAJ> ClosestApproach<KTRAJ,STRAJ>::ClosestApproach(KTRAJ const& ktraj, STRAJ const& straj, double prec,
+    CAConfig const& caconfig) : precision_(prec), config_(caconfig), ktrajptr_(new KTRAJ(ktraj)), straj_(straj) {}
 
-  template<class KTRAJ, class STRAJ> ClosestApproach<KTRAJ,STRAJ>::ClosestApproach(KTRAJPTR const& ktrajptr, STRAJ const& straj, double prec) :
-    precision_(prec),ktrajptr_(ktrajptr), straj_(straj) {}
+  template<class KTRAJ, class STRAJ> ClosestApproach<KTRAJ,STRAJ>::ClosestApproach(KTRAJPTR const& ktrajptr, STRAJ const& straj, double prec,
+    CAConfig const& caconfig) : precision_(prec), config_(caconfig), ktrajptr_(ktrajptr), straj_(straj) {}
 
   template<class KTRAJ, class STRAJ> ClosestApproach<KTRAJ,STRAJ>::ClosestApproach(KTRAJPTR const& ktrajptr, STRAJ const& straj, double prec,
-    ClosestApproachData const& tpdata, DVEC const& dDdP, DVEC const& dTdP) :
-   precision_(prec),ktrajptr_(ktrajptr), straj_(straj), tpdata_(tpdata),dDdP_(dDdP), dTdP_(dTdP) {}
+    ClosestApproachData const& tpdata, DVEC const& dDdP, DVEC const& dTdP, CAConfig const& caconfig) :
+   precision_(prec), config_(caconfig), ktrajptr_(ktrajptr), straj_(straj), tpdata_(tpdata),dDdP_(dDdP), dTdP_(dTdP) {}
 
   template<class KTRAJ, class STRAJ> ClosestApproach<KTRAJ,STRAJ>::ClosestApproach(KTRAJ const& ktraj, STRAJ const& straj, CAHint const& hint,
-      double prec) : ClosestApproach(ktraj,straj,prec) {
+      double prec, CAConfig const& caconfig) : ClosestApproach(ktraj,straj,prec,caconfig) {
     findTCA(hint);
   }
 
   template<class KTRAJ, class STRAJ> ClosestApproach<KTRAJ,STRAJ>::ClosestApproach(KTRAJPTR const& ktrajptr, STRAJ const& straj, CAHint const& hint,
-      double prec) : ClosestApproach(ktrajptr,straj,prec) {
+      double prec, CAConfig const& caconfig) : ClosestApproach(ktrajptr,straj,prec,caconfig) {
     findTCA(hint);
   }
 
   template<class KTRAJ, class STRAJ> ClosestApproach<KTRAJ,STRAJ>& ClosestApproach<KTRAJ,STRAJ>::operator = (ClosestApproach const& other)
   {
+    precision_ = other.precision_;
+    config_ = other.config_;
     tpdata_ = other. tpData();
     dDdP_ = other.dDdP();
     dTdP_ = other.dTdP();
@@ -114,20 +139,24 @@ namespace KinKal {
     // reset status
     tpdata_.reset();
     // initialize TOCA using hints
-    tpdata_.partCA_.SetE(hint.particleToca_);
-    tpdata_.sensCA_.SetE(hint.sensorToca_);
-    static const unsigned maxiter=100; // don't allow infinite iteration.  This should be a parameter FIXME!
+    CAHint start = config_.analyticHint_ ? analyticHint(hint) : hint;
+    tpdata_.partCA_.SetE(start.particleToca_);
+    tpdata_.sensCA_.SetE(start.sensorToca_);
+    unsigned maxiter = config_.maxiter_; // don't allow infinite iteration
     unsigned niter(0);
     // speed doesn't change
     double pspeed = ktrajptr_->speed(particleToca());
     double sspeed = straj_.speed(sensorToca());
     // iterate until change in TOCA is less than precision
     double dptoca(std::numeric_limits<double>::max()), dstoca(std::numeric_limits<double>::max());
+    TrajEvaluation peval; // particle position and direction are evaluated together
+    unsigned content = config_.curvatureStep_ ? TrajEvaluation::acceleration : TrajEvaluation::basic;
     while(tpdata_.usable() && (fabs(dptoca) > precision() || fabs(dstoca) > precision()) && niter++ < maxiter) {
       // find positions and directions at the current TOCA estimate
-      tpdata_.partCA_ = ktrajptr_->position4(tpdata_.particleToca());
+      ktrajptr_->evaluate(tpdata_.particleToca(),content,peval);
+      tpdata_.partCA_ = peval.pos_;
       tpdata_.sensCA_ = straj_.position4(tpdata_.sensorToca());
-      tpdata_.pdir_ = ktrajptr_->direction(particleToca());
+      tpdata_.pdir_ = peval.direction();
       tpdata_.sdir_ = straj_.direction(sensorToca());
       VEC3 dpos = sensorPoca().Vect()-particlePoca().Vect();
       // dot products
@@ -141,12 +170,22 @@ namespace KinKal {
       double hdd = dpos.Dot(particleDirection());
       double ldd = dpos.Dot(sensorDirection());
       // compute the change in times
-      dptoca = (hdd - ldd*ddot)/(denom*pspeed);
-      dstoca = (hdd*ddot - ldd)/(denom*sspeed);
+      double curv = config_.curvatureStep_ ? dpos.Dot(peval.acc_)/(pspeed*pspeed) : 0.0;
+      if(curv != 0.0 && denom - curv > 1.0e-5){
+        // include the particle curvature in the Hessian of the distance (exact Newton step), when that leaves it positive-definite
+        double cdenom = denom - curv;
+        dptoca = (hdd - ldd*ddot)/(cdenom*pspeed);
+        dstoca = (hdd*ddot - ldd + curv*ldd)/(cdenom*sspeed);
+      } else {
+        dptoca = (hdd - ldd*ddot)/(denom*pspeed);
+        dstoca = (hdd*ddot - ldd)/(denom*sspeed);
+      }
       // update the TOCA estimates
       tpdata_.partCA_.SetE(particleToca()+dptoca);
       tpdata_.sensCA_.SetE(sensorToca()+dstoca);
     }
+    KINKAL_PROFILE_COUNT(ntcaiters_,niter);
+    tpdata_.niter_ = std::min(niter,maxiter);
     if(tpdata_.status_ != ClosestApproachData::pocafailed){
       if(niter < maxiter)
         tpdata_.status_ = ClosestApproachData::converged;
@@ -154,10 +193,11 @@ namespace KinKal {
         tpdata_.status_ = ClosestApproachData::unconverged;
       // need to add divergence and oscillation tests FIXME!
     }
-    // final update
-    tpdata_.partCA_ = ktrajptr_->position4(tpdata_.particleToca());
+    // final update, including the position derivatives if the result is usable
+    ktrajptr_->evaluate(tpdata_.particleToca(),usable() ? TrajEvaluation::dXdPar : TrajEvaluation::basic,peval);
+    tpdata_.partCA_ = peval.pos_;
     tpdata_.sensCA_ = straj_.position4(tpdata_.sensorToca());
-    tpdata_.pdir_ = ktrajptr_->direction(particleToca());
+    tpdata_.pdir_ = peval.direction();
     tpdata_.sdir_ = straj_.direction(sensorToca());
     // fill the rest of the state
     if(usable()){
@@ -168,9 +208,8 @@ namespace KinKal {
       VEC3 dvechat = dvec.Unit();
       // now variances due to the particle trajectory parameter covariance
       // for DOCA, project the spatial position derivative along the delta-CA direction
-      DVDP dxdp = ktrajptr_->dXdPar(particleToca());
       SVEC3 dv(dvechat.X(),dvechat.Y(),dvechat.Z());
-      dDdP_ = -dv*dxdp;
+      dDdP_ = -dv*peval.dXdP_;
       dTdP_[KTRAJ::t0Index()] = -1.0;  // TOCA is 100% anti-correlated with the (mandatory) t0 component.
       // project the parameter covariance onto DOCA and TOCA
       tpdata_.docavar_ = ROOT::Math::Similarity(dDdP(),ktrajptr_->params().covariance());
@@ -178,6 +217,67 @@ namespace KinKal {
     }
   }
 
+  template<class KTRAJ, class STRAJ> CAHint ClosestApproach<KTRAJ,STRAJ>::analyticHint(CAHint const& hint) const {
+    return analyticCAHint(*ktrajptr_,hint,straj_.position3(hint.sensorToca_),straj_.direction(hint.sensorToca_),straj_.speed(hint.sensorToca_));
+  }
+
+  template<class KTRAJ> CAHint analyticCAHint(KTRAJ const& ktraj, CAHint const& hint, VEC3 const& spos, VEC3 const& sdir, double sspeed) {
+    // particle state at the hint.  Without curvature, the hint can't be improved
+    TrajEvaluation peval;
+    ktraj.evaluate(hint.particleToca_,TrajEvaluation::acceleration,peval);
+    VEC3 zdir = ktraj.bnom(hint.particleToca_).Unit();
+    VEC3 vperp = peval.vel_ - peval.vel_.Dot(zdir)*zdir;
+    double vperp2 = vperp.Mag2();
+    double amag2 = peval.acc_.Mag2();
+    if(vperp2 <= 0.0 || amag2 <= 0.0) return hint;
+    // transverse circle of the particle in the plane perpendicular to the field; the acceleration points to the center
+    VEC3 ppos = peval.pos_.Vect();
+    VEC3 center = ppos + (vperp2/amag2)*peval.acc_;
+    double rad2 = vperp2*vperp2/amag2;
+    double omega = peval.acc_.Dot(zdir.Cross(vperp))/vperp2; // signed angular velocity around the field
+    VEC3 rpart = ppos - center;
+    rpart -= rpart.Dot(zdir)*zdir;
+    // sensor as a line through its position at the hint, projected into the same plane
+    VEC3 rsens = spos - center;
+    rsens -= rsens.Dot(zdir)*zdir;
+    VEC3 sdirp = sdir - sdir.Dot(zdir)*zdir;
+    double sdirp2 = sdirp.Mag2();
+    // candidate particle positions relative to the center: the intersections of the circle with the projected line,
+    // otherwise the point of the projected line nearest the circle
+    std::array<VEC3,2> cands;
+    unsigned ncand(0);
+    if(sdirp2 > 1.0e-6){
+      double sfoot = -rsens.Dot(sdirp)/sdirp2;
+      VEC3 foot = rsens + sfoot*sdirp;
+      double disc = rad2 - foot.Mag2();
+      if(disc > 0.0){
+        double sdel = sqrt(disc/sdirp2);
+        cands[ncand++] = foot + sdel*sdirp;
+        cands[ncand++] = foot - sdel*sdirp;
+      } else
+        cands[ncand++] = foot;
+    } else
+      cands[ncand++] = rsens; // sensor along the field
+    // choose the candidate nearest the sensor line in space, starting from the hint itself.  The phase change is taken
+    // in [-pi,pi] so that the particle stays on the same loop as the hint
+    auto sensorDist2 = [&](VEC3 const& pos, double& slen) { slen = (pos-spos).Dot(sdir); return (pos - spos - slen*sdir).Mag2(); };
+    double slen;
+    double bestdist2 = sensorDist2(ppos,slen);
+    CAHint best(hint);
+    for(unsigned icand=0; icand < ncand; icand++){
+      auto const& rcand = cands[icand];
+      if(rcand.Mag2() <= 0.0) continue; // the phase is undefined
+      double dphi = atan2(rpart.Cross(rcand).Dot(zdir),rpart.Dot(rcand));
+      double ptoca = hint.particleToca_ + dphi/omega;
+      double dist2 = sensorDist2(ktraj.position3(ptoca),slen);
+      if(dist2 < bestdist2){
+        bestdist2 = dist2;
+        best = CAHint(ptoca,hint.sensorToca_ + slen/sspeed);
+      }
+    }
+    return best;
+  }
+
   template<class KTRAJ, class STRAJ> void ClosestApproach<KTRAJ,STRAJ>::print(std::ostream& ost,int detail) const {
     ost << "ClosestApproach status " << statusName() << " Doca " << doca() << " +- " << sqrt(docaVar())
       << " dToca " << deltaT() << " +- " << sqrt(tocaVar()) << " cos(theta) " << dirDot() << " Precision " << precision() << std::endl;
@@ -6,7 +6,7 @@ namespace KinKal {
   std::ostream& operator << (std::ostream& ost, ClosestApproachData const& cadata) {
     ost << "DOCA = " << cadata.doca() << " +- " << sqrt(cadata.docaVar()) << " sign = " << cadata.lSign()
     << " DeltaT = " << cadata.deltaT() << " +- " << sqrt(cadata.tocaVar())
-    << " pdir.Dot(sdir) = " << cadata.dirDot();
+    << " pdir.Dot(sdir) = " << cadata.dirDot() << " iterations = " << cadata.nIterations();
     return ost;
   }
 }
@@ -26,13 +26,15 @@ namespace KinKal {
     double tocaVar() const { return tocavar_; } // uncertainty on toca due to particle trajectory parameter uncertainties (NOT sensory uncertainties)
     double dirDot() const { return pdir_.Dot(sdir_); }
     double lSign() const { return lsign_; } // sign of angular momentum
+    unsigned nIterations() const { return niter_; } // number of iterations used in the calculation
     // utility functions
     VEC4 delta() const { return sensCA_-partCA_; } // measurement - prediction convention
     double deltaT() const { return sensCA_.T() - partCA_.T(); }
     bool usable() const { return status_ < diverged; }
-    ClosestApproachData() : status_(invalid), doca_(-1.0), docavar_(-1.0), tocavar_(-1.0), lsign_(0.0)  {}
+    ClosestApproachData() : status_(invalid), doca_(-1.0), docavar_(-1.0), tocavar_(-1.0), lsign_(0.0), niter_(0)  {}
     TPStat status_; // status of computation
     double doca_, docavar_, tocavar_, lsign_;
+    unsigned niter_; // iterations
     VEC3 pdir_, sdir_; // particle and sensor directions at CA, signed by time propagation
     VEC4 partCA_, sensCA_; //CA for particle and sensor
     void reset() {status_ = unconverged;}
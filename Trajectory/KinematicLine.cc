@@ -171,12 +171,14 @@ namespace KinKal {
   }
 
   DVDP KinematicLine::dXdPar(double time) const {
+    return dXdPar(time,sin(phi0()),cos(phi0()));
+  }
+
+  DVDP KinematicLine::dXdPar(double time, double sinF, double cosF) const {
     double deltat = time-t0();
     double sinT = sinTheta();
     double cotT = 1.0/tanTheta();
     double cosT = cosTheta();
-    double sinF = sin(phi0());
-    double cosF = cos(phi0());
     double spd = speed();
     double gam = gamma();
     SVEC3 dX_dd0(-sinF, cosF, 0.0);
@@ -233,15 +235,15 @@ namespace KinKal {
   }
 
   DPDV KinematicLine::dPardM(double time) const {
+    return dPardM(sin(phi0()),cos(phi0()),position3(time),momentum3(time));
+  }
+
+  DPDV KinematicLine::dPardM(double sinF, double cosF, VEC3 const& pos, VEC3 const& momv) const {
     double sinT = sinTheta();
     double cosT = cosTheta();
     double cotT = 1.0/tanTheta();
-    double sinF = sin(phi0());
-    double cosF = cos(phi0());
     double cos2F = cosF*cosF-sinF*sinF;
     double sin2F = 2*cosF*sinF;
-    VEC3 momv = momentum3(time);
-    VEC3 pos = position3(time);
     static VEC3 zdir(0.0,0.0,1.0);
     VEC3 momt = VectorUtil::PerpVector(momv,zdir);
     double momt2 = momt.Mag2();
@@ -266,6 +268,26 @@ namespace KinKal {
     return dPdM;
   }
 
+  void KinematicLine::evaluate(double time, unsigned content, TrajEvaluation& eval) const {
+    // compute the direction trig functions once for all the content
+    double sinF = sin(phi0());
+    double cosF = cos(phi0());
+    double sinT = sinTheta();
+    double cosT = cosTheta();
+    VEC3 dir(sinT*cosF,sinT*sinF,cosT);
+    VEC3 pos = VEC3(-d0()*sinF,d0()*cosF,z0()) + flightLength(time) * dir;
+    eval.pos_ = VEC4(pos.X(),pos.Y(),pos.Z(),time);
+    eval.dir_[MomBasis::momdir_] = dir;
+    eval.vel_ = dir * speed();
+    if(content & TrajEvaluation::basis){
+      eval.dir_[MomBasis::perpdir_] = VEC3(cosT * cosF, cosT * sinF, -1 * sinT);
+      eval.dir_[MomBasis::phidir_] = VEC3(-sinF, cosF, 0.0);
+    }
+    if(content & TrajEvaluation::acceleration) eval.acc_ = VEC3(0.0,0.0,0.0);
+    if(content & TrajEvaluation::dXdPar) eval.dXdP_ = dXdPar(time,sinF,cosF);
+    if(content & TrajEvaluation::dPardM) eval.dPdM_ = dPardM(sinF,cosF,pos,dir*mom());
+  }
+
   // derivatives of momentum projected along the given basis WRT the parameters
   DVEC KinematicLine::momDeriv(double time, MomBasis::Direction mdir) const {
     DPDV dPdM = dPardM(time);
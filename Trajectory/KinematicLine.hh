@@ -7,6 +7,7 @@
 #include "KinKal/General/PhysicalConstants.h"
 #include "KinKal/General/BFieldMap.hh"
 #include "KinKal/General/MomBasis.hh"
+#include "KinKal/General/TrajEvaluation.hh"
 #include "KinKal/General/ParticleStateEstimate.hh"
 #include "KinKal/General/Parameters.hh"
 #include "KinKal/General/TimeRange.hh"
@@ -116,6 +117,8 @@ class KinematicLine {
 
     // local momentum direction basis
     VEC3 direction(double time, MomBasis::Direction mdir = MomBasis::momdir_) const;
+    // fused evaluation of the state and the content selected by the TrajEvaluation flags
+    void evaluate(double time, unsigned content, TrajEvaluation& eval) const;
     // momentum change derivatives; this is required to instantiate a KalTrk
     DVEC momDeriv(double time, MomBasis::Direction mdir) const;
 
@@ -146,6 +149,9 @@ class KinematicLine {
     }
 
   private:
+    // derivatives given the phi0 trig functions, and the position and momentum at the given time
+    DVDP dXdPar(double time, double sinF, double cosF) const;
+    DPDV dPardM(double sinF, double cosF, VEC3 const& pos, VEC3 const& momv) const;
     const static std::string trajName_;
   // non-parametric variables
     VEC3 bnom_; // nominal BField: not used by this parameterization
@@ -0,0 +1,51 @@
+#ifndef KinKal_LineArray_hh
+#define KinKal_LineArray_hh
+//
+//  Structure-of-arrays storage of many Line sensor trajectories, for batch closest approach calculations.
+//  The components are stored contiguously so that loops over the lines can be vectorized.
+//
+#include "KinKal/Trajectory/Line.hh"
+#include <vector>
+namespace KinKal {
+  class LineArray {
+    public:
+      LineArray() {}
+      explicit LineArray(std::vector<Line> const& lines) { reserve(lines.size()); for(auto const& line : lines) push_back(line); }
+      void reserve(size_t nlines);
+      void clear();
+      void push_back(Line const& line);
+      size_t size() const { return t0_.size(); }
+      // accessors for a single line, equivalent to the Line functions
+      VEC3 startPosition(size_t iline) const { return VEC3(x0_[iline],y0_[iline],z0_[iline]); }
+      VEC3 direction(size_t iline) const { return VEC3(dx_[iline],dy_[iline],dz_[iline]); }
+      double t0(size_t iline) const { return t0_[iline]; }
+      double speed(size_t iline) const { return speed_[iline]; }
+      double length(size_t iline) const { return length_[iline]; }
+      VEC3 position3(size_t iline, double time) const { return startPosition(iline) + ((time-t0_[iline])*speed_[iline])*direction(iline); }
+      // component arrays
+      std::vector<double> x0_, y0_, z0_; // start position
+      std::vector<double> dx_, dy_, dz_; // unit direction
+      std::vector<double> t0_; // time at the start position
+      std::vector<double> speed_; // signal propagation speed
+      std::vector<double> length_; // line length
+  };
+
+  inline void LineArray::reserve(size_t nlines) {
+    for(auto vec : {&x0_,&y0_,&z0_,&dx_,&dy_,&dz_,&t0_,&speed_,&length_}) vec->reserve(nlines);
+  }
+
+  inline void LineArray::clear() {
+    for(auto vec : {&x0_,&y0_,&z0_,&dx_,&dy_,&dz_,&t0_,&speed_,&length_}) vec->clear();
+  }
+
+  inline void LineArray::push_back(Line const& line) {
+    auto const& pos = line.startPosition();
+    auto const& dir = line.direction();
+    x0_.push_back(pos.X()); y0_.push_back(pos.Y()); z0_.push_back(pos.Z());
+    dx_.push_back(dir.X()); dy_.push_back(dir.Y()); dz_.push_back(dir.Z());
+    t0_.push_back(line.t0());
+    speed_.push_back(line.speed());
+    length_.push_back(line.length());
+  }
+}
+#endif
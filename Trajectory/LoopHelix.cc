@@ -35,13 +35,11 @@ namespace KinKal {
     // The transform is a pure rotation about the origin
     VEC4 pos(pos0);
     MOM4 mom(mom0);
-    g2l_ = Rotation3D(AxisAngle(VEC3(sin(bnom_.Phi()),-cos(bnom_.Phi()),0.0),bnom_.Theta()));
+    setRotations();
     if(fabs(g2l_(bnom_).Theta()) > 1.0e-6)throw invalid_argument("Rotation Error");
     // to convert global vectors into parameters they must first be rotated into the local system.
     pos = g2l_(pos);
     mom = g2l_(mom);
-    // create inverse rotation; this moves back into the global coordinate system
-    l2g_ = g2l_.Inverse();
     // compute some simple useful parameters
     double pt = mom.Pt();
     double phibar = mom.Phi();
@@ -75,8 +73,29 @@ namespace KinKal {
     pars_.parameters() += dPardB(time,bnom);
     bnom_ = bnom;
     // adjust rotations to global space
+    setRotations();
+  }
+
+  void LoopHelix::setRotations() {
     g2l_ = Rotation3D(AxisAngle(VEC3(sin(bnom_.Phi()),-cos(bnom_.Phi()),0.0),bnom_.Theta()));
     l2g_ = g2l_.Inverse();
+    // When bnom is along +z the rotation angle is 0 and the matrices are exactly the identity.  Rotating by them
+    // then can't change any value, so skipping them gives the same results.
+    axial_ = g2l_ == Rotation3D() && l2g_ == Rotation3D();
+  }
+
+  DVDP LoopHelix::toGlobal(DVDP const& ldxdp) const {
+    if(axial_) return ldxdp;
+    RMAT l2gmat;
+    l2g_.GetRotationMatrix(l2gmat);
+    return l2gmat*ldxdp;
+  }
+
+  DPDV LoopHelix::toGlobal(DPDV const& ldpdx) const {
+    if(axial_) return ldpdx;
+    RMAT g2lmat;
+    g2l_.GetRotationMatrix(g2lmat);
+    return ldpdx*g2lmat;
   }
 
   LoopHelix::LoopHelix(LoopHelix const& other, VEC3 const& bnom, double tref) : LoopHelix(other) {
@@ -90,8 +109,7 @@ namespace KinKal {
   LoopHelix::LoopHelix( Parameters const& pars, double mass, int charge, VEC3 const& bnom, TimeRange const& trange ) :
     trange_(trange), pars_(pars), mass_(mass), charge_(charge), bnom_(bnom) {
       // set the transforms
-      g2l_ = Rotation3D(AxisAngle(VEC3(sin(bnom_.Phi()),-cos(bnom_.Phi()),0.0),bnom_.Theta()));
-      l2g_ = g2l_.Inverse();
+      setRotations();
     }
 
   LoopHelix::LoopHelix(ParticleState const& pstate, VEC3 const& bnom, TimeRange const& range) :
@@ -117,7 +135,7 @@ namespace KinKal {
   }
 
   VEC3 LoopHelix::position3(double time) const {
-    return l2g_(localPosition(time));
+    return toGlobal(localPosition(time));
   }
 
   MOM4 LoopHelix::momentum4(double time) const{
@@ -159,7 +177,32 @@ namespace KinKal {
   }
 
   VEC3 LoopHelix::direction(double time, MomBasis::Direction mdir) const {
-    return l2g_(localDirection(time,mdir));
+    return toGlobal(localDirection(time,mdir));
+  }
+
+  void LoopHelix::evaluate(double time, unsigned content, TrajEvaluation& eval) const {
+    // compute the phase and its trig functions once for all the content
+    double dt = time-t0();
+    double df = omega()*dt;
+    double phival = df + phi0();
+    double sphi = sin(phival);
+    double cphi = cos(phival);
+    double invpb = -sign()/pbar();
+    VEC3 pos = toGlobal(VEC3(cx() + rad()*sphi, cy() - rad()*cphi, df*lam()));
+    eval.pos_ = VEC4(pos.X(),pos.Y(),pos.Z(),time);
+    eval.dir_[MomBasis::momdir_] = toGlobal(VEC3(rad()*cphi*invpb,rad()*sphi*invpb,lam()*invpb));
+    eval.vel_ = eval.dir_[MomBasis::momdir_]*speed(time);
+    if(content & TrajEvaluation::basis){
+      eval.dir_[MomBasis::perpdir_] = toGlobal(VEC3(lam()*cphi*invpb,lam()*sphi*invpb,-rad()*invpb));
+      eval.dir_[MomBasis::phidir_] = toGlobal(VEC3(-sphi,cphi,0.0));
+    }
+    if(content & TrajEvaluation::acceleration) eval.acc_ = toGlobal(VEC3(-sphi,cphi,0.0)*(rad()*omega()*omega()));
+    if(content & TrajEvaluation::dXdPar){
+      eval.dXdP_ = toGlobal(dXdParLoc(dt,sphi,cphi));
+    }
+    if(content & TrajEvaluation::dPardM){
+      eval.dPdM_ = toGlobal(dPardMLoc(dt,sphi,cphi));
+    }
   }
 
   // derivatives of parameters WRT momentum projected along the given momentum basis direction
@@ -187,13 +230,15 @@ namespace KinKal {
   }
 
   DPDV LoopHelix::dPardMLoc(double time) const {
+    double dt = time-t0();
+    double phival = omega()*dt + phi0();
+    return dPardMLoc(dt,sin(phival),cos(phival));
+  }
+
+  DPDV LoopHelix::dPardMLoc(double dt, double sphi, double cphi) const {
     // euclidean space is column, parameter space is row
     double omval = omega();
-    double dt = time-t0();
     double dphi = omval*dt;
-    double phival = dphi + phi0();
-    double sphi = sin(phival);
-    double cphi = cos(phival);
     double inve2 = 1.0/ebar2();
     SVEC3 T2(-sphi,cphi,0.0);
     SVEC3 dR_dM(cphi,sphi,0.0);
@@ -216,16 +261,12 @@ namespace KinKal {
 
   DPDV LoopHelix::dPardX(double time) const {
     // rotate into local space
-    RMAT g2lmat;
-    g2l_.GetRotationMatrix(g2lmat);
-    return dPardXLoc(time)*g2lmat;
+    return toGlobal(dPardXLoc(time));
   }
 
   DPDV LoopHelix::dPardM(double time) const {
     // now rotate these into local space
-    RMAT g2lmat;
-    g2l_.GetRotationMatrix(g2lmat);
-    return dPardMLoc(time)*g2lmat;
+    return toGlobal(dPardMLoc(time));
   }
 
   DVEC LoopHelix::dPardB(double time) const {
@@ -242,7 +283,7 @@ namespace KinKal {
 
   DVEC LoopHelix::dPardB(double time, VEC3 const& BPrime) const {
     // rotate new B field difference into local coordinate system
-    VEC3 dB = g2l_(BPrime-bnom_);
+    VEC3 dB = toLocal(BPrime-bnom_);
     // find the parameter change due to BField magnitude change usng component parallel to the local nominal Bfield (always along z)
     DVEC retval = dPardB(time)*dB.Z();
     // find the change in (local) position and momentum due to the rotation implied by the B direction change
@@ -260,14 +301,17 @@ namespace KinKal {
   }
 
   DVDP LoopHelix::dXdPar(double time) const {
-    // first find the derivatives wrt local cartesian coordinates
+    double dt = time-t0();
+    double phival = omega()*dt + phi0();
+    // rotate the local derivatives into global space
+    return toGlobal(dXdParLoc(dt,sin(phival),cos(phival)));
+  }
+
+  DVDP LoopHelix::dXdParLoc(double dt, double sphi, double cphi) const {
+    // find the derivatives wrt local cartesian coordinates
     // euclidean space is row, parameter space is column
     double omval = omega();
-    double dt = time-t0();
     double dphi = omval*dt;
-    double phival = dphi + phi0();
-    double sphi = sin(phival);
-    double cphi = cos(phival);
     double inve2 = 1.0/ebar2();
     SVEC3 T2(-sphi,cphi,0.0);
     SVEC3 T3(cphi,sphi,0.0);
@@ -286,10 +330,7 @@ namespace KinKal {
     dXdP.Place_in_col(dX_dCy,0,cy_);
     dXdP.Place_in_col(dX_dphi0,0,phi0_);
     dXdP.Place_in_col(dX_dt0,0,t0_);
-    // now rotate these into global space
-    RMAT l2gmat;
-    l2g_.GetRotationMatrix(l2gmat);
-    return l2gmat*dXdP;
+    return dXdP;
   }
 
   DVDP LoopHelix::dMdPar(double time) const {
@@ -314,9 +355,7 @@ namespace KinKal {
     dMdP.Place_in_col(dM_dt0,0,t0_);
     dMdP *= Q(); // scale to momentum
     // now rotate these into global space
-    RMAT l2gmat;
-    l2g_.GetRotationMatrix(l2gmat);
-    return l2gmat*dMdP;
+    return toGlobal(dMdP);
   }
 
   PSMAT LoopHelix::dPardStateLoc(double time) const{
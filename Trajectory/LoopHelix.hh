@@ -11,6 +11,7 @@
 #include "KinKal/General/TimeRange.hh"
 #include "KinKal/General/Parameters.hh"
 #include "KinKal/General/MomBasis.hh"
+#include "KinKal/General/TrajEvaluation.hh"
 #include "KinKal/General/BFieldMap.hh"
 #include "KinKal/General/ParticleStateEstimate.hh"
 #include "KinKal/General/PhysicalConstants.h"
@@ -70,6 +71,8 @@ namespace KinKal {
       double momentumVariance(double time=0) const;
       double energy(double time=0) const  { return  ebar()*Q(); }
       VEC3 direction(double time, MomBasis::Direction mdir= MomBasis::momdir_) const;
+      // fused evaluation of the state and the content selected by the TrajEvaluation flags
+      void evaluate(double time, unsigned content, TrajEvaluation& eval) const;
       double mass() const { return mass_;} // mass
       int charge() const { return charge_;} // charge in proton charge units
       double paramVal(size_t index) const { return pars_.parameters()[index]; }
@@ -130,7 +133,17 @@ namespace KinKal {
       VEC3 localPosition(double time) const;
       DPDV dPardXLoc(double time) const; // return the derivative of the parameters WRT the local (unrotated) position vector
       DPDV dPardMLoc(double time) const; // return the derivative of the parameters WRT the local (unrotated) momentum vector
+      // same, and the local position derivative, given the time since t0 and the phase trig functions
+      DPDV dPardMLoc(double dt, double sphi, double cphi) const;
+      DVDP dXdParLoc(double dt, double sphi, double cphi) const;
       PSMAT dPardStateLoc(double time) const; // derivative of parameters WRT local state
+      // set the rotations between local and global coordinates from bnom
+      void setRotations();
+      // rotate between local and global coordinates.  When bnom is along z the rotations are the identity, and are skipped
+      VEC3 toGlobal(VEC3 const& lvec) const { return axial_ ? lvec : l2g_(lvec); }
+      VEC3 toLocal(VEC3 const& gvec) const { return axial_ ? gvec : g2l_(gvec); }
+      DVDP toGlobal(DVDP const& ldxdp) const; // derivatives of a local vector WRT the parameters
+      DPDV toGlobal(DPDV const& ldpdx) const; // derivatives of the parameters WRT a local vector
 
       TimeRange trange_;
       Parameters pars_; // parameters
@@ -138,6 +151,7 @@ namespace KinKal {
       int charge_; // charge in units of proton charge
       VEC3 bnom_; // nominal BField, in global coordinate system
       ROOT::Math::Rotation3D l2g_, g2l_; // rotations between local and global coordinates
+      bool axial_ = true; // the rotations are the identity
       const static std::vector<std::string> paramTitles_;
       const static std::vector<std::string> paramNames_;
       const static std::vector<std::string> paramUnits_;
@@ -17,6 +17,9 @@ namespace KinKal {
       // construct from an initial piece, which also provides kinematic information
       ParticleTrajectory(KTRAJ const& piece) : PTTRAJ(piece) {}
       ParticleTrajectory() : PTTRAJ() {}
+      // construct using a buffer to store the pieces
+      explicit ParticleTrajectory(typename PTTRAJ::BUFFERPTR const& buffer) : PTTRAJ(buffer) {}
+      ParticleTrajectory(KTRAJ const& piece, typename PTTRAJ::BUFFERPTR const& buffer) : PTTRAJ(piece,buffer) {}
       //  append and prepend to check mass and charge consistency
       void append(KTRAJ const& newpiece, bool allowremove=false)  {
         if(PTTRAJ::pieces().size() > 0){
@@ -0,0 +1,72 @@
+#ifndef KinKal_PieceBuffer_hh
+#define KinKal_PieceBuffer_hh
+//
+//  Reusable storage for the pieces of a PiecewiseTrajectory.  Pieces are stored contiguously in fixed-capacity blocks
+//  which never reallocate, so the handle (shared_ptr) returned for a piece is stable.  Handles share ownership of
+//  their block (aliasing constructor), so creating a piece doesn't allocate.  A block is recycled only once no
+//  handle to any of its pieces remains outside the buffer, so a trajectory repeatedly rebuilt into the same buffer
+//  (as in the fit iteration) doesn't allocate in steady state.
+//  A buffer should only be used from 1 thread at a time.
+//
+#include "KinKal/General/ProfileCounters.hh"
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+namespace KinKal {
+  template <class KTRAJ> class PieceBuffer {
+    public:
+      using KTRAJPTR = std::shared_ptr<KTRAJ>;
+      explicit PieceBuffer(size_t blocksize=64) : blocksize_(blocksize), iblock_(0) {
+        if(blocksize_ == 0)throw std::invalid_argument("Invalid PieceBuffer block size");
+      }
+      // copy a piece into the buffer, returning a stable handle to it
+      KTRAJPTR create(KTRAJ const& piece);
+      // accessors
+      size_t blockSize() const { return blocksize_; }
+      size_t nBlocks() const { return blocks_.size(); }
+      // count the blocks with pieces still referenced from outside the buffer
+      size_t nUsedBlocks() const;
+    private:
+      using BLOCK = std::vector<KTRAJ>;
+      using BLOCKPTR = std::shared_ptr<BLOCK>;
+      bool isFree(size_t iblock) const { return blocks_[iblock].use_count() == 1; } // only the buffer references this block
+      std::vector<BLOCKPTR> blocks_; // storage blocks
+      size_t blocksize_; // number of pieces per block
+      size_t iblock_; // block currently being filled
+  };
+
+  template <class KTRAJ> typename PieceBuffer<KTRAJ>::KTRAJPTR PieceBuffer<KTRAJ>::create(KTRAJ const& piece) {
+    // if nothing references the current block anymore, restart it
+    if(blocks_.size() > 0 && isFree(iblock_)) blocks_[iblock_]->clear();
+    if(blocks_.size() == 0 || blocks_[iblock_]->size() == blocksize_){
+      // the current block is full: find a free block to recycle, otherwise add a new one
+      bool found(false);
+      for(size_t ioff = 1; ioff < blocks_.size(); ++ioff){
+        size_t iblock = (iblock_+ioff)%blocks_.size();
+        if(isFree(iblock)){
+          blocks_[iblock]->clear();
+          iblock_ = iblock;
+          found = true;
+          break;
+        }
+      }
+      if(!found){
+        KINKAL_PROFILE_COUNT(npieceallocs_,1);
+        blocks_.push_back(std::make_shared<BLOCK>());
+        blocks_.back()->reserve(blocksize_);
+        iblock_ = blocks_.size()-1;
+      }
+    }
+    auto& block = blocks_[iblock_];
+    block->push_back(piece); // capacity is reserved, so this never reallocates and existing handles stay valid
+    return KTRAJPTR(block,&block->back());
+  }
+
+  template <class KTRAJ> size_t PieceBuffer<KTRAJ>::nUsedBlocks() const {
+    size_t nused(0);
+    for(size_t iblock=0; iblock < blocks_.size(); ++iblock) if(!isFree(iblock)) ++nused;
+    return nused;
+  }
+}
+#endif
@@ -13,17 +13,18 @@ namespace KinKal {
       using PTRAJ = ParticleTrajectory<KTRAJ>;
       using KTCA = ClosestApproach<KTRAJ,STRAJ>;
       using KTRAJPTR = std::shared_ptr<KTRAJ>;
-      PiecewiseClosestApproach(PTRAJ const& ptraj, STRAJ const& straj, CAHint const& hint, double precision);
+      PiecewiseClosestApproach(PTRAJ const& ptraj, STRAJ const& straj, CAHint const& hint, double precision, CAConfig const& caconfig=CAConfig());
       // provide access to the local (non-piecewise) information implicit in this class
       size_t particleTrajIndex() const { return pindex_; }
       KTRAJ const& localParticleTraj() const { return this->particleTraj().piece(pindex_); }
       KTRAJPTR const& localTraj() const { return this->particleTraj().indexTraj(pindex_); }
-      KTCA localClosestApproach() const { return KTCA(localTraj(),this->sensorTraj(),this->precision(),this->tpData(),this->dDdP(),this->dTdP()); }
+      KTCA localClosestApproach() const { return KTCA(localTraj(),this->sensorTraj(),this->precision(),this->tpData(),this->dDdP(),this->dTdP(),this->config()); }
     private:
       size_t pindex_; // indices to the local traj used in TCA calculation
   };
 
-  template<class KTRAJ, class STRAJ> PiecewiseClosestApproach<KTRAJ,STRAJ>::PiecewiseClosestApproach(ParticleTrajectory<KTRAJ> const& ptraj, STRAJ const& straj, CAHint const& hint, double prec) : ClosestApproach<ParticleTrajectory<KTRAJ>,STRAJ>(ptraj,straj,prec) {
+  template<class KTRAJ, class STRAJ> PiecewiseClosestApproach<KTRAJ,STRAJ>::PiecewiseClosestApproach(ParticleTrajectory<KTRAJ> const& ptraj, STRAJ const& straj, CAHint const& hint, double prec,
+      CAConfig const& caconfig) : ClosestApproach<ParticleTrajectory<KTRAJ>,STRAJ>(ptraj,straj,prec,caconfig) {
     // iteratively find the nearest piece, and CA for that piece.  Start at hints if availalble, otherwise the middle
     static const unsigned maxiter=10; // don't allow infinite iteration.  This should be a parameter TODO
     unsigned niter=0;
@@ -31,11 +32,13 @@ namespace KinKal {
     this->pindex_ = this->particleTraj().nearestIndex(hint.particleToca_);
     // copy over the hint: it needs to evolve
     CAHint phint = hint;
+    unsigned ntca(0); // TCA iterations summed over the pieces
     // iterate until TCA is on the same piece
     do{
-      KTCA tpoca(this->particleTraj().piece(pindex_),this->sensorTraj(),phint,prec);
+      KTCA tpoca(this->particleTraj().piece(pindex_),this->sensorTraj(),phint,prec,caconfig);
       // copy the state
       this->tpdata_ = tpoca.tpData();
+      ntca += tpoca.nIterations();
       this->dDdP_ = tpoca.dDdP();
       this->dTdP_ = tpoca.dTdP();
       //      inrange = tpoca.inRange();
@@ -46,6 +49,7 @@ namespace KinKal {
       oldindex = pindex_;
       pindex_ = this->particleTraj().nearestIndex(tpoca.particlePoca().T());
     } while( pindex_ != oldindex && this->usable() && niter++ < maxiter);
+    this->tpdata_.niter_ = ntca;
     // overwrite the status if we oscillated on the piece
     if(this->tpdata_.status() == ClosestApproachData::converged && niter >= maxiter)
       this->tpdata_.status_ = ClosestApproachData::unconverged;
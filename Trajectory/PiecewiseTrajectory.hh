@@ -2,13 +2,19 @@
 #define KinKal_PiecewiseTrajectory_hh
 //
 //  class describing a piecewise trajectory.  Templated on a simple time-based trajectory
-//  used as part of the kinematic kalman fit
+//  used as part of the kinematic kalman fit.  Pieces are individually allocated, unless the trajectory
+//  is constructed with a PieceBuffer, in which case they are stored in the (reusable) buffer.
+//  The pieces are held in a vector (DKTRAJ) so that their storage is kept by clear() and reused.
+//  Prepending is therefore linear in the number of pieces; pieces are only prepended when extending a fit backwards
 //
 #include "KinKal/General/TimeDir.hh"
 #include "KinKal/General/Vectors.hh"
 #include "KinKal/General/MomBasis.hh"
+#include "KinKal/General/TrajEvaluation.hh"
 #include "KinKal/General/TimeRange.hh"
-#include <deque>
+#include "KinKal/Trajectory/PieceBuffer.hh"
+#include <vector>
+#include <algorithm>
 #include <memory>
 #include <ostream>
 #include <stdexcept>
@@ -18,13 +24,16 @@ namespace KinKal {
   template <class KTRAJ> class PiecewiseTrajectory {
     public:
       using KTRAJPTR = std::shared_ptr<KTRAJ>;
-      using DKTRAJ = std::deque<KTRAJPTR>;
+      using DKTRAJ = std::vector<KTRAJPTR>;
+      using BUFFER = PieceBuffer<KTRAJ>;
+      using BUFFERPTR = std::shared_ptr<BUFFER>;
       // forward calls to the pieces
       void position3(VEC4& pos) const {nearestPiece(pos.T()).position3(pos); }
       VEC3 position3(double time) const { return nearestPiece(time).position3(time); }
       VEC3 velocity(double time) const { return nearestPiece(time).velocity(time); }
       double speed(double time) const { return nearestPiece(time).speed(time); }
       VEC3 direction(double time, MomBasis::Direction mdir=MomBasis::momdir_) const { return nearestPiece(time).direction(time,mdir); }
+      void evaluate(double time, unsigned content, TrajEvaluation& eval) const { nearestPiece(time).evaluate(time,content,eval); }
       VEC3 const& bnom(double time) const { return nearestPiece(time).bnom(time); }
       double t0() const;
       TimeRange range() const { if(pieces_.size() > 0) return TimeRange(pieces_.front()->range().begin(),pieces_.back()->range().end()); else return TimeRange(); }
@@ -33,6 +42,17 @@ namespace KinKal {
       PiecewiseTrajectory() {}
       // construct from an initial piece
       PiecewiseTrajectory(KTRAJ const& piece);
+      // construct using a buffer to store the pieces, optionally with an initial piece
+      explicit PiecewiseTrajectory(BUFFERPTR const& buffer) : buffer_(buffer) {}
+      PiecewiseTrajectory(KTRAJ const& piece, BUFFERPTR const& buffer);
+      // a copy shares the existing pieces, but gets its own buffer (if the original has one) for new pieces,
+      // as a buffer can only be used from 1 thread at a time
+      PiecewiseTrajectory(PiecewiseTrajectory const& other);
+      PiecewiseTrajectory& operator =(PiecewiseTrajectory const& other);
+      PiecewiseTrajectory(PiecewiseTrajectory&& other) = default;
+      PiecewiseTrajectory& operator =(PiecewiseTrajectory&& other) = default;
+      // remove all pieces.  Storage is kept for reuse
+      void clear() { pieces_.clear(); tbounds_.clear(); }
       // append or prepend a piece, at the time of the corresponding end of the new trajectory.  The last
       // piece will be shortened or extended as necessary to keep time contiguous.
       // Optionally allow truncate existing pieces to accomodate this piece.
@@ -51,21 +71,45 @@ namespace KinKal {
       KTRAJ& back() { return *pieces_.back(); }
       KTRAJPTR const& frontPtr() const { return pieces_.front(); }
       KTRAJPTR const& backPtr() const { return pieces_.back(); }
+      // find the index of the piece associated with a particular time, using binary search of the piece boundaries
       size_t nearestIndex(double time) const;
+      // same, starting from a hint (cursor), typically the result of the previous call.  The hint is updated to the result.
+      // When sweeping monotonically in time this is O(1) per call.  Any hint value is allowed
+      size_t nearestIndex(double time, size_t& hint) const;
+      KTRAJPTR const& nearestTraj(double time, size_t& hint) const { return pieces_[nearestIndex(time,hint)]; }
+      KTRAJ const& nearestPiece(double time, size_t& hint) const { return *pieces_[nearestIndex(time,hint)]; }
       DKTRAJ const& pieces() const { return pieces_; }
+      BUFFERPTR const& buffer() const { return buffer_; }
       // test for spatial gaps
       double gap(size_t ihigh) const;
       void gaps(double& largest, size_t& ilargest, double& average) const;
       void print(std::ostream& ost, int detail) const ;
     private:
+      // test if a time is associated with a piece
+      bool owns(size_t index, double time) const {
+        return (index == 0 || time > tbounds_[index-1]) && (index+1 == pieces_.size() || time <= tbounds_[index]); }
+      // create storage for a new piece
+      KTRAJPTR makePiece(KTRAJ const& piece) const {
+        if(buffer_) return buffer_->create(piece);
+        KINKAL_PROFILE_COUNT(npieceallocs_,1);
+        return std::make_shared<KTRAJ>(piece);
+      }
       DKTRAJ pieces_; // constituent pieces
+      std::vector<double> tbounds_; // boundary times between adjacent pieces, sorted.  tbounds_[i] is the end of piece i
+      BUFFERPTR buffer_; // optional storage for the pieces
   };
 
   template <class KTRAJ> void PiecewiseTrajectory<KTRAJ>::setRange(TimeRange const& trange, bool trim) {
-    // trim pieces as necessary
+    if(pieces_.empty())throw std::length_error("Empty PiecewiseTrajectory!");
+    // trim pieces as necessary: find the pieces overlapping the range, and remove the others with single range erases
     if(trim){
-      while(pieces_.size() > 1 && trange.begin() > pieces_.front()->range().end() ) pieces_.pop_front();
-      while(pieces_.size() > 1 && trange.end() < pieces_.back()->range().begin() ) pieces_.pop_back();
+      size_t ifirst(0), iend(pieces_.size());
+      while(iend-ifirst > 1 && trange.begin() > pieces_[ifirst]->range().end() ) ++ifirst;
+      while(iend-ifirst > 1 && trange.end() < pieces_[iend-1]->range().begin() ) --iend;
+      pieces_.erase(pieces_.begin()+iend,pieces_.end());
+      tbounds_.erase(tbounds_.begin()+(iend-1),tbounds_.end());
+      pieces_.erase(pieces_.begin(),pieces_.begin()+ifirst);
+      tbounds_.erase(tbounds_.begin(),tbounds_.begin()+ifirst);
     } else if(trange.begin() > pieces_.front()->range().end() || trange.end() < pieces_.back()->range().begin())
       throw std::invalid_argument("Invalid Range");
     // update piece range
@@ -76,6 +120,28 @@ namespace KinKal {
   template <class KTRAJ> PiecewiseTrajectory<KTRAJ>::PiecewiseTrajectory(KTRAJ const& piece) : pieces_(1,std::make_shared<KTRAJ>(piece))
   {}
 
+  template <class KTRAJ> PiecewiseTrajectory<KTRAJ>::PiecewiseTrajectory(KTRAJ const& piece, BUFFERPTR const& buffer) : buffer_(buffer) {
+    pieces_.push_back(makePiece(piece));
+  }
+
+  template <class KTRAJ> PiecewiseTrajectory<KTRAJ>::PiecewiseTrajectory(PiecewiseTrajectory const& other) :
+    pieces_(other.pieces_), tbounds_(other.tbounds_) {
+      if(other.buffer_) buffer_ = std::make_shared<BUFFER>(other.buffer_->blockSize());
+    }
+
+  template <class KTRAJ> PiecewiseTrajectory<KTRAJ>& PiecewiseTrajectory<KTRAJ>::operator =(PiecewiseTrajectory const& other) {
+    if(this != &other){
+      pieces_ = other.pieces_;
+      tbounds_ = other.tbounds_;
+      // keep this trajectory's buffer, unless it's shared with the original
+      if(!other.buffer_)
+        buffer_.reset();
+      else if(!buffer_ || buffer_ == other.buffer_)
+        buffer_ = std::make_shared<BUFFER>(other.buffer_->blockSize());
+    }
+    return *this;
+  }
+
   template <class KTRAJ> void PiecewiseTrajectory<KTRAJ>::add(KTRAJ const& newpiece, TimeDir tdir, bool allowremove){
     switch (tdir) {
       case TimeDir::forwards:
@@ -93,30 +159,32 @@ namespace KinKal {
     // new piece can't have null range
     if(newpiece.range().null())throw std::invalid_argument("Can't prepend null range traj");
     if(pieces_.empty()){
-      pieces_.push_back(std::make_shared<KTRAJ>(newpiece));
+      pieces_.push_back(makePiece(newpiece));
     } else {
       // if the new piece completely contains the existing pieces, overwrite or fail
       if(newpiece.range().contains(range())){
-        if(allowremove)
-          *this = PiecewiseTrajectory(newpiece);
-        else
+        if(allowremove){
+          clear();
+          pieces_.push_back(makePiece(newpiece));
+        } else
           throw std::invalid_argument("range overlap");
       } else {
         // find the piece that needs to be modified
         size_t ipiece = nearestIndex(newpiece.range().end());
-        // see if truncation is needed
-        if( allowremove){
-          while(ipiece >0 )
-            pieces_.pop_front();
-          ipiece--;
+        // see if truncation is needed: remove the pieces before the one containing the end of the new piece
+        if( allowremove && ipiece > 0){
+          pieces_.erase(pieces_.begin(),pieces_.begin()+ipiece);
+          tbounds_.erase(tbounds_.begin(),tbounds_.begin()+ipiece);
+          ipiece = 0;
         }
         // if we're at the start, prepend
         if(ipiece == 0){
           // update ranges and add the piece
           double tmin = std::min(newpiece.range().begin(),pieces_.front()->range().begin());
           pieces_.front()->range() = TimeRange(newpiece.range().end(),pieces_.front()->range().end());
-          pieces_.push_front(std::make_shared<KTRAJ>(newpiece));
+          pieces_.insert(pieces_.begin(),makePiece(newpiece));
           pieces_.front()->range() = TimeRange(tmin,pieces_.front()->range().end());
+          tbounds_.insert(tbounds_.begin(),pieces_.front()->range().end());
         } else {
           throw std::invalid_argument("range error");
         }
@@ -128,13 +196,14 @@ namespace KinKal {
     // new piece can't have null range
     if(newpiece.range().null())throw std::invalid_argument("Can't append null range traj");
     if(pieces_.empty()){
-      pieces_.push_back(std::make_shared<KTRAJ>(newpiece));
+      pieces_.push_back(makePiece(newpiece));
     } else {
       // if the new piece completely contains the existing pieces, overwrite or fail
       if(newpiece.range().begin() < range().begin()){
-        if(allowremove)
-          *this = PiecewiseTrajectory(newpiece);
-        else
+        if(allowremove){
+          clear();
+          pieces_.push_back(makePiece(newpiece));
+        } else
           throw std::invalid_argument("range overlap");
       } else {
         // find the piece that needs to be modified
@@ -143,6 +212,7 @@ namespace KinKal {
         if( allowremove){
           while(ipiece < pieces_.size()-1) {
             pieces_.pop_back();
+            tbounds_.pop_back();
           }
         }
         // if we're at the end, append
@@ -152,7 +222,8 @@ namespace KinKal {
           double tmax = std::max(newpiece.range().end(),pieces_.back()->range().end());
           // truncate the range of the current back to match with the start of the new piece.
           pieces_.back()->range() = TimeRange(pieces_.back()->range().begin(),newpiece.range().begin());
-          pieces_.push_back(std::make_shared<KTRAJ>(newpiece));
+          tbounds_.push_back(pieces_.back()->range().end());
+          pieces_.push_back(makePiece(newpiece));
           pieces_.back()->range() = TimeRange(pieces_.back()->range().begin(),tmax);
         } else {
           throw std::invalid_argument("range error");
@@ -169,16 +240,24 @@ namespace KinKal {
     } else if(time >= range().end()){
       retval = pieces_.size()-1;
     } else {
-      // scan
-      retval = 0;
-      while(retval < pieces_.size() && (!pieces_[retval]->range().inRange(time)) && time > pieces_[retval]->range().end()){
-        retval++;
-      }
-      if(retval == pieces_.size())throw std::range_error("Failed PTraj range search");
+      // binary search for the first piece ending at or after this time
+      retval = std::distance(tbounds_.begin(),std::lower_bound(tbounds_.begin(),tbounds_.end(),time));
     }
     return retval;
   }
 
+  template <class KTRAJ> size_t PiecewiseTrajectory<KTRAJ>::nearestIndex(double time, size_t& hint) const {
+    if(pieces_.empty())throw std::length_error("Empty PiecewiseTrajectory!");
+    // test the hint and its neighbors first; these cover monotonic sweeps.  Times outside the range are handled below
+    if(time > pieces_.front()->range().begin() && time < pieces_.back()->range().end()){
+      if(hint < pieces_.size() && owns(hint,time)) return hint;
+      if(hint+1 < pieces_.size() && owns(hint+1,time)) return ++hint;
+      if(hint > 0 && hint <= pieces_.size() && owns(hint-1,time)) return --hint;
+    }
+    hint = nearestIndex(time);
+    return hint;
+  }
+
   template <class KTRAJ> double PiecewiseTrajectory<KTRAJ>::gap(size_t ihigh) const {
     double retval(0.0);
     if(ihigh>0 && ihigh < pieces_.size()){
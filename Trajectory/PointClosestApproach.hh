@@ -7,8 +7,10 @@
 //
 #include "KinKal/General/Vectors.hh"
 #include "KinKal/Trajectory/ClosestApproachData.hh"
+#include "KinKal/General/TrajEvaluation.hh"
 #include <iostream>
 #include <ostream>
+#include <algorithm>
 
 namespace KinKal {
   // Hint class for TCA calculation. TCA search will start at this TOCA values.  This allows to
@@ -50,6 +52,7 @@ namespace KinKal {
       bool usable() const { return tpdata_.usable(); }
       double particleToca() const { return tpdata_.particleToca(); }
       double lSign() const { return tpdata_.lsign_; } // sign of angular momentum
+      unsigned nIterations() const { return tpdata_.nIterations(); }
       VEC4 const& particlePoca() const { return tpdata_.particlePoca(); }
       VEC4 const& point() const { return tpdata_.sensorPoca(); }
       VEC4 delta() const { return tpdata_.delta(); }
@@ -89,23 +92,27 @@ namespace KinKal {
     double pspeed = ktraj_.speed(particleToca());
     // iterate until change in TOCA is less than precision
     double dptoca(std::numeric_limits<double>::max());
+    TrajEvaluation peval; // particle position and direction are evaluated together
     while(tpdata_.usable() && fabs(dptoca) > precision() && niter++ < maxiter) {
       // find positions and directions at the current TOCA estimate
-      tpdata_.partCA_ = ktraj_.position4(tpdata_.particleToca());
-      tpdata_.pdir_ = ktraj_.direction(particleToca());
+      ktraj_.evaluate(tpdata_.particleToca(),TrajEvaluation::basic,peval);
+      tpdata_.partCA_ = peval.pos_;
+      tpdata_.pdir_ = peval.direction();
       auto dpos = point().Vect()-particlePoca().Vect();
       // compute the change in times
       dptoca = dpos.Dot(tpdata_.pdir_)/pspeed;
       // update the TOCA estimates
       tpdata_.partCA_.SetE(particleToca()+dptoca);
     }
+    tpdata_.niter_ = std::min(niter,maxiter);
     if(niter < maxiter)
       tpdata_.status_ = ClosestApproachData::converged;
     else
       tpdata_.status_ = ClosestApproachData::unconverged;
-    // final update
-    tpdata_.partCA_ = ktraj_.position4(tpdata_.particleToca());
-    tpdata_.pdir_ = ktraj_.direction(particleToca());
+    // final update, including the position derivatives if the result is usable
+    ktraj_.evaluate(tpdata_.particleToca(),usable() ? TrajEvaluation::dXdPar : TrajEvaluation::basic,peval);
+    tpdata_.partCA_ = peval.pos_;
+    tpdata_.pdir_ = peval.direction();
     tpdata_.sdir_ = tpdata_.delta().Vect();
     // fill the rest of the state
     if(usable()){
@@ -116,9 +123,8 @@ namespace KinKal {
       VEC3 dvechat = dvec.Unit();
       // now variances due to the particle trajectory parameter covariance
       // for DOCA, project the spatial position derivative along the delta-CA direction
-      DVDP dxdp = ktraj_.dXdPar(particleToca());
       SVEC3 dv(dvechat.X(),dvechat.Y(),dvechat.Z());
-      dDdP_ = -dv*dxdp;
+      dDdP_ = -dv*peval.dXdP_;
       dTdP_[KTRAJ::t0Index()] = -1.0;  // TOCA is 100% anti-correlated with the (mandatory) t0 component.
       // project the parameter covariance onto DOCA and TOCA
       tpdata_.docavar_ = ROOT::Math::Similarity(dDdP(),ktraj_.params().covariance());